@@ -0,0 +1,128 @@
+@echo off
+echo ========================================
+echo WinPass-Native Benchmark Script
+echo ========================================
+echo.
+
+if not exist WinPass.exe (
+    echo [ERROR] WinPass.exe not found. Run build.bat first.
+    exit /b 1
+)
+
+rem Number of passwords per measurement; override with: bench.bat subprocess 5000
+set BENCH_N=1000
+if /I "%1"=="footprint" set BENCH_N=1000000
+if /I "%1"=="workers" set BENCH_N=10000000
+if /I "%1"=="seal" set BENCH_N=1000000
+if not "%2"=="" set BENCH_N=%2
+
+if /I "%1"=="subprocess" goto subprocess
+if /I "%1"=="footprint" goto footprint
+if /I "%1"=="serve" goto serve
+if /I "%1"=="fairness" goto fairness
+if /I "%1"=="workers" goto workers
+if /I "%1"=="seal" goto seal
+if "%1"=="" goto subprocess
+echo [ERROR] Unknown benchmark: %1
+echo Usage: bench.bat [subprocess^|footprint^|serve^|fairness^|workers^|seal] [count]
+exit /b 1
+
+:subprocess
+rem One process per password (what a provisioning script shelling out per account
+rem does) against one process writing all passwords with --count.
+echo [1/2] %BENCH_N% processes, one password each...
+powershell -NoProfile -Command "$t = Measure-Command { for ($i = 0; $i -lt %BENCH_N%; $i++) { & .\WinPass.exe --count=1 --output=bench_output.txt | Out-Null } }; '[BENCH] Subprocess per password: {0:N0} ms total, {1:N0} us per password' -f $t.TotalMilliseconds, ($t.TotalMilliseconds * 1000 / %BENCH_N%)"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [2/2] One process, --count=%BENCH_N%...
+powershell -NoProfile -Command "$t = Measure-Command { & .\WinPass.exe --count=%BENCH_N% --output=bench_output.txt | Out-Null }; '[BENCH] One process with --count: {0:N0} ms total, {1:N2} us per password' -f $t.TotalMilliseconds, ($t.TotalMilliseconds * 1000 / %BENCH_N%)"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+del bench_output.txt
+exit /b 0
+
+:footprint
+rem The default build against one with the small pool suggested for the
+rem freestanding core, for stream state size and stream speed.
+echo [1/3] Building WinPass_pool256.exe (STREAM_POOL_SIZE=256)...
+gcc src/*.c main.c -o WinPass_pool256.exe -Iinclude -O2 -DSTREAM_POOL_SIZE=256 -lAdvapi32 -lShell32 -lWs2_32
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [2/3] Default build (STREAM_POOL_SIZE=4096)...
+WinPass.exe --bench --count=%BENCH_N%
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [3/3] STREAM_POOL_SIZE=256...
+WinPass_pool256.exe --bench --count=%BENCH_N%
+if %ERRORLEVEL% NEQ 0 goto failed
+
+del WinPass_pool256.exe
+exit /b 0
+
+:serve
+rem %BENCH_N% requests written at once in a mix of four policies; the server
+rem prints req/s and p99 to stderr. Keep N at most 1024 (the read-ahead limit).
+powershell -NoProfile -Command "$p = @('--count=1', '-l=12 -n=4 -s=0', '--tenant=batch --count=5', '--tenant=helpdesk --count=1'); 1..%BENCH_N% | ForEach-Object { $p[$_ %% 4] } | Set-Content -Encoding ascii bench_requests.txt"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [1/2] Coalescing on...
+WinPass.exe --serve < bench_requests.txt > bench_output.txt
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [2/2] Coalescing off...
+WinPass.exe --serve --no-coalesce < bench_requests.txt > bench_output.txt
+if %ERRORLEVEL% NEQ 0 goto failed
+
+del bench_requests.txt bench_output.txt
+exit /b 0
+
+:fairness
+rem 1,000 requests at once: every 20th from the interactive helpdesk tenant, every
+rem 20th from a plain web tenant, the rest from a bulk tenant asking for 1,000
+rem passwords each. The server prints p99 per tenant to stderr.
+powershell -NoProfile -Command "1..1000 | ForEach-Object { if ($_ %% 20 -eq 0) { '--tenant=helpdesk --count=1' } elseif ($_ %% 20 -eq 10) { '--tenant=web --count=1' } else { '--tenant=bulk --count=1000' } } | Set-Content -Encoding ascii bench_requests.txt"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+WinPass.exe --serve < bench_requests.txt > bench_output.txt
+if %ERRORLEVEL% NEQ 0 goto failed
+
+del bench_requests.txt bench_output.txt
+exit /b 0
+
+:workers
+rem One --count run in a single process, then the same job spread over 1, 2, 4
+rem and 8 worker processes; each run prints its time and passwords/s.
+echo [1/2] One process...
+powershell -NoProfile -Command "$t = Measure-Command { & .\WinPass.exe --count=%BENCH_N% --output=bench_output.txt | Out-Null }; '[BENCH] One process: {0:N0} ms, {1:N0} passwords/s' -f $t.TotalMilliseconds, (%BENCH_N% * 1000 / $t.TotalMilliseconds)"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+for %%W in (1 2 4 8) do (
+    echo [2/2] --workers=%%W...
+    WinPass.exe --count=%BENCH_N% --output=bench_output.txt --workers=%%W
+    if errorlevel 1 goto failed
+)
+
+del bench_output.txt
+exit /b 0
+
+:seal
+rem %BENCH_N% random recipient keys (random 32-byte strings are valid X25519
+rem public keys), then one sealing run; it prints its time and seals/s.
+echo [1/2] Writing %BENCH_N% recipient keys...
+powershell -NoProfile -Command "$r = [Security.Cryptography.RandomNumberGenerator]::Create(); $b = New-Object byte[] 32; $w = [IO.StreamWriter]::new('bench_recipients.txt'); for ($i = 0; $i -lt %BENCH_N%; $i++) { $r.GetBytes($b); $w.WriteLine([BitConverter]::ToString($b).Replace('-', '')) }; $w.Close()"
+if %ERRORLEVEL% NEQ 0 goto failed
+
+echo [2/2] Sealing...
+WinPass.exe --seal=bench_recipients.txt --output=bench_output.txt
+if %ERRORLEVEL% NEQ 0 goto failed
+
+del bench_recipients.txt bench_output.txt
+exit /b 0
+
+:failed
+echo [ERROR] Benchmark failed!
+if exist bench_output.txt del bench_output.txt
+if exist WinPass_pool256.exe del WinPass_pool256.exe
+if exist bench_requests.txt del bench_requests.txt
+if exist bench_recipients.txt del bench_recipients.txt
+exit /b 1
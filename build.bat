@@ -4,15 +4,17 @@ echo WinPass-Native Build Script
 echo ========================================
 echo.
 
+if /I "%1"=="freestanding" goto freestanding
+
 echo [1/3] Compiling source files...
-gcc -c src/*.c -Iinclude
+gcc -c src/*.c -Iinclude -O2
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] Compilation failed!
     exit /b 1
 )
 
 echo [2/3] Linking executable...
-gcc *.o main.c -o WinPass.exe -Iinclude -lAdvapi32 -lShell32
+gcc *.o main.c -o WinPass.exe -Iinclude -lAdvapi32 -lShell32 -lWs2_32
 if %ERRORLEVEL% NEQ 0 (
     echo [ERROR] Linking failed!
     del *.o
@@ -27,3 +29,31 @@ echo ========================================
 echo Build completed successfully!
 echo Output: WinPass.exe
 echo ========================================
+exit /b 0
+
+:freestanding
+rem Heap-free generation core for embedding: no CryptoAPI, no Windows headers or imports.
+rem -Wstack-usage must match STREAM_FRAME_LIMIT in include/password_stream.h
+echo [1/3] Compiling generation core (freestanding)...
+gcc -c src/password_stream.c src/charset.c -Iinclude -O2 -DWINPASS_FREESTANDING -ffreestanding -Wstack-usage=192 -Werror
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERROR] Compilation failed or stack bound exceeded!
+    exit /b 1
+)
+
+echo [2/3] Archiving static library...
+ar rcs libwinpass_core.a password_stream.o charset.o
+if %ERRORLEVEL% NEQ 0 (
+    echo [ERROR] Archiving failed!
+    del *.o
+    exit /b 1
+)
+
+echo [3/3] Cleaning up object files...
+del *.o
+
+echo.
+echo ========================================
+echo Build completed successfully!
+echo Output: libwinpass_core.a
+echo ========================================
@@ -0,0 +1,86 @@
+/**
+ * @file batch_gen.h
+ * @brief Parallel bulk password generation into a contiguous record buffer
+ * @details Schedules a bulk job across worker threads, each with its own
+ *          PasswordStream, and writes the results as fixed-stride records so
+ *          the whole batch can be handed to a file or pipe in one write.
+ */
+
+#ifndef BATCH_GEN_H
+#define BATCH_GEN_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#define MAX_BATCH_THREADS     64   /**< Upper bound on worker threads (WaitForMultipleObjects limit) */
+#define BATCH_MIN_PER_THREAD  256  /**< Minimum passwords per worker before another thread is started */
+#define BATCH_MIN_CHUNK       64   /**< Smallest index range handed out to a worker */
+
+/**
+ * @brief Merged statistics of one GenerateBatch() call
+ */
+typedef struct {
+    int threads;         /**< Worker threads used */
+    int chunks;          /**< Index ranges handed out, including reassigned ones */
+    int minPerThread;    /**< Fewest passwords produced by one worker */
+    int maxPerThread;    /**< Most passwords produced by one worker */
+    int failedWorkers;   /**< Workers that stopped on a random or deny-list failure */
+    int reassigned;      /**< Passwords regenerated after a worker failure */
+    int maxDraws;        /**< Most random draws any single password needed */
+    int drawBound;       /**< Guaranteed draw limit per password, 0 if unbounded (rejection sampling) */
+    int denied;          /**< Passwords regenerated because the deny-list matched */
+    BOOL denyExhausted;  /**< A record hit DENY_MAX_RETRIES denied passwords in a row */
+} BatchStats;
+
+/**
+ * @brief Adds the statistics of one GenerateBatch() call to a running total
+ * @param total Statistics of the earlier calls, updated in place
+ * @param part Statistics of the next call
+ * @details Counters are summed; threads, the per-thread spread and the draw
+ *          maximum keep their extremes, so the spread is per call.
+ */
+void MergeBatchStats(BatchStats* total, const BatchStats* part);
+
+/**
+ * @brief Returns the record stride for a configuration
+ * @param config Password configuration
+ * @return Bytes per record: password length + CRLF
+ * @details Every password of a configuration has the same length, so record i
+ *          starts at buffer + i * stride.
+ */
+int BatchRecordStride(const PasswordConfig* config);
+
+/**
+ * @brief Generates count passwords into a contiguous buffer of fixed-stride records
+ * @param config Password configuration
+ * @param count Number of passwords to generate
+ * @param buffer Output buffer of at least count * BatchRecordStride(config) bytes
+ * @param stats Optional output for merged worker statistics (may be NULL)
+ * @return TRUE if every record was generated, FALSE on invalid configuration or CryptoAPI failure
+ * @details Uses one worker thread per processor (at most MAX_BATCH_THREADS).
+ *          Workers claim index ranges from a shared counter with guided
+ *          self-scheduling: each claim takes remaining / (2 * threads) records
+ *          (at least BATCH_MIN_CHUNK), so faster workers simply claim more ranges
+ *          and the ranges shrink as the job ends. When a worker fails, the
+ *          unfinished part of its range is taken over by another worker, or by the
+ *          calling thread after all workers exit; a record the deny-list rejected
+ *          DENY_MAX_RETRIES times stops the job instead, since no other worker
+ *          would do better. Each record is terminated by CRLF.
+ *          Passwords matching config->denyList are regenerated.
+ */
+BOOL GenerateBatch(const PasswordConfig* config, int count, char* buffer, BatchStats* stats);
+
+/**
+ * @brief Generates a batch like GenerateBatch() on at most maxThreads worker threads
+ * @param config Password configuration
+ * @param count Number of passwords to generate
+ * @param buffer Output buffer of at least count * BatchRecordStride(config) bytes
+ * @param maxThreads Thread limit, 0 for one per processor
+ * @param stats Optional output for merged worker statistics (may be NULL)
+ * @return TRUE if every record was generated, FALSE otherwise
+ * @details Worker processes started with --workers use one thread each, so the
+ *          process count alone sets the parallelism.
+ */
+BOOL GenerateBatchThreads(const PasswordConfig* config, int count, char* buffer, int maxThreads, BatchStats* stats);
+
+#endif
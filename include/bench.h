@@ -0,0 +1,52 @@
+/**
+ * @file bench.h
+ * @brief In-process benchmarks and the latency stress test of the generation paths
+ * @details Times the public generation interfaces against each other on this
+ *          machine, so their relative cost can be checked without external tools.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#define BENCH_DEFAULT_COUNT  1000000  /**< Passwords per measurement when --count is not given */
+#define BENCH_PROFILE_ROUNDS 100      /**< Lookups of every profile per profile measurement */
+#define STRESS_MAX_COUNT     1000000000000000ULL /**< Largest --stress count (10^15) */
+#define STRESS_SUB_BUCKETS   512      /**< Latency histogram buckets per power of two (under 0.2% error) */
+#define STRESS_BUCKETS       (STRESS_SUB_BUCKETS * 33) /**< Histogram size: latencies up to 2^41 ns (about 37 minutes) */
+
+/**
+ * @brief Runs all benchmarks for a configuration and prints the results
+ * @param config Password configuration; config->count overrides BENCH_DEFAULT_COUNT
+ * @return TRUE if every benchmark ran, FALSE on invalid configuration or failure
+ * @details Prints sizeof(PasswordStream) for the build's STREAM_POOL_SIZE.
+ *          Stream vs batch: generates the same number of fixed-stride records
+ *          once with a single PasswordStream (StreamNext() in a loop, one thread)
+ *          and once with GenerateBatch() (one worker per processor), and prints
+ *          the time per password of each. Profile lookup: finds every profile
+ *          once from WinPass.ini and once from the compiled profile cache
+ *          (opened anew per lookup, like at process start), and prints the time
+ *          per lookup of each. With --intersect, also prints the plan's compile
+ *          or cache load time.
+ */
+BOOL RunBenchmarks(const PasswordConfig* config);
+
+/**
+ * @brief Times every password of a long single-stream run and prints its latency distribution
+ * @param config Password configuration; config->stress is the number of passwords
+ * @return TRUE if every password was generated, FALSE on invalid configuration or failure
+ * @details Each StreamNext() call (plus the deny-list check and its retries,
+ *          with --deny) is timed on its own with the performance counter, so a
+ *          password that triggers a CryptGenRandom refill carries the refill's
+ *          cost. With --async-refill the refill runs on the stream's helper
+ *          thread, and a password only carries the buffer switch. Latencies go into a log-linear histogram, so memory stays fixed
+ *          for any count. Prints p50, p99, p99.99 and the maximum, the maximum
+ *          of the passwords that refilled the pool, the refill count, the
+ *          timer's own overhead (included in every figure) and the most random
+ *          draws one password needed.
+ */
+BOOL RunStressTest(const PasswordConfig* config);
+
+#endif
@@ -22,6 +22,31 @@ typedef struct {
     int letterLength;   /**< Number of letter characters to generate */
     int numberLength;   /**< Number of numeric characters to generate */
     int symbolLength;   /**< Number of symbol characters to generate */
+    int count;          /**< Number of passwords to generate (1 = single, with clipboard) */
+    const WCHAR* outputPath; /**< Bulk output file (points into argument array), NULL for console */
+    BOOL showCrackTime; /**< Print entropy and crack-time estimates instead of generating */
+    BOOL calibrate;     /**< Re-measure hash throughput before estimating */
+    int rigSize;        /**< Attacker rig size as a multiple of this machine */
+    BOOL serve;         /**< Run the long-lived request server on stdin/stdout */
+    BOOL coalesce;      /**< Serve mode: merge concurrent requests for the same policy */
+    int windowMs;       /**< Serve mode: coalescing window in milliseconds */
+    BOOL bounded;       /**< Use rejection-free sampling with a fixed number of random draws */
+    BOOL asyncRefill;   /**< Refill the random pool on a helper thread instead of inline */
+    char symbolSet[MAX_SYMBOL_SET]; /**< Allowed symbols, empty for all of CHARSET_SYMBOLS */
+    BOOL noLeadingDigit;  /**< First character must not be a digit */
+    BOOL noLeadingSymbol; /**< First character must not be a symbol */
+    const struct CompositionPlan* plan; /**< Per-password category counts from --intersect, NULL for fixed counts */
+    const WCHAR* compileInput; /**< Text list to compile into --output with --compile-denylist, NULL otherwise */
+    const struct DenyList* denyList; /**< Mapped deny-list from --deny, NULL for none */
+    const WCHAR* sealPath;   /**< Recipient key file for --seal, NULL for plaintext output */
+    const WCHAR* openPath;   /**< Sealed file to open with --open, NULL otherwise */
+    const WCHAR* keyPath;    /**< Secret key file for --open */
+    const WCHAR* keygenPath; /**< New secret key file for --keygen, NULL otherwise */
+    BOOL bench;              /**< Run the in-process benchmarks instead of generating */
+    ULONGLONG stress;        /**< Passwords for the --stress latency run, 0 otherwise */
+    BOOL selftest;           /**< Run the known-answer tests instead of generating */
+    int workers;             /**< Bulk output: worker processes for --workers, 0 to generate in-process */
+    int workerPort;          /**< Coordinator port for --worker (started by --workers), 0 otherwise */
 } PasswordConfig;
 
 /**
@@ -31,8 +56,17 @@ typedef struct {
  * @param config Output structure to populate with parsed configuration
  * @return TRUE if all arguments are valid, FALSE if an invalid flag was found
  * @details Recognizes flags: --no-letters, --no-numbers, --no-symbols,
- *          --letters=N, --numbers=N, --symbols=N (and short forms -l=, -n=, -s=).
- *          Applies default values before processing arguments.
+ *          --letters=N, --numbers=N, --symbols=N, --count=N, --output=FILE,
+ *          --profile=NAME, --crack-time, --calibrate, --rig=N, --serve, --no-coalesce, --window=MS,
+ *          --bounded, --async-refill, --intersect=A,B,..., --compile-denylist=FILE, --deny=FILE,
+ *          --seal=FILE, --open=FILE, --key=FILE, --keygen=FILE, --bench, --stress=N, --selftest,
+ *          --workers=N, --worker=PORT (and short forms -l=, -n=, -s=, -c=, -o=, -p=).
+ *          Applies default values before processing arguments. Arguments are
+ *          applied in order, so flags after --profile override the profile.
+ *          --intersect is compiled after all other arguments, so the length flags
+ *          only set the default length for policies without MaxLength.
+ *          --deny maps its table last; on success config->denyList must be
+ *          released with CloseDenyList().
  */
 BOOL ParseArguments(LPWSTR* args, int count, PasswordConfig* config);
 
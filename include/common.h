@@ -12,10 +12,45 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#ifdef WINPASS_FREESTANDING
+/* Freestanding core: the few Win32 types it uses, without any Windows header */
+#include <stddef.h>          /**< wchar_t and size_t (provided by freestanding compilers) */
+#include <stdint.h>          /**< Exact-width integers (also required of freestanding compilers) */
+
+/* Exact widths, not long: long is 64 bits on LP64 targets, where the core's
+   32-bit draws and the hashes would silently change */
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uint64_t ULONGLONG;
+typedef wchar_t WCHAR;
+typedef WCHAR* LPWSTR;
+
+#define TRUE     1
+#define FALSE    0
+#define MAXDWORD 0xFFFFFFFFU
+
+/**
+ * @brief Clears memory through a volatile pointer so the stores are kept
+ * @param ptr Memory to clear
+ * @param cnt Number of bytes
+ * @return ptr
+ */
+static __inline void* SecureZeroMemory(void* ptr, size_t cnt) {
+    volatile BYTE* p = (volatile BYTE*)ptr;
+    while (cnt--) *p++ = 0;
+    return ptr;
+}
+#else
 #define _WIN32_WINNT 0x0500  /**< Target Windows 2000+ for console API support */
 #include <windows.h>         /**< Core Win32 API */
 #include <wincrypt.h>        /**< Cryptographic API for secure random generation */
 #include <shellapi.h>        /**< Command line parsing and clipboard operations */
+#endif
+
+/** Fails to compile unless DWORD is exactly 32 bits, in either profile */
+typedef char DwordIs32Bits[sizeof(DWORD) == 4 ? 1 : -1];
 
 /* Password length constraints */
 #define MIN_PASSWORD_LENGTH  4      /**< Minimum total password length for security */
@@ -23,6 +58,8 @@
 #define MAX_CATEGORY_LENGTH  1024   /**< Maximum length per character category */
 #define DEFAULT_BATCH_LENGTH 16     /**< Default password length for batch mode */
 #define MAX_INT_PARSE_VALUE  100000 /**< Maximum value for integer parsing to prevent overflow */
+#define MAX_BULK_COUNT       2000000000 /**< Maximum --count; bulk output is generated in slabs, so memory use does not grow with it */
+#define MAX_SYMBOL_SET       32     /**< Buffer size for a restricted symbol set (CHARSET_SYMBOLS + null) */
 
 /**
  * @brief Full character set including letters, numbers, and symbols
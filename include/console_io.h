@@ -18,6 +18,14 @@
  */
 void ConsoleWrite(const char* str);
 
+/**
+ * @brief Writes a byte range to console output
+ * @param data Bytes to write (need not be null-terminated)
+ * @param length Number of bytes to write
+ * @details Used for bulk output where the length is already known
+ */
+void ConsoleWriteN(const char* data, int length);
+
 /**
  * @brief Reads user input from console
  * @param buffer Buffer to store input string
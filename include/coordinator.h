@@ -0,0 +1,89 @@
+/**
+ * @file coordinator.h
+ * @brief Bulk generation across worker processes coordinated over loopback TCP
+ * @details With --workers=N the process becomes a coordinator: it starts N
+ *          copies of its own executable with --worker=PORT, hands each one
+ *          index ranges of the bulk job over a loopback connection, and writes
+ *          the returned records at their fixed offsets in the output file.
+ *
+ *          Connection:  the coordinator listens on 127.0.0.1 and passes each
+ *                       worker a random token on its standard input; the
+ *                       worker connects and sends a CoordHello with that token
+ *                       and its record stride
+ *          Assignment:  the coordinator sends a range (first, count); count 0
+ *                       tells the worker to exit
+ *          Result:      the worker sends a CoordResult, followed by count
+ *                       records if the status is COORD_STATUS_OK
+ */
+
+#ifndef COORDINATOR_H
+#define COORDINATOR_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#define COORD_MAX_WORKERS        64         /**< Upper bound on --workers (WaitForMultipleObjects limit) */
+#define COORD_TOKEN_SIZE         16         /**< Random bytes a worker must present to connect */
+#define COORD_MIN_RANGE          256        /**< First range of a worker, and the smallest one handed out */
+#define COORD_RANGE_MS           100        /**< Target time of one range at the worker's measured rate */
+#define COORD_MAX_RANGE_BYTES    (4 << 20)  /**< Largest range payload, and the receive buffer per worker */
+#define COORD_CONNECT_TIMEOUT_MS 10000      /**< Time workers get to start and connect */
+#define COORD_RESULT_TIMEOUT_MS  10000      /**< Time a worker gets to return one range */
+
+/**
+ * @brief Merged statistics of one coordinated job
+ */
+typedef struct {
+    int started;         /**< Worker processes started */
+    int connected;       /**< Workers that connected with a valid token and stride */
+    int ranges;          /**< Ranges returned by workers */
+    int minPerWorker;    /**< Fewest passwords returned by one connected worker */
+    int maxPerWorker;    /**< Most passwords returned by one connected worker */
+    int failedWorkers;   /**< Workers lost mid-job: disconnected, timed out or failed to draw random data */
+    int reassigned;      /**< Passwords of lost ranges generated by another worker */
+    int local;           /**< Passwords the coordinator generated after losing every worker */
+    int maxDraws;        /**< Most random draws any single password needed */
+    int denied;          /**< Passwords regenerated because the deny-list matched */
+    BOOL denyExhausted;  /**< A worker hit DENY_MAX_RETRIES denied passwords in a row */
+    DWORD elapsedMs;     /**< Wall-clock time from the first worker start to the last write */
+} CoordinatorStats;
+
+/**
+ * @brief Generates config->count passwords into config->outputPath with worker processes
+ * @param config Password configuration; config->workers sets the process count
+ * @param args Argument array the configuration was parsed from (passed on to the workers)
+ * @param argCount Number of arguments
+ * @param failWorker Connected worker to terminate while it holds its second range
+ *        (fault injection for --selftest), -1 for none
+ * @param stats Output statistics
+ * @return TRUE if every record was written, FALSE otherwise (the output file is deleted)
+ * @details Ranges are sized from each worker's measured rate to take about
+ *          COORD_RANGE_MS, starting at COORD_MIN_RANGE and never more than half
+ *          of the remaining work per worker, so fast workers get larger ranges
+ *          and all of them finish together. A worker that disconnects, times
+ *          out or reports a random failure loses its range to the next worker
+ *          asking for work; if every worker is lost, the coordinator generates
+ *          the rest itself. A deny-list exhaustion is not reassigned: it ends
+ *          the job, since every worker applies the same policy.
+ */
+BOOL RunCoordinator(const PasswordConfig* config, LPWSTR* args, int argCount, int failWorker, CoordinatorStats* stats);
+
+/**
+ * @brief Runs --count bulk generation with --workers and prints the summary
+ * @param config Password configuration
+ * @param args Argument array the configuration was parsed from
+ * @param argCount Number of arguments
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GenerateDistributed(const PasswordConfig* config, LPWSTR* args, int argCount);
+
+/**
+ * @brief Serves ranges for a coordinator until told to stop
+ * @param config Password configuration, parsed from the coordinator's arguments
+ * @return 0 when the coordinator ended the job, 1 on failure
+ * @details Reads the token from standard input, connects to
+ *          127.0.0.1:config->workerPort and generates each range on one thread.
+ */
+int RunWorker(const PasswordConfig* config);
+
+#endif
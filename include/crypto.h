@@ -0,0 +1,105 @@
+/**
+ * @file crypto.h
+ * @brief Self-contained X25519 and ChaCha20-Poly1305 for sealed delivery
+ * @details Implements RFC 7748 (X25519) and RFC 8439 (ChaCha20-Poly1305 AEAD)
+ *          without CryptoAPI or the C runtime, so sealed records can be opened
+ *          on any platform with a standard implementation. Field arithmetic
+ *          uses ten signed 25.5-bit limbs and 64-bit products, which compiles to
+ *          plain integer code on both 32-bit and 64-bit targets.
+ */
+
+#ifndef CRYPTO_H
+#define CRYPTO_H
+
+#include "common.h"
+
+#define X25519_KEY_SIZE     32   /**< Scalar, point and shared secret size */
+#define X25519_MAX_BATCH    64   /**< Maximum jobs in one X25519Batch() call */
+#define AEAD_KEY_SIZE       32   /**< ChaCha20-Poly1305 key size */
+#define AEAD_NONCE_SIZE     12   /**< ChaCha20-Poly1305 nonce size */
+#define AEAD_TAG_SIZE       16   /**< Poly1305 tag size */
+
+/**
+ * @brief The X25519 base point (u = 9)
+ */
+extern const BYTE X25519_BASE_POINT[X25519_KEY_SIZE];
+
+/**
+ * @brief One scalar multiplication of a batch
+ */
+typedef struct {
+    const BYTE* scalar;   /**< 32-byte secret scalar (clamped internally) */
+    const BYTE* point;    /**< 32-byte u-coordinate, e.g. X25519_BASE_POINT */
+    BYTE* out;            /**< 32-byte result */
+} X25519Job;
+
+/**
+ * @brief Computes several X25519 functions with one field inversion
+ * @param jobs Jobs to run
+ * @param count Number of jobs; nothing is done for count <= 0
+ * @details Each Montgomery ladder ends in projective form (X : Z). The Z values
+ *          of up to X25519_MAX_BATCH jobs are inverted together with Montgomery's
+ *          trick (three multiplications per job plus a single inversion), instead
+ *          of one exponentiation per job. Larger batches are run in slices of
+ *          X25519_MAX_BATCH, one inversion each. The ladder is constant-time. A low-order
+ *          point yields an all-zero result, as RFC 7748 specifies.
+ */
+void X25519Batch(const X25519Job* jobs, int count);
+
+/**
+ * @brief Computes the X25519 function for one scalar and point
+ * @param out 32-byte result
+ * @param scalar 32-byte secret scalar
+ * @param point 32-byte u-coordinate
+ */
+void X25519(BYTE* out, const BYTE* scalar, const BYTE* point);
+
+/**
+ * @brief Derives a 32-byte key from a 32-byte secret with HChaCha20
+ * @param out 32-byte output key
+ * @param key 32-byte input secret
+ * @param input 16-byte domain input
+ */
+void HChaCha20(BYTE* out, const BYTE* key, const BYTE* input);
+
+/**
+ * @brief Computes a Poly1305 one-time authenticator (RFC 8439 section 2.5)
+ * @param tag 16-byte tag output
+ * @param message Message
+ * @param length Message length
+ * @param key 32-byte one-time key (r, then s)
+ * @details Exposed for the --selftest vector; sealing uses it only inside the AEAD.
+ */
+void Poly1305Mac(BYTE* tag, const BYTE* message, DWORD length, const BYTE* key);
+
+/**
+ * @brief Encrypts and authenticates with ChaCha20-Poly1305 (RFC 8439)
+ * @param out Ciphertext, length bytes (may equal in)
+ * @param tag 16-byte authentication tag output
+ * @param in Plaintext
+ * @param length Plaintext length
+ * @param aad Additional authenticated data
+ * @param aadLength Length of aad
+ * @param key 32-byte key
+ * @param nonce 12-byte nonce, never reused with the same key
+ */
+void AeadSeal(BYTE* out, BYTE* tag, const BYTE* in, DWORD length,
+              const BYTE* aad, DWORD aadLength, const BYTE* key, const BYTE* nonce);
+
+/**
+ * @brief Verifies and decrypts ChaCha20-Poly1305 (RFC 8439)
+ * @param out Plaintext, length bytes (may equal in)
+ * @param in Ciphertext
+ * @param length Ciphertext length
+ * @param tag 16-byte authentication tag
+ * @param aad Additional authenticated data
+ * @param aadLength Length of aad
+ * @param key 32-byte key
+ * @param nonce 12-byte nonce
+ * @return TRUE if the tag is valid; on FALSE nothing is written to out
+ * @details The tag is compared in constant time before any decryption.
+ */
+BOOL AeadOpen(BYTE* out, const BYTE* in, DWORD length, const BYTE* tag,
+              const BYTE* aad, DWORD aadLength, const BYTE* key, const BYTE* nonce);
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file denylist.h
+ * @brief Compiled deny-lists: offline build and memory-mapped lookup
+ * @details A text list (one entry per line) is normalized and sorted in
+ *          parallel into runs spilled to disk, merged and deduplicated into a
+ *          versioned binary table. The generator maps that table read-only and
+ *          rejects passwords that contain any entry, so the list never has to
+ *          be parsed again.
+ */
+
+#ifndef DENYLIST_H
+#define DENYLIST_H
+
+#include "common.h"
+
+#define DENYLIST_MAGIC       0x4C445057  /**< "WPDL" in file byte order */
+#define DENYLIST_VERSION     3           /**< Format version; other versions are rejected */
+#define DENYLIST_MIN_ENTRY   MIN_PASSWORD_LENGTH  /**< Shorter entries are dropped (they would deny almost everything) */
+#define DENYLIST_MAX_ENTRY   64          /**< Longer entries are cut to this length (fits the length byte, bounds lookups) */
+#define DENYLIST_BLOCK       32          /**< Entries per block; the index holds one offset per block */
+#define DENYLIST_RUN_BYTES   (16 << 20)  /**< Input bytes sorted in memory per run (a multiple of 64 KB) */
+#define DENYLIST_READ_SIZE   65536       /**< Read buffer per run while merging */
+#define DENYLIST_WRITE_SIZE  65536       /**< Output buffer for writing runs and the table */
+#define MAX_DENYLIST_THREADS 64          /**< Upper bound on compiler threads */
+#define DENY_MAX_RETRIES     64          /**< Denied passwords regenerated per record before giving up */
+
+/**
+ * @brief On-disk header of a compiled deny-list
+ * @details Followed by the blob: the normalized entries in byte order, each
+ *          stored as a length byte and its characters. After the blob, padded
+ *          to 8 bytes, comes the index: (blocks + 1) ULONGLONG offsets into the
+ *          blob, block b holding entries b * DENYLIST_BLOCK onwards. Then come
+ *          the block checksums: one DWORD FNV-1a 32 of each block's bytes. The
+ *          header checksum is FNV-1a 64 over the header fields before it and
+ *          the index, so opening a table reads the index but never the entries
+ *          or the block checksums; a block is checked when it is first read.
+ */
+typedef struct {
+    DWORD magic;          /**< DENYLIST_MAGIC */
+    DWORD version;        /**< DENYLIST_VERSION */
+    DWORD minLength;      /**< Shortest entry */
+    DWORD maxLength;      /**< Longest entry */
+    ULONGLONG count;      /**< Number of unique entries */
+    ULONGLONG blocks;     /**< Index blocks: count / DENYLIST_BLOCK, rounded up */
+    ULONGLONG blobSize;   /**< Bytes of entry data, length bytes included */
+    ULONGLONG checksum;   /**< FNV-1a 64 of the fields above and the index */
+} DenyListHeader;
+
+/**
+ * @brief An open, memory-mapped deny-list
+ */
+typedef struct DenyList {
+    HANDLE hFile;                  /**< Table file */
+    HANDLE hMapping;               /**< Read-only mapping of the file */
+    const BYTE* view;              /**< Mapped view */
+    const DenyListHeader* header;  /**< Header at the start of the view */
+    const BYTE* blob;              /**< Entry data: length byte, then the characters */
+    const ULONGLONG* index;        /**< Block b is blob[index[b], index[b + 1]) */
+    const DWORD* blockSums;        /**< FNV-1a 32 of each block */
+    volatile LONG* verified;       /**< One bit per block that has passed its checksum */
+    volatile LONG corrupt;         /**< Set once a block fails; every lookup then denies */
+} DenyList;
+
+/**
+ * @brief Normalizes text for deny-list matching
+ * @param text Text to normalize in place
+ * @param length Number of bytes
+ * @details Folds ASCII case and maps common leet substitutions to letters
+ *          (0->o, 1->i, 3->e, 4->a, 5->s, 7->t, 8->b, @->a, $->s, !->i), so
+ *          "P@ssw0rd" and "password" match the same entry.
+ */
+void NormalizeDenyText(char* text, int length);
+
+/**
+ * @brief Compiles a text list into a binary deny-list table
+ * @param inputPath Text file, one entry per line (LF or CRLF)
+ * @param outputPath Table file to create
+ * @return TRUE on success, FALSE on failure (error already printed)
+ * @details One thread per processor claims DENYLIST_RUN_BYTES slices of the
+ *          input, maps each one read-only, copies its entries normalized into a
+ *          run buffer, sorts and deduplicates the run, and appends it to a
+ *          spill file next to the output. Empty lines, entries shorter than
+ *          DENYLIST_MIN_ENTRY and entries with non-ASCII bytes are dropped;
+ *          generated passwords are ASCII, so such entries could never match.
+ *          Lines over 64 KB are dropped as noise. Entries longer than
+ *          DENYLIST_MAX_ENTRY are cut to it, which denies every password the
+ *          full entry would. One thread then merges all runs into the table,
+ *          removing duplicates across runs. Memory stays at the run buffers,
+ *          the merge buffers, the block index and the block checksums, whatever
+ *          the input size. Prints line and entry counts, the run count, build
+ *          time and peak buffer memory.
+ */
+BOOL CompileDenyList(const WCHAR* inputPath, const WCHAR* outputPath);
+
+/**
+ * @brief Maps a compiled deny-list for lookups
+ * @param path Table file
+ * @return Open list, or NULL if the file is missing, of another version, or corrupt
+ *         (error already printed)
+ * @details Checks the magic, version, lengths and file size, the checksum of
+ *          the header and index, and that the index starts at 0, strictly
+ *          increases and ends at the blob size. Entry data is not read here:
+ *          each block is checked against its checksum the first time a lookup
+ *          reads it, and every length byte is bounded by the end of its block,
+ *          so a damaged blob is reported and never read outside the mapping.
+ */
+DenyList* OpenDenyList(const WCHAR* path);
+
+/**
+ * @brief Unmaps a deny-list opened with OpenDenyList()
+ * @param list List to close (may be NULL)
+ */
+void CloseDenyList(const DenyList* list);
+
+/**
+ * @brief Checks whether a password contains a denied entry
+ * @param list Open deny-list
+ * @param password Password to check
+ * @param length Password length
+ * @return TRUE if any substring, after normalization, is in the list
+ * @details For each start position, one search finds the largest entry not
+ *          above the rest of the password. If it is not a prefix of it, only
+ *          entries no longer than their common prefix can be, so the search is
+ *          repeated on that shorter prefix. Each search is a binary search over
+ *          the block index plus a scan of one block. A block that fails its
+ *          checksum is reported once and marks the list corrupt; from then on
+ *          every password is denied, so generation stops instead of trusting
+ *          a damaged table. Safe to call from several threads at once.
+ */
+BOOL IsPasswordDenied(const DenyList* list, const char* password, int length);
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file hashes.h
+ * @brief In-memory password hash functions for crack-time calibration
+ * @details Self-contained MD5, SHA-1, SHA-256, bcrypt and Argon2id (with
+ *          BLAKE2b), so calibration times the hash itself in a tight loop
+ *          instead of CryptoAPI context and handle overhead. MD5, SHA-1 and
+ *          SHA-256 hash one short candidate in a single block, like a cracking
+ *          kernel does. None of these functions allocates memory.
+ */
+
+#ifndef HASHES_H
+#define HASHES_H
+
+#include "common.h"
+
+#define HASH_SHORT_MAX      55   /**< Longest input of the single-block hashes */
+#define MD5_DIGEST_SIZE     16   /**< MD5 digest size */
+#define SHA1_DIGEST_SIZE    20   /**< SHA-1 digest size */
+#define SHA256_DIGEST_SIZE  32   /**< SHA-256 digest size */
+#define BCRYPT_SALT_SIZE    16   /**< bcrypt salt size */
+#define BCRYPT_HASH_SIZE    23   /**< bcrypt output size (24 bytes truncated to 23, as in $2b$) */
+#define BCRYPT_MAX_KEY      72   /**< bcrypt uses at most this many key bytes */
+#define BLAKE2B_MAX_OUT     64   /**< Longest BLAKE2b digest */
+#define ARGON2_BLOCK_SIZE   1024 /**< Argon2 memory block size */
+
+/**
+ * @brief Computes MD5 of a short input
+ * @param data Input
+ * @param length Input length (0 to HASH_SHORT_MAX)
+ * @param digest Output, MD5_DIGEST_SIZE bytes
+ */
+void Md5Short(const BYTE* data, int length, BYTE* digest);
+
+/**
+ * @brief Computes SHA-1 of a short input
+ * @param data Input
+ * @param length Input length (0 to HASH_SHORT_MAX)
+ * @param digest Output, SHA1_DIGEST_SIZE bytes
+ */
+void Sha1Short(const BYTE* data, int length, BYTE* digest);
+
+/**
+ * @brief Computes SHA-256 of a short input
+ * @param data Input
+ * @param length Input length (0 to HASH_SHORT_MAX)
+ * @param digest Output, SHA256_DIGEST_SIZE bytes
+ */
+void Sha256Short(const BYTE* data, int length, BYTE* digest);
+
+/**
+ * @brief Computes the raw bcrypt hash ($2b$ semantics)
+ * @param key Password bytes including the terminating zero byte
+ * @param keyLength Key length (1 to BCRYPT_MAX_KEY)
+ * @param salt BCRYPT_SALT_SIZE bytes of salt
+ * @param cost log2 of the number of key expansion rounds (4 to 31)
+ * @param hash Output, BCRYPT_HASH_SIZE bytes
+ * @details EksBlowfishSetup followed by 64 encryptions of
+ *          "OrpheanBeholderScryDoubt". The result is the raw output, not the
+ *          base64 "$2b$..." string.
+ */
+void Bcrypt(const BYTE* key, int keyLength, const BYTE* salt, int cost, BYTE* hash);
+
+/**
+ * @brief Computes BLAKE2b of a message split in two parts
+ * @param out Output
+ * @param outLength Output length (1 to BLAKE2B_MAX_OUT)
+ * @param first First part of the message
+ * @param firstLength Length of the first part
+ * @param second Second part of the message (may be NULL if secondLength is 0)
+ * @param secondLength Length of the second part
+ */
+void Blake2b(BYTE* out, DWORD outLength, const BYTE* first, DWORD firstLength,
+             const BYTE* second, DWORD secondLength);
+
+/**
+ * @brief Argon2id inputs (RFC 9106)
+ */
+typedef struct {
+    const BYTE* password;  /**< Password P */
+    DWORD passwordLength;  /**< Length of P */
+    const BYTE* salt;      /**< Salt S (at least 8 bytes) */
+    DWORD saltLength;      /**< Length of S */
+    const BYTE* secret;    /**< Secret K, may be NULL */
+    DWORD secretLength;    /**< Length of K */
+    const BYTE* ad;        /**< Associated data X, may be NULL */
+    DWORD adLength;        /**< Length of X */
+    DWORD passes;          /**< Passes t (at least 1) */
+    DWORD memoryKiB;       /**< Memory m in KiB (at least 8 * lanes) */
+    DWORD lanes;           /**< Parallelism p (1 to 255) */
+} Argon2Params;
+
+/**
+ * @brief Bytes of working memory Argon2id() needs
+ * @param memoryKiB Memory parameter m
+ * @param lanes Parallelism p
+ * @return m rounded down to a multiple of 4 * p, in bytes
+ */
+SIZE_T Argon2MemorySize(DWORD memoryKiB, DWORD lanes);
+
+/**
+ * @brief Computes an Argon2id tag (version 0x13)
+ * @param params Inputs
+ * @param tag Output
+ * @param tagLength Tag length (at least 4)
+ * @param memory Working memory of Argon2MemorySize() bytes, 8-byte aligned
+ * @details The lanes of each segment are computed one after another on the
+ *          calling thread; the result is identical to a parallel computation.
+ */
+void Argon2id(const Argon2Params* params, BYTE* tag, DWORD tagLength, BYTE* memory);
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file intersect.h
+ * @brief One password accepted by several target-system policies at once
+ * @details Combines the rule keys of several named profiles (length window,
+ *          allowed symbols, category minimums, forbidden leading characters) into
+ *          a single CompositionPlan, so a shared account password can be generated
+ *          uniformly from the passwords every policy accepts.
+ */
+
+#ifndef INTERSECT_H
+#define INTERSECT_H
+
+#include "common.h"
+#include "cli_parser.h"
+#include "password_stream.h"
+#include "profile.h"
+
+#define MAX_INTERSECT_POLICIES  8    /**< Maximum profiles in one --intersect list */
+#define MAX_INTERSECT_NAMES     (MAX_INTERSECT_POLICIES * MAX_PROFILE_NAME)  /**< Buffer for the name list */
+#define PLAN_PRUNE_BITS         64   /**< Compositions this many bits below the most likely one are dropped */
+
+/**
+ * @brief Intersects named policies and compiles a CompositionPlan into the configuration
+ * @param names Comma-separated profile names, e.g. "AD-standard,SAP,Mainframe"
+ * @param config Configuration to update; its current total length is the default
+ *               length when no policy sets MaxLength
+ * @return TRUE on success, FALSE if a profile is missing or the policies conflict
+ *         (error naming the conflicting rules already printed)
+ * @details Per policy, Letters/Numbers/Symbols=0 forbid a category, AllowedSymbols
+ *          narrows the symbol set, and MinLength, MaxLength, Min<Category>,
+ *          NoLeadingDigit and NoLeadingSymbol add rules. The length is the largest
+ *          one every policy accepts. Each category composition is weighted by the
+ *          exact number of passwords it yields, computed in the log2 domain;
+ *          compositions below 2^-PLAN_PRUNE_BITS of the most likely one are dropped.
+ *          On success the configuration's counts hold the most likely composition
+ *          and config->plan must be released with FreeCompositionPlan().
+ */
+BOOL IntersectPolicies(const char* names, PasswordConfig* config);
+
+/**
+ * @brief Releases a plan created by IntersectPolicies()
+ * @param plan Plan to free (may be NULL)
+ */
+void FreeCompositionPlan(const CompositionPlan* plan);
+
+#endif
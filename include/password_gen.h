@@ -10,6 +10,10 @@
 #define PASSWORD_GEN_H
 
 #include "common.h"
+#include "cli_parser.h"
+
+#define OUTPUT_CHUNK_SIZE 65536  /**< Bytes buffered before each console write in bulk mode */
+#define BULK_SLAB_BYTES   (64 * 1024 * 1024)  /**< Record bytes generated and written per slab in bulk mode */
 
 /**
  * @brief Copies generated password to Windows clipboard
@@ -56,4 +60,28 @@ void GenerateCore(int length, BOOL useSymbols);
 void GenerateAdvanced(int letterCount, int numberCount, int symbolCount,
                       BOOL useLetters, BOOL useNumbers, BOOL useSymbols);
 
+/**
+ * @brief Checks that a configuration can produce bulk passwords
+ * @param config Password configuration
+ * @return TRUE if valid, FALSE after printing the reason
+ * @details Rejects configurations without an enabled category, with a total
+ *          length outside MIN_PASSWORD_LENGTH..MAX_PASSWORD_LENGTH, or whose
+ *          leading-character rules exclude every category.
+ */
+BOOL ValidateBulkConfig(const PasswordConfig* config);
+
+/**
+ * @brief Generates config->count passwords, one per line, to console or file
+ * @param config Password configuration (category toggles, lengths, count, output path)
+ * @return TRUE on success, FALSE on invalid configuration, CryptoAPI or I/O failure
+ * @details Generates the passwords in parallel into contiguous buffers of
+ *          fixed-stride records (see GenerateBatch()), one slab of at most
+ *          BULK_SLAB_BYTES at a time, and writes each slab to config->outputPath
+ *          or to console output. An output file is deleted again if generation
+ *          fails. Nothing is copied to the clipboard and no prompt is shown. With
+ *          config->sealPath, one password is generated per recipient and only the
+ *          sealed records are output.
+ */
+BOOL GenerateMany(const PasswordConfig* config);
+
 #endif
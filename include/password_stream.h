@@ -0,0 +1,176 @@
+/**
+ * @file password_stream.h
+ * @brief Streaming password generation over a batched random pool
+ * @details Provides an iterator-style interface for generating many passwords with
+ *          the same configuration. Random bytes are fetched from CryptoAPI in large
+ *          batches and each password is produced into an internal buffer, so the
+ *          steady state performs no allocation and no per-password CryptoAPI call.
+ */
+
+#ifndef PASSWORD_STREAM_H
+#define PASSWORD_STREAM_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#ifndef STREAM_POOL_SIZE
+#define STREAM_POOL_SIZE 4096  /**< Random bytes fetched per refill (may be overridden at build time) */
+#endif
+
+/**
+ * @brief Worst-case stack usage of the stream functions, in bytes
+ * @details The freestanding build profile (build.bat freestanding) compiles the
+ *          core with -Wstack-usage=STREAM_FRAME_LIMIT -Werror, so every function
+ *          frame is checked at build time. The deepest chain is StreamNext ->
+ *          StreamAppendFrom -> StreamRandomBelow -> StreamBoundedBelow ->
+ *          StreamRefill -> RandomFillProc. The bound counts the fill function as
+ *          one more frame, so it holds for a fill that stays within
+ *          STREAM_FRAME_LIMIT and calls nothing; a deeper fill adds its own
+ *          usage. --selftest measures the actual usage by painting the stack.
+ */
+#define STREAM_FRAME_LIMIT  192
+#define STREAM_CALL_DEPTH   5   /**< Stream functions on the deepest chain */
+#define STREAM_STACK_BOUND  ((STREAM_CALL_DEPTH + 1) * STREAM_FRAME_LIMIT)
+
+/**
+ * @brief Random draws per password in bounded mode
+ * @param length Password length
+ * @param planned Nonzero if the category counts are drawn from a CompositionPlan
+ * @details One draw per character plus one per Fisher-Yates step (the leading
+ *          character pick replaces one step), and one for the composition.
+ *          Rejection sampling needs about as many draws on average but has no
+ *          upper bound; with PasswordConfig.bounded this is the exact count.
+ */
+#define STREAM_BOUNDED_DRAWS(length, planned)  (2 * (length) - 1 + ((planned) ? 1 : 0))
+
+#define PLAN_THRESHOLD_BITS 62  /**< Resolution of CompositionEntry thresholds */
+
+/**
+ * @brief One category composition of a CompositionPlan
+ */
+typedef struct {
+    ULONGLONG threshold;  /**< Cumulative probability up to this entry, scaled to 2^PLAN_THRESHOLD_BITS */
+    WORD letters;         /**< Letters in this composition */
+    WORD numbers;         /**< Digits in this composition */
+    WORD symbols;         /**< Symbols in this composition */
+} CompositionEntry;
+
+/**
+ * @brief Distribution of category counts for a fixed password length
+ * @details Each composition is weighted by the number of passwords it yields,
+ *          so drawing a composition and then a uniform password of that
+ *          composition is uniform over every password the policy allows.
+ *          Built by IntersectPolicies(); the stream only reads it.
+ */
+typedef struct CompositionPlan {
+    int count;                   /**< Number of entries */
+    int length;                  /**< Password length of every entry */
+    int policies;                /**< Policies intersected */
+    double bits;                 /**< log2 of the number of allowed passwords */
+    DWORD compileMicros;         /**< Time taken to build the plan, or to load it if cached */
+    BOOL cached;                 /**< Loaded from the profile cache instead of compiled */
+    CompositionEntry entries[1]; /**< Entries in order of increasing threshold (allocated with count) */
+} CompositionPlan;
+
+/**
+ * @brief Source of random bytes for a stream
+ * @param context Caller-defined context passed to StreamOpenWithSource()
+ * @param buffer Buffer to fill
+ * @param length Number of bytes to fill
+ * @return TRUE on success, FALSE if no randomness is available
+ */
+typedef BOOL (*RandomFillProc)(void* context, BYTE* buffer, DWORD length);
+
+/**
+ * @brief State of a password stream
+ * @details Holds the random source, the batched random pool and the buffer the
+ *          current password is written to. Caller-allocated (stack or static);
+ *          apart from the draw and refill counters, no member needs to be
+ *          accessed directly. The stream allocates nothing, except the second
+ *          pool of PasswordConfig.asyncRefill: a helper thread then fills one
+ *          pool while the other is consumed, so the stream must stay at the
+ *          same address until StreamClose().
+ */
+typedef struct {
+    RandomFillProc randomFill;               /**< Random source used for refills */
+    void* randomContext;                     /**< Context passed to randomFill */
+#ifndef WINPASS_FREESTANDING
+    HCRYPTPROV hCryptProv;                   /**< CryptoAPI context owned by the stream (StreamOpen only) */
+    HANDLE hRefillThread;                    /**< Helper thread filling the spare buffer, NULL unless asyncRefill */
+    HANDLE hRefillWanted;                    /**< Signalled when the helper may fill the spare buffer */
+    HANDLE hRefillDone;                      /**< Signalled by the helper when the spare buffer is full */
+    volatile LONG refillStop;                /**< Set by StreamClose() to end the helper */
+    BOOL refillFailed;                       /**< The helper's last fill failed */
+    BYTE* spareBuffer;                       /**< Second pool of the double buffer (heap), NULL unless asyncRefill */
+    BYTE* spare;                             /**< Buffer the helper fills: pool or spareBuffer */
+#endif
+    PasswordConfig config;                   /**< Copy of the configuration being generated */
+    int length;                              /**< Total password length from enabled categories */
+    const char* symbols;                     /**< Symbol charset: config.symbolSet or CHARSET_SYMBOLS */
+    BYTE* active;                            /**< Buffer being consumed: pool, or spareBuffer in async mode */
+    int poolPos;                             /**< Next unread byte in active */
+    int draws;                               /**< Random values drawn for the current password */
+    int maxDraws;                            /**< Most draws any password of this stream needed */
+    ULONGLONG refills;                       /**< Pool refills so far (buffer switches in async mode) */
+    BYTE pool[STREAM_POOL_SIZE];             /**< Batched random bytes */
+    char password[MAX_PASSWORD_LENGTH + 1];  /**< Current password (null-terminated) */
+} PasswordStream;
+
+#ifndef WINPASS_FREESTANDING
+/**
+ * @brief Opens a stream for the given configuration using CryptoAPI
+ * @param stream Stream state to initialize
+ * @param config Password configuration (copied into the stream)
+ * @return TRUE on success, FALSE if the configuration is invalid or CryptoAPI failed
+ * @details Validates that at least one category is enabled, that the total length
+ *          lies within [MIN_PASSWORD_LENGTH, MAX_PASSWORD_LENGTH] and that a
+ *          leading-character rule leaves a character to start with. With
+ *          PasswordConfig.asyncRefill, also starts the refill helper thread.
+ */
+BOOL StreamOpen(PasswordStream* stream, const PasswordConfig* config);
+#endif
+
+/**
+ * @brief Opens a stream that draws randomness from a caller-provided source
+ * @param stream Stream state to initialize (typically a static object)
+ * @param config Password configuration (copied into the stream)
+ * @param randomFill Function that fills buffers with cryptographically secure bytes
+ * @param context Passed unchanged to randomFill
+ * @return TRUE on success, FALSE if the configuration is invalid or randomFill failed
+ * @details The only way to open a stream in the freestanding build profile, where
+ *          neither CryptoAPI nor a heap is available. That profile has no
+ *          threads, so it rejects PasswordConfig.asyncRefill. Elsewhere the
+ *          helper thread is then the only caller of randomFill after the first
+ *          refill, so randomFill need not be thread-safe.
+ */
+BOOL StreamOpenWithSource(PasswordStream* stream, const PasswordConfig* config,
+                          RandomFillProc randomFill, void* context);
+
+/**
+ * @brief Generates the next password of the stream
+ * @param stream Open stream
+ * @param length Optional output for the password length (may be NULL)
+ * @return Pointer to the null-terminated password inside the stream, NULL on failure
+ * @details The returned pointer stays valid until the next StreamNext() or
+ *          StreamClose() call. Characters are mapped with Rejection Sampling and
+ *          the categories are mixed with a Fisher-Yates shuffle. With
+ *          PasswordConfig.bounded, each value is instead taken from a 64-bit draw
+ *          by wide-multiply reduction, so every password uses exactly
+ *          STREAM_BOUNDED_DRAWS(length, planned) draws. A leading-character rule
+ *          picks the first character uniformly among the allowed ones and then
+ *          shuffles the rest; with a plan, the category counts are drawn first.
+ *          When the pool runs out, an async stream switches to the spare buffer
+ *          and only waits if the helper has not finished filling it.
+ */
+const char* StreamNext(PasswordStream* stream, int* length);
+
+/**
+ * @brief Closes the stream and wipes its buffers
+ * @param stream Stream to close
+ * @details Stops the refill helper thread (if any), releases the CryptoAPI
+ *          context (if any) and clears both pools and the password buffer so no
+ *          secret material stays in memory.
+ */
+void StreamClose(PasswordStream* stream);
+
+#endif
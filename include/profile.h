@@ -0,0 +1,137 @@
+/**
+ * @file profile.h
+ * @brief Named password profiles loaded from an INI file
+ * @details Profiles let frequently used policies (e.g. "AD-standard", "PIN6") be
+ *          selected with --profile=NAME instead of spelling out every flag. They are
+ *          read with the Win32 private profile API from PROFILE_FILE_NAME located
+ *          next to the executable.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#define PROFILE_FILE_NAME  "WinPass.ini"  /**< Profile file, looked up in the executable's directory */
+#define USER_DATA_DIR_NAME "WinPass"      /**< Per-user data directory under %LOCALAPPDATA% */
+#define MAX_PROFILE_NAME   64             /**< Maximum profile (INI section) name length */
+#define PROFILE_SECTIONS_SIZE 8192        /**< Initial buffer for the list of section names (grows as needed) */
+
+/**
+ * @brief Values of one profile; -1 marks a key that is not set
+ */
+typedef struct {
+    char name[MAX_PROFILE_NAME];  /**< Section name */
+    int letters;                  /**< Letters key (0 disables letters) */
+    int numbers;                  /**< Numbers key (0 disables numbers) */
+    int symbols;                  /**< Symbols key (0 disables symbols) */
+    int count;                    /**< Count key */
+    int minLength;                /**< MinLength rule (compiled into a plan) */
+    int maxLength;                /**< MaxLength rule (compiled into a plan) */
+    int minLetters;               /**< MinLetters rule (compiled into a plan) */
+    int minNumbers;               /**< MinNumbers rule (compiled into a plan) */
+    int minSymbols;               /**< MinSymbols rule (compiled into a plan) */
+    int noLeadingDigit;           /**< NoLeadingDigit key (0 or 1) */
+    int noLeadingSymbol;          /**< NoLeadingSymbol key (0 or 1) */
+    char allowedSymbols[MAX_SYMBOL_SET]; /**< AllowedSymbols key, empty if not set */
+} ProfileEntry;
+
+/**
+ * @brief Immutable set of all profiles published by ProfileRegistryLoad()
+ */
+typedef struct ProfileSnapshot ProfileSnapshot;
+
+/**
+ * @brief Builds the full path of the profile file
+ * @param path Output buffer for the path
+ * @param maxLen Size of the output buffer (MAX_PATH recommended)
+ * @return TRUE on success, FALSE if the executable path could not be determined
+ * @details The private profile API searches the Windows directory for bare file
+ *          names, so an absolute path next to the executable is always used.
+ */
+BOOL GetProfilePath(char* path, int maxLen);
+
+/**
+ * @brief Builds the path of a file in the per-user data directory
+ * @param fileName File name, e.g. PROFILE_CACHE_FILE_NAME
+ * @param path Output buffer for the path
+ * @param maxLen Size of the output buffer (MAX_PATH recommended)
+ * @return TRUE on success, FALSE if %LOCALAPPDATA% is not set or the directory
+ *         cannot be created
+ * @details The executable's directory is often read-only (e.g. under Program
+ *          Files), so generated data goes to %LOCALAPPDATA%\WinPass, which is
+ *          created on first use.
+ */
+BOOL GetUserDataPath(const char* fileName, char* path, int maxLen);
+
+/**
+ * @brief Reads every valid profile from the profile file
+ * @param path Profile file path
+ * @param count Output: number of entries
+ * @return Entries to release with HeapFree(), NULL on failure
+ * @details Skips [Calibration] and [Tenant.*] sections and, without reporting
+ *          them, sections that are invalid or whose name is too long.
+ */
+ProfileEntry* ReadAllProfiles(const char* path, int* count);
+
+/**
+ * @brief Looks up a profile by name
+ * @param name Profile name (INI section)
+ * @param entry Output: the profile's values
+ * @return TRUE if the profile exists and is valid, FALSE otherwise (error already printed)
+ * @details Uses the published snapshot if there is one, then the compiled
+ *          profile cache (see profile_cache.h), and reads the file otherwise.
+ */
+BOOL FindProfile(const char* name, ProfileEntry* entry);
+
+/**
+ * @brief Applies a named profile on top of an existing configuration
+ * @param name Profile name (INI section)
+ * @param config Configuration to update; keys missing from the profile are left unchanged
+ * @param hasRules Output: TRUE if the profile sets MinLength, MaxLength or a
+ *                 Min<Category> key
+ * @return TRUE if the profile exists and is valid, FALSE otherwise (error already printed)
+ * @details Applies Letters, Numbers, Symbols (0 disables the category), Count,
+ *          AllowedSymbols, NoLeadingDigit and NoLeadingSymbol. The rule keys
+ *          cannot be expressed as fixed counts; when hasRules is set, the caller
+ *          compiles the profile with IntersectPolicies() as a one-policy list.
+ *          When a registry has been published with ProfileRegistryLoad(),
+ *          the name is looked up in the current snapshot without locking or file
+ *          access; otherwise it comes from the profile cache or the file.
+ */
+BOOL LoadProfile(const char* name, PasswordConfig* config, BOOL* hasRules);
+
+/**
+ * @brief Checks whether a profile sets a rule key
+ * @param entry Profile values from FindProfile()
+ * @return TRUE if MinLength, MaxLength or a Min<Category> key is set, so the
+ *         profile needs a composition plan
+ */
+BOOL ProfileHasRules(const ProfileEntry* entry);
+
+/**
+ * @brief Reads all profiles and atomically publishes them as the current snapshot
+ * @return TRUE if published, FALSE if the file is invalid (the previous snapshot stays)
+ * @details Safe to call from any thread, e.g. a console control handler, while
+ *          another thread calls LoadProfile(). The replaced snapshot is retired,
+ *          not freed, because a reader may still be using it. Reports the number
+ *          of profiles and the reload time.
+ */
+BOOL ProfileRegistryLoad(void);
+
+/**
+ * @brief Frees retired snapshots
+ * @details Must be called only from the thread that calls LoadProfile(), at a
+ *          point where it holds no profile entry (between requests). Every
+ *          snapshot retired before this call is then unreachable.
+ */
+void ProfileRegistryQuiesce(void);
+
+/**
+ * @brief Unpublishes the registry and frees all snapshots
+ * @details Later LoadProfile() calls read the file again.
+ */
+void ProfileRegistryShutdown(void);
+
+#endif
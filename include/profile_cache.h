@@ -0,0 +1,121 @@
+/**
+ * @file profile_cache.h
+ * @brief Precompiled, memory-mapped cache of profiles and intersection plans
+ * @details The first run after WinPass.ini changes validates every profile and
+ *          writes the results to a versioned binary cache in the per-user data
+ *          directory. Later runs map that file read-only and copy the entry they
+ *          need, so a --profile lookup reads no INI keys and an --intersect run
+ *          with the same inputs reuses its CompositionPlan instead of rebuilding
+ *          the tables. The cache is keyed by the profile file's path, size and
+ *          last write time; any change rebuilds it.
+ */
+
+#ifndef PROFILE_CACHE_H
+#define PROFILE_CACHE_H
+
+#include "common.h"
+#include "profile.h"
+#include "intersect.h"
+
+#define PROFILE_CACHE_FILE_NAME "WinPass.pcache"  /**< Cache file in the per-user data directory */
+#define PROFILE_CACHE_MAGIC     0x43505057        /**< "WPPC" in file byte order */
+#define PROFILE_CACHE_VERSION   2                 /**< Format version; other versions are rebuilt */
+#define MAX_CACHED_PLANS        16                /**< Plans kept; the oldest is dropped beyond this */
+
+/* Command-line inputs of an --intersect run (PlanCacheKey.flags, PlanCacheResult.flags) */
+#define PLAN_KEY_LETTERS           0x01  /**< Letters enabled */
+#define PLAN_KEY_NUMBERS           0x02  /**< Numbers enabled */
+#define PLAN_KEY_SYMBOLS           0x04  /**< Symbols enabled */
+#define PLAN_KEY_NO_LEADING_DIGIT  0x08  /**< No leading digit */
+#define PLAN_KEY_NO_LEADING_SYMBOL 0x10  /**< No leading symbol */
+
+/**
+ * @brief On-disk header of the profile cache
+ * @details Followed by entryCount ProfileEntry records, then planCount plan
+ *          records, each starting on an 8-byte boundary.
+ */
+typedef struct {
+    DWORD magic;              /**< PROFILE_CACHE_MAGIC */
+    DWORD version;            /**< PROFILE_CACHE_VERSION */
+    DWORD entrySize;          /**< sizeof(ProfileEntry) of the writer */
+    DWORD entryCount;         /**< Valid profiles in the source file */
+    DWORD planCount;          /**< Cached intersection plans */
+    DWORD fileSize;           /**< Total bytes, including the header */
+    ULONGLONG sourceSize;     /**< Size of the profile file the cache was built from */
+    ULONGLONG sourceTime;     /**< Last write time (FILETIME) of that file */
+    char sourcePath[MAX_PATH];/**< Full path of that file */
+} ProfileCacheHeader;
+
+/**
+ * @brief Everything an --intersect result depends on besides the profiles
+ */
+typedef struct {
+    char names[MAX_INTERSECT_NAMES]; /**< Profile list as given (compared case-insensitively) */
+    int defaultLength;               /**< Length used when no policy sets MaxLength */
+    DWORD flags;                     /**< PLAN_KEY_* bits from the command line */
+    char symbolSet[MAX_SYMBOL_SET];  /**< Symbol set from the command line, empty for all */
+} PlanCacheKey;
+
+/**
+ * @brief Configuration values an --intersect run writes besides the plan
+ */
+typedef struct {
+    int letters;                     /**< Letters of the most likely composition */
+    int numbers;                     /**< Digits of the most likely composition */
+    int symbols;                     /**< Symbols of the most likely composition */
+    DWORD flags;                     /**< PLAN_KEY_NO_LEADING_* of the merged rules */
+    char symbolSet[MAX_SYMBOL_SET];  /**< Symbols every policy allows */
+} PlanCacheResult;
+
+/**
+ * @brief Looks up a valid profile in the cache
+ * @param name Profile name (case-insensitive)
+ * @param entry Output: the profile's values
+ * @return TRUE on a hit; FALSE if the cache is unavailable or has no valid
+ *         profile of that name (the caller reads the file and reports the error)
+ * @details Opens the cache on first use, rebuilding it if the profile file
+ *          changed. Failing to write the cache is not an error; the profiles
+ *          are then served from the freshly built copy in memory.
+ */
+BOOL ProfileCacheFind(const char* name, ProfileEntry* entry);
+
+/**
+ * @brief Returns every cached profile
+ * @param count Output: number of entries
+ * @return Entries, valid until the next ProfileCacheStorePlan() or
+ *         ProfileCacheClose(); NULL if the cache is unavailable
+ */
+const ProfileEntry* ProfileCacheEntries(int* count);
+
+/**
+ * @brief Looks up a compiled intersection plan
+ * @param key Inputs of the --intersect run
+ * @param result Output: configuration values of the cached run
+ * @return Copy of the plan to release with FreeCompositionPlan(), NULL on a miss
+ */
+CompositionPlan* ProfileCacheFindPlan(const PlanCacheKey* key, PlanCacheResult* result);
+
+/**
+ * @brief Adds a compiled intersection plan to the cache file
+ * @param key Inputs of the --intersect run
+ * @param result Configuration values it produced
+ * @param plan Compiled plan
+ * @details The file is rewritten to a temporary name and renamed over the old
+ *          one, so concurrent runs see either version in full. If another
+ *          process holds the file open, the plan is simply not cached.
+ */
+void ProfileCacheStorePlan(const PlanCacheKey* key, const PlanCacheResult* result, const CompositionPlan* plan);
+
+/**
+ * @brief Enables or disables the cache for this process
+ * @param enable FALSE makes every lookup miss, e.g. in serve mode, which keeps
+ *               its own reloadable registry
+ */
+void ProfileCacheEnable(BOOL enable);
+
+/**
+ * @brief Unmaps the cache; the next lookup opens and validates it again
+ */
+void ProfileCacheClose(void);
+
+#endif
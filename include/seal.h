@@ -0,0 +1,119 @@
+/**
+ * @file seal.h
+ * @brief Per-recipient sealed delivery of bulk passwords
+ * @details Each generated password is sealed to one recipient's X25519 public
+ *          key with a fresh ephemeral key and ChaCha20-Poly1305, so every line of
+ *          the output can be opened on its own, and only by its recipient.
+ *
+ *          Record (hex-encoded, one per line):
+ *            key ID (4) | ephemeral public key (32) | ciphertext (length) | tag (16)
+ *          The key ID is BLAKE2b-32 of the recipient's public key, so a
+ *          recipient skips other records without a key agreement. The AEAD key
+ *          is HChaCha20(X25519(ephemeral, recipient), SEAL_KDF_INPUT) with an
+ *          all-zero nonce (each key seals exactly one record), and the
+ *          associated data is the ephemeral key followed by the recipient key.
+ */
+
+#ifndef SEAL_H
+#define SEAL_H
+
+#include "common.h"
+#include "crypto.h"
+
+#define SEAL_KEY_ID_SIZE       4    /**< Bytes of the recipient key ID */
+#define SEAL_OVERHEAD          (SEAL_KEY_ID_SIZE + X25519_KEY_SIZE + AEAD_TAG_SIZE)  /**< Bytes added to each password */
+#define SEAL_RECORD_STRIDE(length) (2 * ((length) + SEAL_OVERHEAD) + 2)  /**< Hex record plus CRLF */
+#define SEAL_BATCH             32   /**< Records per batch; their 2 * SEAL_BATCH key agreements share one inversion */
+#define MAX_SEAL_THREADS       64   /**< Upper bound on sealing threads */
+#define SEAL_KDF_INPUT         "WinPass-seal-v2"  /**< 16-byte HChaCha20 input (with the terminator); v2 added the key ID */
+
+/**
+ * @brief Recipient public keys, in the order of the recipient file
+ */
+typedef struct {
+    int count;     /**< Number of recipients */
+    BYTE* keys;    /**< count * X25519_KEY_SIZE bytes */
+} RecipientList;
+
+/**
+ * @brief Statistics of one SealRecords() call
+ */
+typedef struct {
+    int threads;   /**< Sealing threads used */
+    int batches;   /**< Batches sealed */
+} SealStats;
+
+/**
+ * @brief Loads a recipient file
+ * @param path Text file with one 64-digit hex X25519 public key per line
+ *             (blank lines are skipped)
+ * @return Recipient list, or NULL on error (message already printed)
+ */
+RecipientList* LoadRecipients(const WCHAR* path);
+
+/**
+ * @brief Releases a list from LoadRecipients()
+ * @param list List to free (may be NULL)
+ */
+void FreeRecipients(const RecipientList* list);
+
+/**
+ * @brief Seals record i of a password buffer to recipient i
+ * @param records Password records (recipients->count records of stride bytes, CRLF-terminated)
+ * @param stride Bytes per password record
+ * @param recipients Recipients, one per record
+ * @param sealed Output of recipients->count records of SEAL_RECORD_STRIDE(stride - 2) bytes
+ * @param stats Optional statistics output (may be NULL)
+ * @return TRUE on success, FALSE on CryptoAPI failure or a low-order recipient key
+ *         (message already printed)
+ * @details Worker threads (one per processor) claim SEAL_BATCH records at a time.
+ *          A batch draws all its ephemeral scalars with one CryptGenRandom call
+ *          and runs its ephemeral-key and shared-secret computations as one
+ *          X25519Batch(), so the whole batch needs a single field inversion.
+ */
+BOOL SealRecords(const char* records, int stride, const RecipientList* recipients, char* sealed, SealStats* stats);
+
+/**
+ * @brief Receives one opened password
+ * @param context Caller context
+ * @param password Password characters (wiped after the call)
+ * @param length Password length
+ */
+typedef void (*SealedPasswordProc)(void* context, const char* password, int length);
+
+/**
+ * @brief Opens the records of sealed text that belong to a secret key
+ * @param data Sealed records, one hex record per line
+ * @param size Bytes of data
+ * @param secret 32-byte secret key
+ * @param proc Called with each opened password, in record order
+ * @param context Passed to proc
+ * @param malformed Output: TRUE if a line was not a well-formed record
+ * @return Number of records opened
+ * @details Records whose key ID differs from the key's are skipped without a
+ *          key agreement; the rest are opened in SEAL_BATCH groups whose key
+ *          agreements share one inversion. A matching key ID is only a hint:
+ *          records of a colliding key fail authentication and are skipped.
+ */
+int OpenSealedRecords(const char* data, DWORD size, const BYTE* secret, SealedPasswordProc proc, void* context,
+                      BOOL* malformed);
+
+/**
+ * @brief Opens the records of a sealed file that belong to a secret key
+ * @param sealedPath File written with --seal
+ * @param keyPath File holding the 64-digit hex secret key (from --keygen)
+ * @return TRUE if at least one record opened, FALSE otherwise (message already printed)
+ * @details Writes each opened password to the console, one per line, using
+ *          OpenSealedRecords().
+ */
+BOOL OpenSealedFile(const WCHAR* sealedPath, const WCHAR* keyPath);
+
+/**
+ * @brief Creates a recipient key pair
+ * @param path New file for the hex secret key (an existing file is not overwritten)
+ * @return TRUE on success, FALSE on failure (message already printed)
+ * @details Prints the hex public key, ready to be appended to a recipient file.
+ */
+BOOL GenerateKeyFile(const WCHAR* path);
+
+#endif
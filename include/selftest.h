@@ -0,0 +1,26 @@
+/**
+ * @file selftest.h
+ * @brief Known-answer tests of the built-in primitives, a seal round trip, a stream stack check and a coordinator test
+ * @details Checks the self-contained implementations against published test
+ *          vectors, so a build can be verified on the target machine with
+ *          --selftest before its output is trusted.
+ */
+
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include "common.h"
+
+/**
+ * @brief Runs every known-answer test and prints one line per test
+ * @return TRUE if all tests passed, FALSE otherwise
+ * @details Prints "[TEST] <name>: OK" or "[TEST] <name>: FAILED" for each
+ *          vector (hashes, X25519, Poly1305, ChaCha20-Poly1305), one line
+ *          for a seal round trip to two recipients, one line with the
+ *          measured stack usage of the password stream against
+ *          STREAM_STACK_BOUND, one line for a --workers job whose first worker
+ *          process is killed mid-range, and a summary line.
+ */
+BOOL RunSelfTests(void);
+
+#endif
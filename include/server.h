@@ -0,0 +1,79 @@
+/**
+ * @file server.h
+ * @brief Long-running serving mode with request coalescing
+ * @details Reads password requests line by line from standard input and writes
+ *          the responses to standard output, so the generator can run as a
+ *          co-process behind a provisioning service instead of being started
+ *          once per password.
+ *
+ *          Request:  one line with the same flags as Advanced CLI Mode, e.g.
+ *                    "--profile=AD-standard --count=5" or "-l=12 -n=4 -s=0",
+ *                    optionally tagged with --tenant=NAME
+ *          Response: "OK <seq> <n>" followed by n password lines, or
+ *                    "ERR <seq> <reason>", where seq is the 1-based request line
+ *                    number. Responses can arrive out of order across tenants.
+ *          A line "QUIT" stops reading; queued requests are still answered.
+ *          A line "RELOAD" (or Ctrl+Break) reloads the profiles from WinPass.ini
+ *          without a restart and is acknowledged with "OK <seq> 0".
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "common.h"
+
+#define SERVE_INPUT_SIZE   65536  /**< Bytes read from standard input per ReadFile */
+#define SERVE_INPUT_LINES  1024   /**< Lines read ahead of the scheduler, each stamped on arrival */
+#define SERVE_WINDOW_MS    1      /**< Default coalescing window (--window=MS) */
+#define SERVE_MAX_WINDOW_MS 1000  /**< Largest accepted --window */
+#define SERVE_LINE_MAX     512    /**< Maximum request line length */
+#define SERVE_MAX_ARGS     32     /**< Maximum flags per request line */
+#define SERVE_MAX_BATCH    128    /**< Maximum requests coalesced into one group */
+#define SERVE_MAX_COUNT    1000   /**< Maximum passwords per request */
+#define SERVE_LATENCY_BUCKETS 32  /**< log2(microseconds) latency histogram size */
+
+#define SERVE_MAX_QUEUED         4096  /**< Requests parsed and not yet answered */
+#define SERVE_MAX_TENANTS        64    /**< Distinct tenants tracked by the scheduler */
+#define SERVE_TENANT_NAME        32    /**< Tenant name buffer, including the terminator */
+#define SERVE_BATCH_PASSWORDS    4096  /**< Maximum passwords coalesced into one group */
+#define SERVE_CHUNK_PASSWORDS    64    /**< Passwords a worker generates before it picks again */
+#define SERVE_INTERACTIVE_SHARE  4     /**< Interactive tenants get at least 1/N of the workers */
+#define SERVE_QUANTUM            4096  /**< Characters credited per round-robin turn and unit of weight */
+#define SERVE_TENANT_PREFIX      "Tenant."  /**< INI section prefix for per-tenant limits */
+
+/**
+ * @brief Runs the serving loop until QUIT or end of input
+ * @param coalesce TRUE to merge requests for the same policy into one group,
+ *        FALSE to generate every request separately with its own stream
+ * @param windowMs Longest coalescing wait in milliseconds (ignored without coalescing)
+ * @return 0 on normal exit, 1 on I/O or memory failure
+ * @details A reader thread blocks on standard input and stamps every line with
+ *          the time its last byte was read, so latency counts the time a request
+ *          waits while the workers are busy. Requests are released to the worker
+ *          pool at once when a worker is idle with nothing queued, or when they
+ *          arrive further apart than windowMs on average; otherwise when the oldest
+ *          one has waited windowMs, when SERVE_BATCH_PASSWORDS passwords or
+ *          SERVE_MAX_BATCH requests are waiting, or at end of input.
+ *          Released requests of the same tenant and policy form one group, and a
+ *          worker keeps its stream (crypto context and random pool) across the
+ *          chunks of a policy; the records are scattered back to each response.
+ *
+ *          One worker thread runs per processor. Each takes SERVE_CHUNK_PASSWORDS
+ *          passwords at a time and picks every chunk afresh: groups of tenants
+ *          with Interactive=1 first, while they have credit, then bulk groups by
+ *          deficit round-robin across tenants, weighted by each tenant's Weight
+ *          and charged in characters generated. Bulk work earns interactive work
+ *          credit, so interactive tenants get at least 1/SERVE_INTERACTIVE_SHARE
+ *          of the pool under contention and wait at most one chunk for a worker.
+ *          A group's responses are written as soon as its last chunk is done.
+ *
+ *          Tenant settings come from the [Tenant.NAME] section of WinPass.ini and
+ *          cannot be set by a client. Tenants with a Rate (passwords/sec) and
+ *          Burst are admitted through a token bucket; over-limit requests, and
+ *          requests larger than Burst, are rejected at once. Diagnostics and the
+ *          final requests/sec and p99 latency summary (overall, interactive and
+ *          per tenant) go to standard error.
+ */
+int RunServeMode(BOOL coalesce, int windowMs);
+
+#endif
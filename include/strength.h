@@ -0,0 +1,68 @@
+/**
+ * @file strength.h
+ * @brief Policy entropy and calibrated crack-time estimates
+ * @details Computes the exact entropy of an advanced-mode configuration and turns
+ *          it into expected cracking times, using hash throughput measured on this
+ *          machine (fast digests, bcrypt and Argon2id) and scaled by an assumed
+ *          attacker rig size.
+ */
+
+#ifndef STRENGTH_H
+#define STRENGTH_H
+
+#include "common.h"
+#include "cli_parser.h"
+
+#define CALIBRATION_SECTION  "Calibration"  /**< INI section holding measured rates */
+#define CALIBRATION_FILE_NAME "Calibration.ini" /**< Rates file in the per-user data directory */
+#define CALIBRATION_MS       500            /**< Measurement time per hash algorithm */
+#define MAX_CALIBRATION_THREADS 64          /**< Upper bound on benchmark threads */
+#define CALIBRATION_MEMORY_LIMIT (1024 * 1024 * 1024) /**< Argon2id memory across all calibration threads */
+
+/**
+ * @brief Computes log2(x) for x > 0 without the C runtime
+ * @param x Positive value
+ * @return Base-2 logarithm of x
+ */
+double Log2(double x);
+
+/**
+ * @brief Computes 2^x without the C runtime
+ * @param x Exponent (expected well within double range)
+ * @return 2 raised to x
+ */
+double Exp2(double x);
+
+/**
+ * @brief Computes the exact entropy of a configuration in bits
+ * @param config Password configuration
+ * @return log2 of the number of equally likely passwords, 0 if nothing is enabled
+ * @details The generator picks each category's characters uniformly and then
+ *          shuffles, so every arrangement is equally likely:
+ *          total! / (L! N! S!) * |letters|^L * |numbers|^N * |symbols|^S,
+ *          times the allowed share of first characters under a leading rule.
+ *          With an --intersect plan, returns the plan's precomputed count.
+ */
+double PolicyEntropyBits(const PasswordConfig* config);
+
+/**
+ * @brief Measures multithreaded hash throughput and stores it per user
+ * @param rates Output: one rate per algorithm, in thousandths of hashes per second
+ * @return TRUE if all algorithms were measured, FALSE otherwise
+ * @details Runs one hashing thread per processor for CALIBRATION_MS per algorithm
+ *          (MD5, SHA-1, SHA-256, bcrypt at cost 10 and 12, Argon2id at the OWASP
+ *          and RFC 9106 settings), each hashing in a tight in-memory loop. The
+ *          rates are written to CALIBRATION_FILE_NAME in %LOCALAPPDATA%\WinPass;
+ *          failing to save them prints a warning with the cause and is not an error.
+ */
+BOOL CalibrateHashRates(ULONGLONG* rates);
+
+/**
+ * @brief Prints entropy and expected crack times for a configuration
+ * @param config Password configuration (uses rigSize and calibrate)
+ * @details Calibrates first if requested or if no stored rates exist. The expected
+ *          time is half the keyspace divided by (measured rate * rig size).
+ */
+void ReportCrackTime(const PasswordConfig* config);
+
+#endif
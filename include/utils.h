@@ -53,6 +53,42 @@ BOOL WStrStartsWith(const WCHAR* wstr, const char* prefix);
  */
 int ExtractValueFromArg(const WCHAR* arg);
 
+/**
+ * @brief Extracts a count from a key=value argument without capping it
+ * @param arg Wide character argument like "--count=2000000"
+ * @param maxValue Largest accepted value
+ * @param value Output for the parsed value
+ * @return TRUE if the text after '=' is a number from 1 to maxValue, FALSE otherwise
+ * @details Unlike ExtractValueFromArg(), a value above the limit is an error
+ *          rather than being clamped, so a large request is never silently cut.
+ */
+BOOL ExtractCountFromArg(const WCHAR* arg, ULONGLONG maxValue, ULONGLONG* value);
+
+/**
+ * @brief Returns the string value of a key=value argument
+ * @param arg Wide character argument like "--output=passwords.txt"
+ * @return Pointer to the text after '=' (inside arg), NULL if no '=' found
+ */
+const WCHAR* ExtractStringFromArg(const WCHAR* arg);
+
+/**
+ * @brief Formats an unsigned 64-bit value in decimal
+ * @param buffer Output buffer (at least 21 bytes)
+ * @param value Value to format
+ * @return Number of characters written, excluding the null terminator
+ * @details wsprintfA() has no portable 64-bit conversion, so counters that can
+ *          exceed 32 bits are formatted with this helper and printed with %s.
+ */
+int FormatULongLong(char* buffer, ULONGLONG value);
+
+/**
+ * @brief Parses an unsigned 64-bit decimal value
+ * @param str Digits only
+ * @param value Output for the parsed value
+ * @return TRUE if str is a non-empty number below 2^64, FALSE otherwise
+ */
+BOOL ParseULongLong(const char* str, ULONGLONG* value);
+
 /**
  * @brief Checks if wide string contains only numeric digits
  * @param wstr Wide character string to validate
@@ -23,6 +23,15 @@
 #include "include/cli_parser.h"
 #include "include/interactive.h"
 #include "include/utils.h"
+#include "include/strength.h"
+#include "include/server.h"
+#include "include/intersect.h"
+#include "include/denylist.h"
+#include "include/seal.h"
+#include "include/profile_cache.h"
+#include "include/bench.h"
+#include "include/selftest.h"
+#include "include/coordinator.h"
 
 /**
  * @brief Main entry point - detects operation mode and routes execution
@@ -86,11 +95,91 @@ int main() {
         else {
             /* MODE 2: ADVANCED CLI MODE - parse flags and generate */
             PasswordConfig config;
-            if (!ParseArguments(szArglist, nArgs, &config)) {
+            BOOL parsed = ParseArguments(szArglist, nArgs, &config);
+
+            /* Profiles are looked up only while parsing; unmap so other runs can update the cache */
+            ProfileCacheClose();
+            if (!parsed) {
                 if (szArglist) LocalFree(szArglist);
                 return 1;
             }
 
+            if (config.keygenPath || config.openPath) {
+                /* Recipient side of sealed delivery; nothing is generated */
+                BOOL ok = config.keygenPath ? GenerateKeyFile(config.keygenPath)
+                                            : OpenSealedFile(config.openPath, config.keyPath);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return ok ? 0 : 1;
+            }
+
+            if (config.compileInput) {
+                /* Offline build of a deny-list table; nothing is generated */
+                BOOL ok = CompileDenyList(config.compileInput, config.outputPath);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return ok ? 0 : 1;
+            }
+
+            if (config.workerPort) {
+                /* Worker process started by a --workers coordinator; ranges arrive over loopback TCP */
+                int exitCode = RunWorker(&config);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return exitCode;
+            }
+
+            if (config.serve) {
+                /* Long-running co-process: requests on stdin, responses on stdout */
+                int exitCode = RunServeMode(config.coalesce, config.windowMs);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return exitCode;
+            }
+
+            if (config.selftest) {
+                /* Known-answer tests only: nothing is generated */
+                BOOL ok = RunSelfTests();
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return ok ? 0 : 1;
+            }
+
+            if (config.bench || config.stress) {
+                /* Benchmarks only: records are generated in memory and discarded */
+                BOOL ok = config.stress ? RunStressTest(&config) : RunBenchmarks(&config);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return ok ? 0 : 1;
+            }
+
+            if (config.showCrackTime) {
+                /* Strength report only: nothing is generated */
+                ReportCrackTime(&config);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return 0;
+            }
+
+            if (config.count > 1 || config.outputPath || config.bounded || config.plan ||
+                config.symbolSet[0] || config.noLeadingDigit || config.noLeadingSymbol || config.denyList || config.sealPath) {
+                /* Bulk output: passwords only, so the result can be redirected to a file.
+                   Bounded mode, policy rules, deny-lists and sealing always take this path, since
+                   GenerateAdvanced() rejects and uses fixed charsets. */
+                BOOL ok = config.workers ? GenerateDistributed(&config, szArglist, nArgs) : GenerateMany(&config);
+                FreeCompositionPlan(config.plan);
+                CloseDenyList(config.denyList);
+                if (szArglist) LocalFree(szArglist);
+                return ok ? 0 : 1;
+            }
+
             ConsoleWrite("WinPass-Native (Advanced CLI Mode)\r\n");
             GenerateAdvanced(config.letterLength, config.numberLength, config.symbolLength,
                            config.useLetters, config.useNumbers, config.useSymbols);
@@ -0,0 +1,331 @@
+/**
+ * @file batch_gen.c
+ * @brief Parallel bulk password generation implementation
+ * @details Each worker thread owns a PasswordStream and claims index ranges of
+ *          the output buffer from a shared counter, so ranges never overlap and
+ *          the only synchronization is one interlocked add per range.
+ */
+
+#include "../include/batch_gen.h"
+#include "../include/password_stream.h"
+#include "../include/denylist.h"
+
+/** Failed-range slot states */
+#define RANGE_NONE     0  /**< Slot unused */
+#define RANGE_PENDING  1  /**< Unfinished range waiting for another worker */
+#define RANGE_CLAIMED  2  /**< Range taken over */
+
+/**
+ * @brief Shared state of one batch job
+ */
+typedef struct {
+    const PasswordConfig* config;            /**< Shared read-only configuration */
+    char* buffer;                            /**< First record */
+    int count;                               /**< Total records */
+    int stride;                              /**< Bytes per record */
+    int threads;                             /**< Worker threads started */
+    volatile LONG next;                      /**< Next unclaimed record index */
+    volatile LONG chunks;                    /**< Ranges handed out */
+    volatile LONG denied;                    /**< Passwords regenerated because the deny-list matched */
+    volatile LONG denyExhausted;             /**< Set when DENY_MAX_RETRIES passwords in a row were denied */
+    volatile LONG failedState[MAX_BATCH_THREADS]; /**< RANGE_* state per worker */
+    int failedFirst[MAX_BATCH_THREADS];      /**< Unfinished range of a failed worker */
+    int failedEnd[MAX_BATCH_THREADS];
+} BatchJob;
+
+/**
+ * @brief Per-worker state
+ */
+typedef struct {
+    BatchJob* job;    /**< Shared job */
+    int index;        /**< Worker number, selects its failed-range slot */
+    int produced;     /**< Records written by this worker */
+    int reassigned;   /**< Records taken over from failed workers */
+    int maxDraws;     /**< Most random draws one of its passwords needed */
+    BOOL failed;      /**< Stopped on a random failure */
+} BatchWorker;
+
+/**
+ * @brief Writes records [first, end) with the worker's stream
+ * @param job Batch job
+ * @param stream Open stream
+ * @param first First record
+ * @param end One past the last record
+ * @return Index of the first record not written (end on success)
+ * @details With a deny-list, a denied password is replaced by the stream's next
+ *          one, which keeps the output uniform over the allowed passwords.
+ */
+static int FillRange(BatchJob* job, PasswordStream* stream, int first, int end) {
+    const DenyList* denyList = job->config->denyList;
+    LONG denied = 0;
+
+    for (int n = first; n < end; n++) {
+        int length;
+        const char* password = StreamNext(stream, &length);
+        int retries = 0;
+        while (password && denyList && IsPasswordDenied(denyList, password, length)) {
+            denied++;
+            if (++retries == DENY_MAX_RETRIES) {
+                InterlockedExchange(&job->denyExhausted, 1);
+                password = NULL;
+            } else {
+                password = StreamNext(stream, &length);
+            }
+        }
+        if (!password) {
+            if (denied) InterlockedExchangeAdd(&job->denied, denied);
+            return n;
+        }
+
+        char* record = job->buffer + n * job->stride;
+        for (int i = 0; i < length; i++) record[i] = password[i];
+        record[length] = '\r';
+        record[length + 1] = '\n';
+    }
+    if (denied) InterlockedExchangeAdd(&job->denied, denied);
+    return end;
+}
+
+/**
+ * @brief Takes over pending ranges left by failed workers
+ * @param worker Worker doing the takeover
+ * @param stream Open stream of that worker
+ * @return TRUE on success, FALSE if the stream failed too
+ */
+static BOOL TakeOverFailedRanges(BatchWorker* worker, PasswordStream* stream) {
+    BatchJob* job = worker->job;
+
+    for (int w = 0; w < job->threads && !job->denyExhausted; w++) {
+        if (InterlockedCompareExchange(&job->failedState[w], RANGE_CLAIMED, RANGE_PENDING) != RANGE_PENDING) continue;
+
+        InterlockedIncrement(&job->chunks);
+        int first = job->failedFirst[w];
+        int end = job->failedEnd[w];
+        int done = FillRange(job, stream, first, end);
+        worker->produced += done - first;
+        worker->reassigned += done - first;
+        if (done < end) {
+            /* Hand the remainder back for the calling thread */
+            job->failedFirst[w] = done;
+            InterlockedExchange(&job->failedState[w], RANGE_PENDING);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Thread procedure: claims ranges until the job is exhausted
+ * @param param Pointer to the BatchWorker
+ * @return 0 on success, 1 on failure
+ */
+static DWORD WINAPI BatchWorkerProc(LPVOID param) {
+    BatchWorker* worker = (BatchWorker*)param;
+    BatchJob* job = worker->job;
+    PasswordStream stream;
+    BOOL open = StreamOpen(&stream, job->config);
+
+    worker->produced = 0;
+    worker->reassigned = 0;
+    worker->maxDraws = 0;
+    worker->failed = FALSE;
+
+    for (;;) {
+        /* The deny-list rejects this policy outright; no other worker can do better */
+        if (job->denyExhausted) break;
+
+        /* Guided self-scheduling: large ranges first, smaller ones near the end */
+        int remaining = job->count - (int)job->next;
+        int chunk = remaining / (2 * job->threads);
+        if (chunk < BATCH_MIN_CHUNK) chunk = BATCH_MIN_CHUNK;
+
+        int first = (int)InterlockedExchangeAdd(&job->next, chunk);
+        if (first >= job->count) break;
+        int end = first + chunk;
+        if (end > job->count) end = job->count;
+        InterlockedIncrement(&job->chunks);
+
+        int done = open ? FillRange(job, &stream, first, end) : first;
+        worker->produced += done - first;
+        if (done < end) {
+            /* Publish the unfinished part of the range, then stop claiming.
+               Deny-list exhaustion is not a worker fault and is never taken over. */
+            job->failedFirst[worker->index] = done;
+            job->failedEnd[worker->index] = end;
+            InterlockedExchange(&job->failedState[worker->index], RANGE_PENDING);
+            worker->failed = TRUE;
+            break;
+        }
+    }
+
+    if (open) {
+        if (!worker->failed && !TakeOverFailedRanges(worker, &stream)) worker->failed = TRUE;
+        worker->maxDraws = stream.maxDraws;
+        StreamClose(&stream);
+    }
+    return worker->failed ? 1 : 0;
+}
+
+/**
+ * @brief Adds the statistics of one GenerateBatch() call to a running total
+ * @param total Running total
+ * @param part Statistics to add
+ */
+void MergeBatchStats(BatchStats* total, const BatchStats* part) {
+    if (part->threads > total->threads) total->threads = part->threads;
+    total->chunks += part->chunks;
+    if (part->minPerThread < total->minPerThread) total->minPerThread = part->minPerThread;
+    if (part->maxPerThread > total->maxPerThread) total->maxPerThread = part->maxPerThread;
+    total->failedWorkers += part->failedWorkers;
+    total->reassigned += part->reassigned;
+    if (part->maxDraws > total->maxDraws) total->maxDraws = part->maxDraws;
+    total->drawBound = part->drawBound;
+    total->denied += part->denied;
+    total->denyExhausted = total->denyExhausted || part->denyExhausted;
+}
+
+/**
+ * @brief Returns the record stride for a configuration
+ * @param config Password configuration
+ * @return Password length + 2 (CRLF)
+ */
+int BatchRecordStride(const PasswordConfig* config) {
+    int length = 0;
+    if (config->useLetters) length += config->letterLength;
+    if (config->useNumbers) length += config->numberLength;
+    if (config->useSymbols) length += config->symbolLength;
+    return length + 2;
+}
+
+/**
+ * @brief Generates count passwords into a contiguous buffer of fixed-stride records
+ * @param config Password configuration
+ * @param count Number of passwords
+ * @param buffer Output buffer (count * stride bytes)
+ * @param stats Optional statistics output
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GenerateBatch(const PasswordConfig* config, int count, char* buffer, BatchStats* stats) {
+    return GenerateBatchThreads(config, count, buffer, 0, stats);
+}
+
+/**
+ * @brief Generates a batch on at most maxThreads worker threads
+ * @param config Password configuration
+ * @param count Number of passwords
+ * @param buffer Output buffer (count * stride bytes)
+ * @param maxThreads Thread limit, 0 for one per processor
+ * @param stats Optional statistics output
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GenerateBatchThreads(const PasswordConfig* config, int count, char* buffer, int maxThreads, BatchStats* stats) {
+    BatchJob job;
+    BatchWorker workers[MAX_BATCH_THREADS];
+    HANDLE threads[MAX_BATCH_THREADS];
+    SYSTEM_INFO sysInfo;
+    int threadCount;
+    BOOL success = TRUE;
+
+    /* One worker per processor, but never fewer than BATCH_MIN_PER_THREAD passwords each */
+    GetSystemInfo(&sysInfo);
+    threadCount = (int)sysInfo.dwNumberOfProcessors;
+    if (threadCount > MAX_BATCH_THREADS) threadCount = MAX_BATCH_THREADS;
+    if (maxThreads > 0 && threadCount > maxThreads) threadCount = maxThreads;
+    if (threadCount > count / BATCH_MIN_PER_THREAD) threadCount = count / BATCH_MIN_PER_THREAD;
+    if (threadCount < 1) threadCount = 1;
+
+    job.config = config;
+    job.buffer = buffer;
+    job.count = count;
+    job.stride = BatchRecordStride(config);
+    job.threads = threadCount;
+    job.next = 0;
+    job.chunks = 0;
+    job.denied = 0;
+    job.denyExhausted = 0;
+    for (int t = 0; t < MAX_BATCH_THREADS; t++) job.failedState[t] = RANGE_NONE;
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].job = &job;
+        workers[t].index = t;
+    }
+
+    int started = 0;
+    if (threadCount == 1) {
+        /* Small jobs run on the calling thread to avoid thread start-up cost */
+        BatchWorkerProc(&workers[0]);
+        started = 1;
+    } else {
+        for (int t = 0; t < threadCount; t++) {
+            threads[t] = CreateThread(NULL, 0, BatchWorkerProc, &workers[t], 0, NULL);
+            if (!threads[t]) break;
+            started++;
+        }
+        /* Workers that could not start simply never claim; the others cover the job */
+        if (started == 0) {
+            BatchWorkerProc(&workers[0]);
+            started = 1;
+        } else {
+            WaitForMultipleObjects((DWORD)started, threads, TRUE, INFINITE);
+            for (int t = 0; t < started; t++) CloseHandle(threads[t]);
+        }
+    }
+
+    /* Coordinator: finish ranges no surviving worker took over, and the unclaimed
+       tail if every worker stopped early */
+    int reassigned = 0;
+    int maxDraws = 0;
+    PasswordStream stream;
+    BOOL streamOpen = FALSE;
+    for (int t = 0; t <= MAX_BATCH_THREADS && success; t++) {
+        int first, end;
+        if (t < MAX_BATCH_THREADS) {
+            if (job.failedState[t] != RANGE_PENDING) continue;
+            job.failedState[t] = RANGE_CLAIMED;
+            first = job.failedFirst[t];
+            end = job.failedEnd[t];
+        } else {
+            if ((int)job.next >= count) break;
+            first = (int)job.next;
+            end = count;
+        }
+
+        /* Retrying is pointless when the deny-list rejects this policy outright */
+        if (job.denyExhausted) {
+            success = FALSE;
+            break;
+        }
+        job.chunks++;
+        if (!streamOpen && !(streamOpen = StreamOpen(&stream, config))) {
+            success = FALSE;
+            break;
+        }
+        int done = FillRange(&job, &stream, first, end);
+        reassigned += done - first;
+        if (done < end) success = FALSE;
+    }
+    if (streamOpen) {
+        maxDraws = stream.maxDraws;
+        StreamClose(&stream);
+    }
+
+    if (stats) {
+        stats->threads = started;
+        stats->chunks = (int)job.chunks;
+        stats->minPerThread = count;
+        stats->maxPerThread = 0;
+        stats->failedWorkers = 0;
+        stats->reassigned = reassigned;
+        stats->maxDraws = maxDraws;
+        stats->denied = (int)job.denied;
+        stats->denyExhausted = job.denyExhausted != 0;
+        stats->drawBound = config->bounded ? STREAM_BOUNDED_DRAWS(job.stride - 2, config->plan != NULL) : 0;
+        for (int t = 0; t < started; t++) {
+            if (workers[t].produced < stats->minPerThread) stats->minPerThread = workers[t].produced;
+            if (workers[t].produced > stats->maxPerThread) stats->maxPerThread = workers[t].produced;
+            if (workers[t].failed) stats->failedWorkers++;
+            stats->reassigned += workers[t].reassigned;
+            if (workers[t].maxDraws > stats->maxDraws) stats->maxDraws = workers[t].maxDraws;
+        }
+    }
+    return success;
+}
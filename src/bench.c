@@ -0,0 +1,341 @@
+/**
+ * @file bench.c
+ * @brief In-process benchmark implementation
+ * @details Every measurement uses the performance counter around the public
+ *          interface only, and generated records are wiped afterwards like in
+ *          the regular bulk path.
+ */
+
+#include "../include/bench.h"
+#include "../include/console_io.h"
+#include "../include/batch_gen.h"
+#include "../include/password_stream.h"
+#include "../include/profile_cache.h"
+#include "../include/denylist.h"
+#include "../include/utils.h"
+
+/**
+ * @brief Prints one benchmark result line
+ * @param label What was measured
+ * @param threads Threads used
+ * @param count Passwords generated
+ * @param ticks Elapsed performance counter ticks
+ * @param freq Performance counter frequency
+ */
+static void PrintBenchResult(const char* label, int threads, int count, LONGLONG ticks, LONGLONG freq) {
+    char msgBuf[192];
+    LONGLONG micros = ticks * 1000000 / freq;
+    if (micros < 1) micros = 1;
+
+    wsprintfA(msgBuf, "[BENCH] %-14s %2d threads: %lu ns per password, %lu passwords/s\r\n",
+              label, threads, (DWORD)(micros * 1000 / count), (DWORD)((LONGLONG)count * 1000000 / micros));
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Compares the stream API with the batch API on the same record buffer
+ * @param config Password configuration
+ * @param count Passwords per measurement
+ * @return TRUE on success, FALSE on failure (error already printed)
+ */
+static BOOL BenchStreamVsBatch(const PasswordConfig* config, int count) {
+    HANDLE hHeap = GetProcessHeap();
+    LARGE_INTEGER freq, start, end;
+    PasswordStream stream;
+    BatchStats stats;
+    int stride = BatchRecordStride(config);
+    SIZE_T size = (SIZE_T)count * stride;
+
+    char* buffer = (char*)HeapAlloc(hHeap, 0, size);
+    if (!buffer) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    QueryPerformanceFrequency(&freq);
+
+    /* Touch every page first so neither measurement pays for the page faults */
+    ZeroMemory(buffer, size);
+
+    /* Stream API: one stream, one thread, the same record layout as GenerateBatch() */
+    if (!StreamOpen(&stream, config)) {
+        ConsoleWrite("[ERROR] Invalid configuration or CryptoAPI failure.\r\n");
+        HeapFree(hHeap, 0, buffer);
+        return FALSE;
+    }
+    QueryPerformanceCounter(&start);
+    for (int n = 0; n < count; n++) {
+        int length;
+        const char* password = StreamNext(&stream, &length);
+        if (!password) break;
+        char* record = buffer + (SIZE_T)n * stride;
+        for (int i = 0; i < length; i++) record[i] = password[i];
+        record[length] = '\r';
+        record[length + 1] = '\n';
+    }
+    QueryPerformanceCounter(&end);
+    StreamClose(&stream);
+    PrintBenchResult("Stream API", 1, count, end.QuadPart - start.QuadPart, freq.QuadPart);
+
+    /* Batch API: same count, one worker per processor */
+    QueryPerformanceCounter(&start);
+    BOOL ok = GenerateBatch(config, count, buffer, &stats);
+    QueryPerformanceCounter(&end);
+    if (ok) PrintBenchResult("Batch API", stats.threads, count, end.QuadPart - start.QuadPart, freq.QuadPart);
+    else PrintError("GenRandom Failed");
+
+    SecureZeroMemory(buffer, size);
+    HeapFree(hHeap, 0, buffer);
+    return ok;
+}
+
+/**
+ * @brief Compares profile lookups from WinPass.ini with lookups from the compiled cache
+ * @return TRUE on success, FALSE on failure (error already printed)
+ * @details Each cached lookup opens, maps and validates the cache first, as a
+ *          new process does, so the difference is the startup time saved.
+ */
+static BOOL BenchProfileLookup(void) {
+    HANDLE hHeap = GetProcessHeap();
+    LARGE_INTEGER freq, start, end;
+    LONGLONG ticks[2];
+    ProfileEntry entry;
+    char msgBuf[192];
+    int count;
+
+    /* Copy the names: the cache is closed between lookups */
+    const ProfileEntry* entries = ProfileCacheEntries(&count);
+    if (!entries || count == 0) {
+        ConsoleWrite("[BENCH] Profile lookup: no profile cache available, skipped\r\n");
+        return TRUE;
+    }
+    char (*names)[MAX_PROFILE_NAME] = (char (*)[MAX_PROFILE_NAME])HeapAlloc(hHeap, 0, (SIZE_T)count * MAX_PROFILE_NAME);
+    if (!names) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    for (int i = 0; i < count; i++) lstrcpyA(names[i], entries[i].name);
+
+    QueryPerformanceFrequency(&freq);
+    for (int cached = 0; cached <= 1; cached++) {
+        ProfileCacheEnable(cached);
+        QueryPerformanceCounter(&start);
+        for (int round = 0; round < BENCH_PROFILE_ROUNDS; round++) {
+            for (int i = 0; i < count; i++) {
+                ProfileCacheClose();
+                if (!FindProfile(names[i], &entry)) {
+                    ProfileCacheEnable(TRUE);
+                    HeapFree(hHeap, 0, names);
+                    return FALSE;
+                }
+            }
+        }
+        QueryPerformanceCounter(&end);
+        ticks[cached] = end.QuadPart - start.QuadPart;
+    }
+    ProfileCacheClose();
+    HeapFree(hHeap, 0, names);
+
+    LONGLONG lookups = (LONGLONG)BENCH_PROFILE_ROUNDS * count;
+    wsprintfA(msgBuf, "[BENCH] Profile lookup: %lu ns from %s, %lu ns from the mapped cache (%d profiles)\r\n",
+              (DWORD)(ticks[0] * 1000000000 / freq.QuadPart / lookups), PROFILE_FILE_NAME,
+              (DWORD)(ticks[1] * 1000000000 / freq.QuadPart / lookups), count);
+    ConsoleWrite(msgBuf);
+    return TRUE;
+}
+
+/**
+ * @brief Runs all benchmarks for a configuration and prints the results
+ * @param config Password configuration
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL RunBenchmarks(const PasswordConfig* config) {
+    char msgBuf[128];
+    int count = config->count > 1 ? config->count : BENCH_DEFAULT_COUNT;
+    int length = BatchRecordStride(config) - 2;
+
+    if ((!config->useLetters && !config->useNumbers && !config->useSymbols) ||
+        length < MIN_PASSWORD_LENGTH || length > MAX_PASSWORD_LENGTH) {
+        ConsoleWrite("[ERROR] Invalid configuration for benchmarking.\r\n");
+        return FALSE;
+    }
+
+    wsprintfA(msgBuf, "[BENCH] %d passwords of %d characters per measurement\r\n", count, length);
+    ConsoleWrite(msgBuf);
+    wsprintfA(msgBuf, "[BENCH] Stream state: %d bytes (STREAM_POOL_SIZE %d)\r\n", (int)sizeof(PasswordStream), STREAM_POOL_SIZE);
+    ConsoleWrite(msgBuf);
+    if (!BenchStreamVsBatch(config, count)) return FALSE;
+
+    if (config->plan) {
+        wsprintfA(msgBuf, "[BENCH] Intersection plan: %s in %lu us\r\n",
+                  config->plan->cached ? "loaded from cache" : "compiled", config->plan->compileMicros);
+        ConsoleWrite(msgBuf);
+    }
+    return BenchProfileLookup();
+}
+
+/**
+ * @brief Maps a latency to its histogram bucket
+ * @param ns Latency in nanoseconds
+ * @return Bucket index below STRESS_BUCKETS
+ * @details Values below 2 * STRESS_SUB_BUCKETS have a bucket each; above that,
+ *          every power of two is split into STRESS_SUB_BUCKETS buckets.
+ */
+static int StressBucket(ULONGLONG ns) {
+    int shift = 0;
+
+    while ((ns >> shift) >= 2 * STRESS_SUB_BUCKETS) shift++;
+    int index = shift * STRESS_SUB_BUCKETS + (int)(ns >> shift);
+    return index < STRESS_BUCKETS ? index : STRESS_BUCKETS - 1;
+}
+
+/**
+ * @brief Returns the largest latency a histogram bucket can hold
+ * @param index Bucket index
+ * @return Upper bound in nanoseconds, so percentiles are never understated
+ */
+static ULONGLONG StressBucketLimit(int index) {
+    int shift = index < 2 * STRESS_SUB_BUCKETS ? 0 : index / STRESS_SUB_BUCKETS - 1;
+    ULONGLONG base = (ULONGLONG)(index - shift * STRESS_SUB_BUCKETS);
+    return ((base + 1) << shift) - 1;
+}
+
+/**
+ * @brief Finds the latency below which a fraction of the passwords finished
+ * @param histogram Latency histogram
+ * @param total Passwords counted
+ * @param perMillion Fraction in parts per million (500000 for p50)
+ * @return Bucket upper bound in nanoseconds
+ */
+static ULONGLONG StressPercentile(const ULONGLONG* histogram, ULONGLONG total, ULONGLONG perMillion) {
+    ULONGLONG rank = total - total * (1000000 - perMillion) / 1000000;
+    ULONGLONG seen = 0;
+
+    for (int i = 0; i < STRESS_BUCKETS; i++) {
+        seen += histogram[i];
+        if (seen >= rank && seen > 0) return StressBucketLimit(i);
+    }
+    return StressBucketLimit(STRESS_BUCKETS - 1);
+}
+
+/**
+ * @brief Prints one latency figure as "label N ns"
+ * @param msgBuf Output line being built
+ * @param label Figure name
+ * @param ns Latency in nanoseconds
+ */
+static void AppendLatency(char* msgBuf, const char* label, ULONGLONG ns) {
+    char number[24];
+
+    number[FormatULongLong(number, ns)] = '\0';
+    lstrcatA(msgBuf, label);
+    lstrcatA(msgBuf, number);
+    lstrcatA(msgBuf, " ns");
+}
+
+
+/**
+ * @brief Times every password of a long single-stream run and prints its latency distribution
+ * @param config Password configuration
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL RunStressTest(const PasswordConfig* config) {
+    HANDLE hHeap = GetProcessHeap();
+    const DenyList* denyList = config->denyList;
+    LARGE_INTEGER freq, start, end;
+    PasswordStream stream;
+    ULONGLONG maxNs = 0, maxRefillNs = 0, generated = 0, overheadNs = ~0ULL;
+    char msgBuf[256];
+    char number[24];
+
+    ULONGLONG* histogram = (ULONGLONG*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, STRESS_BUCKETS * sizeof(ULONGLONG));
+    if (!histogram) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    if (!StreamOpen(&stream, config)) {
+        ConsoleWrite("[ERROR] Invalid configuration or CryptoAPI failure.\r\n");
+        HeapFree(hHeap, 0, histogram);
+        return FALSE;
+    }
+    QueryPerformanceFrequency(&freq);
+
+    /* The cheapest back-to-back counter reads: what the timing itself adds */
+    for (int i = 0; i < 1000; i++) {
+        QueryPerformanceCounter(&start);
+        QueryPerformanceCounter(&end);
+        ULONGLONG ns = (ULONGLONG)(end.QuadPart - start.QuadPart) * 1000000000 / (ULONGLONG)freq.QuadPart;
+        if (ns < overheadNs) overheadNs = ns;
+    }
+
+    number[FormatULongLong(number, config->stress)] = '\0';
+    wsprintfA(msgBuf, "[STRESS] %s passwords of %d characters on one stream (%s sampling, %s refills)\r\n",
+              number, stream.length, config->bounded ? "bounded" : "rejection",
+              config->asyncRefill ? "async" : "inline");
+    ConsoleWrite(msgBuf);
+
+    while (generated < config->stress) {
+        int length;
+        ULONGLONG refills = stream.refills;
+        int retries = 0;
+
+        QueryPerformanceCounter(&start);
+        const char* password = StreamNext(&stream, &length);
+        while (password && denyList && IsPasswordDenied(denyList, password, length)) {
+            if (++retries == DENY_MAX_RETRIES) password = NULL;
+            else password = StreamNext(&stream, &length);
+        }
+        QueryPerformanceCounter(&end);
+        if (!password) break;
+
+        ULONGLONG ns = (ULONGLONG)(end.QuadPart - start.QuadPart) * 1000000000 / (ULONGLONG)freq.QuadPart;
+        histogram[StressBucket(ns)]++;
+        if (ns > maxNs) maxNs = ns;
+        if (stream.refills != refills && ns > maxRefillNs) maxRefillNs = ns;
+        generated++;
+    }
+    int maxDraws = stream.maxDraws;
+    ULONGLONG totalRefills = stream.refills;
+    StreamClose(&stream);
+
+    BOOL ok = generated == config->stress;
+    if (!ok) {
+        if (denyList) {
+            /* A damaged table denies everything and has already said so */
+            if (!denyList->corrupt) {
+                wsprintfA(msgBuf, "[ERROR] The deny-list rejected %d passwords in a row; this policy is too weak for it.\r\n",
+                          DENY_MAX_RETRIES);
+                ConsoleWrite(msgBuf);
+            }
+        } else {
+            PrintError("GenRandom Failed");
+        }
+    } else {
+        lstrcpyA(msgBuf, "[STRESS] Latency:");
+        AppendLatency(msgBuf, " p50 ", StressPercentile(histogram, generated, 500000));
+        AppendLatency(msgBuf, ", p99 ", StressPercentile(histogram, generated, 990000));
+        AppendLatency(msgBuf, ", p99.99 ", StressPercentile(histogram, generated, 999900));
+        AppendLatency(msgBuf, ", max ", maxNs);
+        lstrcatA(msgBuf, "\r\n");
+        ConsoleWrite(msgBuf);
+
+        number[FormatULongLong(number, totalRefills)] = '\0';
+        lstrcpyA(msgBuf, "[STRESS] Pool refills: ");
+        lstrcatA(msgBuf, number);
+        AppendLatency(msgBuf, ", slowest password with a refill ", maxRefillNs);
+        AppendLatency(msgBuf, "; timer overhead ", overheadNs);
+        lstrcatA(msgBuf, " (included)\r\n");
+        ConsoleWrite(msgBuf);
+
+        if (config->bounded) {
+            wsprintfA(msgBuf, "[STRESS] Random draws per password: max %d (bounded at %d).\r\n",
+                      maxDraws, STREAM_BOUNDED_DRAWS(stream.length, config->plan != NULL));
+        } else {
+            wsprintfA(msgBuf, "[STRESS] Random draws per password: max %d (rejection sampling, no fixed bound).\r\n",
+                      maxDraws);
+        }
+        ConsoleWrite(msgBuf);
+    }
+
+    HeapFree(hHeap, 0, histogram);
+    return ok;
+}
@@ -8,6 +8,12 @@
 #include "../include/cli_parser.h"
 #include "../include/utils.h"
 #include "../include/console_io.h"
+#include "../include/profile.h"
+#include "../include/intersect.h"
+#include "../include/denylist.h"
+#include "../include/server.h"
+#include "../include/coordinator.h"
+#include "../include/bench.h"
 
 /**
  * @brief Parses command line arguments into PasswordConfig structure
@@ -24,6 +30,35 @@ BOOL ParseArguments(LPWSTR* args, int count, PasswordConfig* config) {
     config->letterLength = 8;
     config->numberLength = 4;
     config->symbolLength = 4;
+    config->count = 1;
+    config->outputPath = NULL;
+    config->showCrackTime = FALSE;
+    config->calibrate = FALSE;
+    config->rigSize = 1;
+    config->serve = FALSE;
+    config->coalesce = TRUE;
+    config->windowMs = SERVE_WINDOW_MS;
+    config->bounded = FALSE;
+    config->asyncRefill = FALSE;
+    config->symbolSet[0] = '\0';
+    config->noLeadingDigit = FALSE;
+    config->noLeadingSymbol = FALSE;
+    config->plan = NULL;
+    config->compileInput = NULL;
+    config->denyList = NULL;
+    config->sealPath = NULL;
+    config->openPath = NULL;
+    config->keyPath = NULL;
+    config->keygenPath = NULL;
+    config->bench = FALSE;
+    config->stress = 0;
+    config->selftest = FALSE;
+    config->workers = 0;
+    config->workerPort = 0;
+    const WCHAR* intersect = NULL;
+    const WCHAR* deny = NULL;
+    char ruleProfiles[MAX_INTERSECT_NAMES];  /* --profile names whose rules need a plan */
+    int ruleLength = 0;
 
     /* Process all arguments starting from index 1 (skip program name at index 0) */
     for (int i = 1; i < count; i++) {
@@ -43,6 +78,194 @@ BOOL ParseArguments(LPWSTR* args, int count, PasswordConfig* config) {
             config->useSymbols = FALSE;
             recognized = TRUE;
         }
+        /* Strength report: estimate crack time instead of generating */
+        else if (WStrEquals(arg, "--crack-time")) {
+            config->showCrackTime = TRUE;
+            recognized = TRUE;
+        }
+        else if (WStrEquals(arg, "--calibrate")) {
+            config->showCrackTime = TRUE;
+            config->calibrate = TRUE;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--rig=")) {
+            int val = ExtractValueFromArg(arg);
+            if (val <= 0) {
+                ConsoleWrite("[ERROR] Invalid value for --rig. Expected a positive number.\r\n");
+                return FALSE;
+            }
+            config->showCrackTime = TRUE;
+            config->rigSize = val;
+            recognized = TRUE;
+        }
+        /* Serve mode: answer request lines from stdin until QUIT or end of input */
+        else if (WStrEquals(arg, "--serve")) {
+            config->serve = TRUE;
+            recognized = TRUE;
+        }
+        else if (WStrEquals(arg, "--no-coalesce")) {
+            config->coalesce = FALSE;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--window=")) {
+            int val = ExtractValueFromArg(arg);
+            if (!IsWStrNumeric(ExtractStringFromArg(arg)) || val > SERVE_MAX_WINDOW_MS) {
+                ConsoleWrite("[ERROR] Invalid value for --window. Expected 0 to 1000 milliseconds.\r\n");
+                return FALSE;
+            }
+            config->windowMs = val;
+            recognized = TRUE;
+        }
+        /* Benchmarks: time the generation interfaces instead of generating output */
+        else if (WStrEquals(arg, "--bench")) {
+            config->bench = TRUE;
+            recognized = TRUE;
+        }
+        /* Stress run: per-password latency over a 64-bit count */
+        else if (WStrStartsWith(arg, "--stress=")) {
+            if (!ExtractCountFromArg(arg, STRESS_MAX_COUNT, &config->stress)) {
+                ConsoleWrite("[ERROR] Invalid value for --stress. Expected a number from 1 to 1000000000000000.\r\n");
+                return FALSE;
+            }
+            recognized = TRUE;
+        }
+        /* Self-test: check the built-in primitives against published vectors */
+        else if (WStrEquals(arg, "--selftest")) {
+            config->selftest = TRUE;
+            recognized = TRUE;
+        }
+        /* Worker processes: a coordinator hands them index ranges over loopback TCP */
+        else if (WStrStartsWith(arg, "--workers=")) {
+            int val = ExtractValueFromArg(arg);
+            if (val < 1 || val > COORD_MAX_WORKERS) {
+                char errorBuf[96];
+                wsprintfA(errorBuf, "[ERROR] Invalid value for --workers. Expected 1 to %d.\r\n", COORD_MAX_WORKERS);
+                ConsoleWrite(errorBuf);
+                return FALSE;
+            }
+            config->workers = val;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--worker=")) {
+            int val = ExtractValueFromArg(arg);
+            if (val < 1 || val > 65535) {
+                ConsoleWrite("[ERROR] Invalid value for --worker. Expected a port number.\r\n");
+                return FALSE;
+            }
+            config->workerPort = val;
+            recognized = TRUE;
+        }
+        /* Bounded latency: fixed random draws per password, no rejection loop */
+        else if (WStrEquals(arg, "--bounded")) {
+            config->bounded = TRUE;
+            recognized = TRUE;
+        }
+        /* Pool refills on a helper thread, off the generating thread */
+        else if (WStrEquals(arg, "--async-refill")) {
+            config->asyncRefill = TRUE;
+            recognized = TRUE;
+        }
+        /* Named profile: applied in place, so later flags override its values */
+        else if (WStrStartsWith(arg, "--profile=") || WStrStartsWith(arg, "-p=")) {
+            const WCHAR* value = ExtractStringFromArg(arg);
+            char name[MAX_PROFILE_NAME];
+            int j = 0;
+
+            char errorBuf[96];
+            BOOL hasRules;
+
+            /* Profile names are ASCII section names; narrow for the INI API */
+            while (value && value[j] != L'\0' && j < MAX_PROFILE_NAME - 1) {
+                name[j] = (char)value[j];
+                j++;
+            }
+            name[j] = '\0';
+
+            if (j == 0) {
+                ConsoleWrite("[ERROR] Invalid value for --profile. Expected a profile name.\r\n");
+                return FALSE;
+            }
+            /* A cut name could select a different profile */
+            if (value[j] != L'\0') {
+                wsprintfA(errorBuf, "[ERROR] Invalid value for --profile. Profile names are at most %d characters.\r\n",
+                          MAX_PROFILE_NAME - 1);
+                ConsoleWrite(errorBuf);
+                return FALSE;
+            }
+            if (!LoadProfile(name, config, &hasRules)) return FALSE;
+
+            /* Length window and minimums: compiled like a one-policy --intersect at the end */
+            if (hasRules) {
+                if (ruleLength + j + 1 >= MAX_INTERSECT_NAMES) {
+                    ConsoleWrite("[ERROR] Too many profiles with rules for --profile.\r\n");
+                    return FALSE;
+                }
+                if (ruleLength > 0) ruleProfiles[ruleLength++] = ',';
+                lstrcpyA(ruleProfiles + ruleLength, name);
+                ruleLength += j;
+            }
+            recognized = TRUE;
+        }
+        /* Policy intersection: compiled once all other flags are known */
+        else if (WStrStartsWith(arg, "--intersect=")) {
+            intersect = ExtractStringFromArg(arg);
+            recognized = TRUE;
+        }
+        /* Deny-lists: compile a text list, or map a compiled table once all flags are known */
+        else if (WStrStartsWith(arg, "--compile-denylist=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --compile-denylist. Expected a file path.\r\n");
+                return FALSE;
+            }
+            config->compileInput = path;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--deny=")) {
+            deny = ExtractStringFromArg(arg);
+            if (!deny || *deny == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --deny. Expected a compiled deny-list file.\r\n");
+                return FALSE;
+            }
+            recognized = TRUE;
+        }
+        /* Sealed delivery: recipient keys, opening a sealed file, key pairs */
+        else if (WStrStartsWith(arg, "--seal=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --seal. Expected a recipient key file.\r\n");
+                return FALSE;
+            }
+            config->sealPath = path;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--open=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --open. Expected a sealed file.\r\n");
+                return FALSE;
+            }
+            config->openPath = path;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--key=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --key. Expected a secret key file.\r\n");
+                return FALSE;
+            }
+            config->keyPath = path;
+            recognized = TRUE;
+        }
+        else if (WStrStartsWith(arg, "--keygen=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --keygen. Expected a new key file path.\r\n");
+                return FALSE;
+            }
+            config->keygenPath = path;
+            recognized = TRUE;
+        }
         /* Length configuration: parse value after '=' delimiter */
         else if (WStrStartsWith(arg, "--letters=") || WStrStartsWith(arg, "-l=")) {
             int val = ExtractValueFromArg(arg);
@@ -71,6 +294,29 @@ BOOL ParseArguments(LPWSTR* args, int count, PasswordConfig* config) {
             if (val >= 0 && val < MAX_CATEGORY_LENGTH) config->symbolLength = val;
             recognized = TRUE;
         }
+        /* Password count: parsed in full, so values above the limit are rejected, not capped */
+        else if (WStrStartsWith(arg, "--count=") || WStrStartsWith(arg, "-c=")) {
+            ULONGLONG val;
+            if (!ExtractCountFromArg(arg, MAX_BULK_COUNT, &val)) {
+                char errorBuf[96];
+                wsprintfA(errorBuf, "[ERROR] Invalid value for --count. Expected a number from 1 to %lu.\r\n",
+                          (DWORD)MAX_BULK_COUNT);
+                ConsoleWrite(errorBuf);
+                return FALSE;
+            }
+            config->count = (int)val;
+            recognized = TRUE;
+        }
+        /* Bulk output file: keep a pointer to the path inside the argument array */
+        else if (WStrStartsWith(arg, "--output=") || WStrStartsWith(arg, "-o=")) {
+            const WCHAR* path = ExtractStringFromArg(arg);
+            if (!path || *path == L'\0') {
+                ConsoleWrite("[ERROR] Invalid value for --output. Expected a file path.\r\n");
+                return FALSE;
+            }
+            config->outputPath = path;
+            recognized = TRUE;
+        }
         
         /* Check for unrecognized flag (starts with '-') */
         if (!recognized && arg[0] == L'-') {
@@ -91,6 +337,67 @@ BOOL ParseArguments(LPWSTR* args, int count, PasswordConfig* config) {
             return FALSE;
         }
     }
+
+    if (intersect || ruleLength > 0) {
+        char names[MAX_INTERSECT_NAMES];
+        int j = ruleLength;
+
+        /* Rule profiles first, then the --intersect list */
+        lstrcpynA(names, ruleProfiles, ruleLength + 1);
+        if (intersect && ruleLength > 0) names[j++] = ',';
+
+        /* Profile names are ASCII section names; narrow for the INI API */
+        for (int k = 0; intersect && intersect[k] != L'\0'; k++) {
+            /* A cut list would drop or rename the last policy */
+            if (j == MAX_INTERSECT_NAMES - 1) {
+                ConsoleWrite(ruleLength > 0 ? "[ERROR] Too many policies for --profile and --intersect.\r\n"
+                                            : "[ERROR] Too many policies for --intersect.\r\n");
+                return FALSE;
+            }
+            names[j++] = (char)intersect[k];
+        }
+        names[j] = '\0';
+        if (!IntersectPolicies(names, config)) return FALSE;
+    }
+
+    if (config->openPath && !config->keyPath) {
+        ConsoleWrite("[ERROR] --open needs --key=FILE with the recipient's secret key.\r\n");
+        FreeCompositionPlan(config->plan);
+        return FALSE;
+    }
+
+    if (config->compileInput && !config->outputPath) {
+        ConsoleWrite("[ERROR] --compile-denylist needs --output=FILE for the compiled table.\r\n");
+        FreeCompositionPlan(config->plan);
+        return FALSE;
+    }
+
+    if (config->workers && !config->outputPath) {
+        ConsoleWrite("[ERROR] --workers needs --output=FILE; records are written at their offsets.\r\n");
+        FreeCompositionPlan(config->plan);
+        return FALSE;
+    }
+
+    if (config->workers && config->sealPath) {
+        ConsoleWrite("[ERROR] --workers cannot be combined with --seal.\r\n");
+        FreeCompositionPlan(config->plan);
+        return FALSE;
+    }
+
+    /* A denied password is drawn again, so no fixed number of draws holds */
+    if (deny && config->bounded) {
+        ConsoleWrite("[ERROR] --deny cannot be combined with --bounded; replacing denied passwords has no draw bound.\r\n");
+        FreeCompositionPlan(config->plan);
+        return FALSE;
+    }
+
+    if (deny) {
+        config->denyList = OpenDenyList(deny);
+        if (!config->denyList) {
+            FreeCompositionPlan(config->plan);
+            return FALSE;
+        }
+    }
     
     return TRUE;
 }
\ No newline at end of file
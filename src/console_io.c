@@ -19,6 +19,19 @@ void ConsoleWrite(const char* str) {
     }
 }
 
+/**
+ * @brief Writes a byte range to console output
+ * @param data Bytes to write
+ * @param length Number of bytes to write
+ */
+void ConsoleWriteN(const char* data, int length) {
+    HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD bytesWritten;
+    if (hStdOut != INVALID_HANDLE_VALUE && length > 0) {
+        WriteFile(hStdOut, data, (DWORD)length, &bytesWritten, NULL);
+    }
+}
+
 /**
  * @brief Reads user input from console with CRLF handling
  * @param buffer Buffer to store input
@@ -103,6 +116,27 @@ void ShowHelp() {
     ConsoleWrite("       --letters=N, -l=N    Number of letter characters (default: 8)\r\n");
     ConsoleWrite("       --numbers=N, -n=N    Number of numeric characters (default: 4)\r\n");
     ConsoleWrite("       --symbols=N, -s=N    Number of symbol characters (default: 4)\r\n");
+    ConsoleWrite("       --count=N, -c=N      Generate N passwords, one per line (default: 1)\r\n");
+    ConsoleWrite("       --output=F, -o=F     Write bulk output to file F\r\n");
+    ConsoleWrite("       --workers=N          Generate --output with N worker processes\r\n");
+    ConsoleWrite("       --profile=P, -p=P    Load profile P from WinPass.ini\r\n");
+    ConsoleWrite("       --intersect=P1,P2    One password accepted by all listed profiles\r\n");
+    ConsoleWrite("       --deny=F             Skip passwords with an entry of F (no --bounded)\r\n");
+    ConsoleWrite("       --compile-denylist=F Compile word list F into the --output table\r\n");
+    ConsoleWrite("       --seal=F             Seal one password to each public key in F\r\n");
+    ConsoleWrite("       --open=F --key=K     Print the passwords in F sealed to secret key K\r\n");
+    ConsoleWrite("       --keygen=K           Write a new secret key to K, print its public key\r\n");
+    ConsoleWrite("       --crack-time         Show entropy and crack-time estimates\r\n");
+    ConsoleWrite("       --calibrate          Re-measure hash throughput for estimates\r\n");
+    ConsoleWrite("       --rig=N              Attacker rig size (x this machine, default: 1)\r\n");
+    ConsoleWrite("       --bounded            Fixed random draws per password (no rejection)\r\n");
+    ConsoleWrite("       --async-refill       Refill the random pool on a helper thread\r\n");
+    ConsoleWrite("       --bench              Time the stream and batch APIs (--count=N passwords)\r\n");
+    ConsoleWrite("       --stress=N           Time each of N passwords; print p50/p99/max latency\r\n");
+    ConsoleWrite("       --selftest           Check hashes and ciphers against test vectors\r\n");
+    ConsoleWrite("       --serve              Answer request lines from stdin (one per line)\r\n");
+    ConsoleWrite("       --no-coalesce        Serve mode: generate each request separately\r\n");
+    ConsoleWrite("       --window=MS          Serve mode: longest coalescing wait (default: 1 ms)\r\n");
     ConsoleWrite("       --no-letters         Disable letters\r\n");
     ConsoleWrite("       --no-numbers         Disable numbers\r\n");
     ConsoleWrite("       --no-symbols         Disable symbols\r\n");
@@ -110,7 +144,15 @@ void ShowHelp() {
     ConsoleWrite("     Examples:\r\n");
     ConsoleWrite("       WinPass.exe --letters=10 --numbers=5 --symbols=5\r\n");
     ConsoleWrite("       WinPass.exe --no-symbols --letters=12 --numbers=4\r\n");
-    ConsoleWrite("       WinPass.exe -l=8 -n=8 -s=0\r\n\r\n");
+    ConsoleWrite("       WinPass.exe -l=8 -n=8 -s=0\r\n");
+    ConsoleWrite("       WinPass.exe --count=100 > passwords.txt\r\n");
+    ConsoleWrite("       WinPass.exe --count=50000 --output=passwords.txt\r\n");
+    ConsoleWrite("       WinPass.exe --count=10000000 --output=passwords.txt --workers=4\r\n");
+    ConsoleWrite("       WinPass.exe --profile=AD-standard\r\n");
+    ConsoleWrite("       WinPass.exe --profile=AD-standard --crack-time --rig=100\r\n");
+    ConsoleWrite("       WinPass.exe --compile-denylist=words.txt --output=words.wpdl\r\n");
+    ConsoleWrite("       WinPass.exe --deny=words.wpdl --count=1000\r\n");
+    ConsoleWrite("       WinPass.exe --seal=recipients.txt --output=sealed.txt\r\n\r\n");
     
     /* Mode 3: Interactive */
     ConsoleWrite("  3. Interactive Mode:\r\n");
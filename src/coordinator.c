@@ -0,0 +1,814 @@
+/**
+ * @file coordinator.c
+ * @brief Bulk generation across worker processes coordinated over loopback TCP
+ * @details The coordinator runs one thread per connected worker. Each thread asks
+ *          the shared job for a range, sends it, and writes the returned records
+ *          at their offset in the output file with a positioned write, so ranges
+ *          can complete in any order. Lost ranges go back to the job and are
+ *          handed out before new ones.
+ */
+
+#include <winsock2.h>  /* before windows.h, which would otherwise pull in winsock.h */
+#include "../include/coordinator.h"
+#include "../include/batch_gen.h"
+#include "../include/console_io.h"
+#include "../include/denylist.h"
+#include "../include/password_gen.h"
+#include "../include/password_stream.h"
+#include "../include/utils.h"
+
+#define COORD_MAGIC         0x4B575057  /**< "WPWK" */
+#define COORD_VERSION       1           /**< Protocol version */
+#define COORD_CMDLINE_SIZE  32768       /**< Worker command line, in characters (CreateProcessW limit) */
+#define COORD_POLL_MS       100         /**< Accept loop wake-up interval */
+#define COORD_EXIT_WAIT_MS  5000        /**< Time workers get to exit before they are terminated */
+
+/** Worker result status */
+#define COORD_STATUS_OK      0  /**< count records follow */
+#define COORD_STATUS_FAILED  1  /**< Random source failed; another worker can take the range */
+#define COORD_STATUS_DENIED  2  /**< Deny-list exhaustion; no worker can complete the range */
+
+/** Outcome of one range on the coordinator side */
+#define RANGE_DONE   0  /**< Records written */
+#define RANGE_LOST   1  /**< Worker lost; the range goes back to the job */
+#define RANGE_ABORT  2  /**< Job cannot succeed (deny-list exhaustion or write failure) */
+
+/**
+ * @brief First message of a worker
+ */
+typedef struct {
+    DWORD magic;                    /**< COORD_MAGIC */
+    DWORD version;                  /**< COORD_VERSION */
+    DWORD processId;                /**< Worker process ID, matched against the started workers */
+    DWORD stride;                   /**< Record stride of the worker's configuration */
+    BYTE token[COORD_TOKEN_SIZE];   /**< Token read from standard input */
+} CoordHello;
+
+/**
+ * @brief Range assignment; count 0 ends the worker
+ */
+typedef struct {
+    DWORD first;  /**< First record index */
+    DWORD count;  /**< Number of records */
+} CoordRange;
+
+/**
+ * @brief Worker reply to a range, followed by the records on COORD_STATUS_OK
+ */
+typedef struct {
+    DWORD status;    /**< COORD_STATUS_* */
+    DWORD count;     /**< Records that follow */
+    DWORD maxDraws;  /**< Most random draws one of the passwords needed */
+    DWORD denied;    /**< Passwords regenerated because the deny-list matched */
+} CoordResult;
+
+/**
+ * @brief Shared state of one coordinated job
+ */
+typedef struct {
+    const PasswordConfig* config;   /**< Shared read-only configuration */
+    HANDLE hOut;                    /**< Output file */
+    int count;                      /**< Total records */
+    int stride;                     /**< Bytes per record */
+    int maxRange;                   /**< Largest range, from COORD_MAX_RANGE_BYTES */
+    int failWorker;                 /**< Connection to terminate on its second range, -1 for none */
+    CRITICAL_SECTION lock;          /**< Guards every field below */
+    HANDLE hChanged;                /**< Manual-reset: set when a range is returned or lost */
+    int next;                       /**< Next unassigned record */
+    int inFlight;                   /**< Ranges handed out and not yet returned */
+    int connected;                  /**< Connected workers */
+    CoordRange lost[COORD_MAX_WORKERS];  /**< Ranges of lost workers (at most one each) */
+    int lostCount;                  /**< Entries in lost */
+    int written;                    /**< Records written */
+    BOOL aborted;                   /**< Stop handing out ranges */
+    BOOL writeFailed;               /**< The output file could not be written */
+    CoordinatorStats* stats;        /**< Statistics being collected */
+} CoordJob;
+
+/**
+ * @brief Coordinator side of one worker connection
+ */
+typedef struct {
+    CoordJob* job;        /**< Shared job */
+    SOCKET sock;          /**< Connection to the worker */
+    HANDLE hProcess;      /**< Worker process */
+    int index;            /**< Connection order */
+    int produced;         /**< Records returned */
+    int ranges;           /**< Ranges returned */
+    LONGLONG rate;        /**< Measured records per second, 0 before the first range */
+    char* buffer;         /**< Receive buffer of maxRange records */
+} CoordConnection;
+
+/**
+ * @brief Sends a whole buffer
+ * @param sock Connected socket
+ * @param data Bytes to send
+ * @param length Number of bytes
+ * @return TRUE on success, FALSE if the connection failed
+ */
+static BOOL SendAll(SOCKET sock, const void* data, int length) {
+    const char* p = (const char*)data;
+    while (length > 0) {
+        int sent = send(sock, p, length, 0);
+        if (sent <= 0) return FALSE;
+        p += sent;
+        length -= sent;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Receives exactly length bytes
+ * @param sock Connected socket
+ * @param data Output buffer
+ * @param length Number of bytes
+ * @return TRUE on success, FALSE on disconnect, timeout or error
+ */
+static BOOL RecvAll(SOCKET sock, void* data, int length) {
+    char* p = (char*)data;
+    while (length > 0) {
+        int received = recv(sock, p, length, 0);
+        if (received <= 0) return FALSE;
+        p += received;
+        length -= received;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Appends one argument to a command line, quoted for CommandLineToArgvW()
+ * @param cmd Command line
+ * @param len Current length, updated
+ * @param arg Argument
+ * @return TRUE on success, FALSE if COORD_CMDLINE_SIZE would be exceeded
+ * @details Backslashes are doubled only where they precede a quote, which is
+ *          the only place the parser treats them specially.
+ */
+static BOOL AppendArgument(WCHAR* cmd, int* len, const WCHAR* arg) {
+    int n = *len;
+
+    if (n > 0) cmd[n++] = L' ';
+    cmd[n++] = L'"';
+    for (int i = 0; ; i++) {
+        int backslashes = 0;
+        while (arg[i] == L'\\') {
+            backslashes++;
+            i++;
+        }
+        int repeat = arg[i] == L'\0' ? 2 * backslashes : arg[i] == L'"' ? 2 * backslashes + 1 : backslashes;
+        if (n + repeat + 3 >= COORD_CMDLINE_SIZE) return FALSE;
+        while (repeat-- > 0) cmd[n++] = L'\\';
+        if (arg[i] == L'\0') break;
+        cmd[n++] = arg[i];
+    }
+    cmd[n++] = L'"';
+    cmd[n] = L'\0';
+    *len = n;
+    return TRUE;
+}
+
+/**
+ * @brief Builds the worker command line from the coordinator's arguments
+ * @param cmd Output buffer of COORD_CMDLINE_SIZE characters
+ * @param exePath Executable path
+ * @param args Coordinator arguments
+ * @param argCount Number of arguments
+ * @param port Coordinator port
+ * @return TRUE on success, FALSE if the command line is too long
+ * @details Every argument is passed on except --workers and --output, so the
+ *          workers parse the same policy, profiles and deny-list.
+ */
+static BOOL BuildWorkerCommandLine(WCHAR* cmd, const WCHAR* exePath, LPWSTR* args, int argCount, int port) {
+    char portArg[32];
+    WCHAR widePortArg[32];
+    int len = 0;
+
+    if (!AppendArgument(cmd, &len, exePath)) return FALSE;
+    for (int i = 1; i < argCount; i++) {
+        if (WStrStartsWith(args[i], "--workers=") || WStrStartsWith(args[i], "--worker=") ||
+            WStrStartsWith(args[i], "--output=") || WStrStartsWith(args[i], "-o=")) continue;
+        if (!AppendArgument(cmd, &len, args[i])) return FALSE;
+    }
+
+    wsprintfA(portArg, "--worker=%d", port);
+    int j = 0;
+    for (; portArg[j] != '\0'; j++) widePortArg[j] = (WCHAR)portArg[j];
+    widePortArg[j] = L'\0';
+    return AppendArgument(cmd, &len, widePortArg);
+}
+
+/**
+ * @brief Starts one worker process and passes it the token
+ * @param exePath Executable path
+ * @param cmd Command line (may be modified by CreateProcessW)
+ * @param token Connection token
+ * @param processId Output: worker process ID
+ * @return Process handle, NULL on failure
+ * @details The token goes through an inherited pipe on standard input rather
+ *          than the command line, which other local users can read.
+ */
+static HANDLE StartWorker(const WCHAR* exePath, WCHAR* cmd, const BYTE* token, DWORD* processId) {
+    SECURITY_ATTRIBUTES sa;
+    STARTUPINFOW si;
+    PROCESS_INFORMATION pi;
+    HANDLE hRead, hWrite;
+    DWORD written = 0;
+
+    sa.nLength = sizeof(sa);
+    sa.lpSecurityDescriptor = NULL;
+    sa.bInheritHandle = TRUE;
+    if (!CreatePipe(&hRead, &hWrite, &sa, 0)) return NULL;
+    SetHandleInformation(hWrite, HANDLE_FLAG_INHERIT, 0);
+
+    ZeroMemory(&si, sizeof(si));
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = hRead;
+    si.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    si.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    BOOL created = CreateProcessW(exePath, cmd, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi);
+    CloseHandle(hRead);
+    if (created) {
+        WriteFile(hWrite, token, COORD_TOKEN_SIZE, &written, NULL);
+        CloseHandle(pi.hThread);
+        *processId = pi.dwProcessId;
+    }
+    CloseHandle(hWrite);
+    return created ? pi.hProcess : NULL;
+}
+
+/**
+ * @brief Writes records at their offset in the output file
+ * @param job Coordinated job
+ * @param first First record index
+ * @param data Records
+ * @param count Number of records
+ * @return TRUE on success, FALSE on write failure
+ */
+static BOOL WriteRecords(CoordJob* job, int first, const char* data, int count) {
+    OVERLAPPED position;
+    ULONGLONG offset = (ULONGLONG)first * (ULONGLONG)job->stride;
+    DWORD size = (DWORD)count * (DWORD)job->stride;
+    DWORD written = 0;
+
+    ZeroMemory(&position, sizeof(position));
+    position.Offset = (DWORD)offset;
+    position.OffsetHigh = (DWORD)(offset >> 32);
+    return WriteFile(job->hOut, data, size, &written, &position) && written == size;
+}
+
+/**
+ * @brief Takes the next range for a worker
+ * @param conn Worker connection
+ * @param range Output range
+ * @param reassigned Output: TRUE if the range was lost by another worker
+ * @return TRUE if a range was taken, FALSE when no work is left
+ * @details Lost ranges come first. New ranges take COORD_RANGE_MS at the
+ *          worker's measured rate, capped at half of the remaining work per
+ *          worker. With everything handed out, the worker waits while other
+ *          ranges are in flight, since one of them may still be lost.
+ */
+static BOOL TakeRange(CoordConnection* conn, CoordRange* range, BOOL* reassigned) {
+    CoordJob* job = conn->job;
+    BOOL taken = FALSE;
+
+    EnterCriticalSection(&job->lock);
+    while (!job->aborted) {
+        if (job->lostCount > 0) {
+            *range = job->lost[--job->lostCount];
+            *reassigned = TRUE;
+            taken = TRUE;
+            break;
+        }
+        if (job->next < job->count) {
+            int remaining = job->count - job->next;
+            LONGLONG size = conn->rate > 0 ? conn->rate * COORD_RANGE_MS / 1000 : COORD_MIN_RANGE;
+            LONGLONG tail = remaining / (2 * job->connected);
+            if (size > tail) size = tail;
+            if (size < COORD_MIN_RANGE) size = COORD_MIN_RANGE;
+            if (size > job->maxRange) size = job->maxRange;
+            if (size > remaining) size = remaining;
+
+            range->first = (DWORD)job->next;
+            range->count = (DWORD)size;
+            job->next += (int)size;
+            *reassigned = FALSE;
+            taken = TRUE;
+            break;
+        }
+        if (job->inFlight == 0) break;
+
+        ResetEvent(job->hChanged);
+        LeaveCriticalSection(&job->lock);
+        WaitForSingleObject(job->hChanged, INFINITE);
+        EnterCriticalSection(&job->lock);
+    }
+    if (taken) job->inFlight++;
+    LeaveCriticalSection(&job->lock);
+    return taken;
+}
+
+/**
+ * @brief Records the outcome of a range and wakes waiting workers
+ * @param job Coordinated job
+ * @param range Range
+ * @param reassigned TRUE if the range had been lost before
+ * @param outcome RANGE_DONE, RANGE_LOST or RANGE_ABORT
+ * @param result Worker result, or NULL if none arrived
+ */
+static void ReturnRange(CoordJob* job, const CoordRange* range, BOOL reassigned, int outcome, const CoordResult* result) {
+    CoordinatorStats* stats = job->stats;
+
+    EnterCriticalSection(&job->lock);
+    job->inFlight--;
+    if (outcome == RANGE_DONE) {
+        job->written += (int)range->count;
+        stats->ranges++;
+        if (reassigned) stats->reassigned += (int)range->count;
+    } else if (outcome == RANGE_LOST) {
+        job->lost[job->lostCount++] = *range;
+        stats->failedWorkers++;
+    } else {
+        job->aborted = TRUE;
+    }
+    if (result) {
+        if ((int)result->maxDraws > stats->maxDraws) stats->maxDraws = (int)result->maxDraws;
+        stats->denied += (int)result->denied;
+        if (result->status == COORD_STATUS_DENIED) stats->denyExhausted = TRUE;
+    }
+    SetEvent(job->hChanged);
+    LeaveCriticalSection(&job->lock);
+}
+
+/**
+ * @brief Thread procedure: feeds one worker ranges until the job is done
+ * @param param Pointer to the CoordConnection
+ * @return 0 if the worker was released normally, 1 if it was lost
+ */
+static DWORD WINAPI CoordConnectionProc(LPVOID param) {
+    CoordConnection* conn = (CoordConnection*)param;
+    CoordJob* job = conn->job;
+    CoordRange range;
+    CoordResult result;
+    LARGE_INTEGER freq, start, end;
+    BOOL reassigned;
+
+    QueryPerformanceFrequency(&freq);
+    while (TakeRange(conn, &range, &reassigned)) {
+        int outcome = RANGE_LOST;
+        BOOL replied = FALSE;
+
+        QueryPerformanceCounter(&start);
+        if (SendAll(conn->sock, &range, sizeof(range))) {
+            /* Fault injection: the worker dies holding a range */
+            if (conn->index == job->failWorker && conn->ranges == 1) TerminateProcess(conn->hProcess, 1);
+
+            replied = RecvAll(conn->sock, &result, sizeof(result));
+            if (replied && result.status == COORD_STATUS_DENIED) {
+                outcome = RANGE_ABORT;
+            } else if (replied && result.status == COORD_STATUS_OK && result.count == range.count &&
+                       RecvAll(conn->sock, conn->buffer, (int)range.count * job->stride)) {
+                if (WriteRecords(job, (int)range.first, conn->buffer, (int)range.count)) {
+                    outcome = RANGE_DONE;
+                } else {
+                    job->writeFailed = TRUE;
+                    outcome = RANGE_ABORT;
+                }
+            }
+        }
+        QueryPerformanceCounter(&end);
+        SecureZeroMemory(conn->buffer, (SIZE_T)range.count * job->stride);
+
+        if (outcome == RANGE_DONE) {
+            /* Round-trip rate, transfer included, smoothed over the last ranges */
+            LONGLONG ticks = end.QuadPart - start.QuadPart;
+            LONGLONG rate = (LONGLONG)range.count * freq.QuadPart / (ticks > 0 ? ticks : 1);
+            conn->rate = conn->rate > 0 ? (conn->rate + rate) / 2 : rate;
+            conn->produced += (int)range.count;
+            conn->ranges++;
+        }
+        ReturnRange(job, &range, reassigned, outcome, replied ? &result : NULL);
+
+        if (outcome == RANGE_LOST) {
+            /* A hung worker would otherwise keep running after the job */
+            TerminateProcess(conn->hProcess, 1);
+            return 1;
+        }
+        if (outcome == RANGE_ABORT) break;
+    }
+
+    range.first = 0;
+    range.count = 0;
+    SendAll(conn->sock, &range, sizeof(range));
+    return 0;
+}
+
+/**
+ * @brief Checks whether the job needs no more workers
+ * @param job Coordinated job
+ * @return TRUE if aborted or every record is written
+ */
+static BOOL JobFinished(CoordJob* job) {
+    EnterCriticalSection(&job->lock);
+    BOOL finished = job->aborted || job->written == job->count;
+    LeaveCriticalSection(&job->lock);
+    return finished;
+}
+
+/**
+ * @brief Accepts one worker and checks its hello
+ * @param listenSock Listening socket
+ * @param token Expected token
+ * @param stride Expected record stride
+ * @param processIds IDs of the started workers
+ * @param started Number of started workers
+ * @param sock Output: the accepted socket, closed again if the hello does not match
+ * @return Index of the matching worker, -1 to ignore the connection
+ */
+static int AcceptWorker(SOCKET listenSock, const BYTE* token, int stride, const DWORD* processIds, int started, SOCKET* sock) {
+    CoordHello hello;
+    DWORD timeout = COORD_RESULT_TIMEOUT_MS;
+    BOOL noDelay = TRUE;
+    BYTE difference = 0;
+
+    *sock = accept(listenSock, NULL, NULL);
+    if (*sock == INVALID_SOCKET) return -1;
+    setsockopt(*sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(*sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    if (RecvAll(*sock, &hello, sizeof(hello)) && hello.magic == COORD_MAGIC &&
+        hello.version == COORD_VERSION && hello.stride == (DWORD)stride) {
+        for (int i = 0; i < COORD_TOKEN_SIZE; i++) difference |= (BYTE)(hello.token[i] ^ token[i]);
+        for (int w = 0; difference == 0 && w < started; w++) {
+            if (processIds[w] == hello.processId) return w;
+        }
+    }
+    closesocket(*sock);
+    return -1;
+}
+
+/**
+ * @brief Generates the ranges left when every worker is lost
+ * @param job Coordinated job
+ * @return TRUE on success, FALSE on failure
+ */
+static BOOL FinishLocally(CoordJob* job) {
+    CoordinatorStats* stats = job->stats;
+    char* buffer = (char*)HeapAlloc(GetProcessHeap(), 0, (SIZE_T)job->maxRange * job->stride);
+    BOOL success = buffer != NULL;
+
+    while (success && (job->lostCount > 0 || job->next < job->count)) {
+        CoordRange range;
+        BatchStats batchStats;
+
+        if (job->lostCount > 0) {
+            range = job->lost[--job->lostCount];
+        } else {
+            range.first = (DWORD)job->next;
+            range.count = (DWORD)(job->count - job->next < job->maxRange ? job->count - job->next : job->maxRange);
+            job->next += (int)range.count;
+        }
+
+        success = GenerateBatch(job->config, (int)range.count, buffer, &batchStats);
+        if (batchStats.maxDraws > stats->maxDraws) stats->maxDraws = batchStats.maxDraws;
+        stats->denied += batchStats.denied;
+        if (!success) {
+            stats->denyExhausted = batchStats.denyExhausted;
+            if (!batchStats.denyExhausted) PrintError("GenRandom Failed");
+        } else if (!WriteRecords(job, (int)range.first, buffer, (int)range.count)) {
+            job->writeFailed = TRUE;
+            success = FALSE;
+        } else {
+            job->written += (int)range.count;
+            stats->local += (int)range.count;
+        }
+        SecureZeroMemory(buffer, (SIZE_T)range.count * job->stride);
+    }
+
+    if (buffer) HeapFree(GetProcessHeap(), 0, buffer);
+    return success;
+}
+
+/**
+ * @brief Generates config->count passwords into config->outputPath with worker processes
+ * @param config Password configuration
+ * @param args Coordinator arguments
+ * @param argCount Number of arguments
+ * @param failWorker Connection to terminate on its second range, -1 for none
+ * @param stats Output statistics
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL RunCoordinator(const PasswordConfig* config, LPWSTR* args, int argCount, int failWorker, CoordinatorStats* stats) {
+    HANDLE hHeap = GetProcessHeap();
+    HANDLE hProcesses[COORD_MAX_WORKERS];
+    HANDLE hThreads[COORD_MAX_WORKERS];
+    DWORD processIds[COORD_MAX_WORKERS];
+    CoordConnection conns[COORD_MAX_WORKERS];
+    BYTE token[COORD_TOKEN_SIZE];
+    WCHAR exePath[MAX_PATH];
+    HCRYPTPROV hCryptProv = 0;
+    CoordJob job;
+    WSADATA wsaData;
+    struct sockaddr_in addr;
+    int addrLen = sizeof(addr);
+    int started = 0;
+    int accepted = 0;
+    BOOL success = FALSE;
+
+    ZeroMemory(stats, sizeof(*stats));
+    ZeroMemory(&job, sizeof(job));
+    job.config = config;
+    job.count = config->count;
+    job.stride = BatchRecordStride(config);
+    job.maxRange = COORD_MAX_RANGE_BYTES / job.stride;
+    job.failWorker = failWorker;
+    job.stats = stats;
+
+    if (!CryptAcquireContext(&hCryptProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+        PrintError("Crypto Context Failed");
+        return FALSE;
+    }
+    BOOL haveToken = CryptGenRandom(hCryptProv, COORD_TOKEN_SIZE, token);
+    CryptReleaseContext(hCryptProv, 0);
+    if (!haveToken) {
+        PrintError("GenRandom Failed");
+        return FALSE;
+    }
+
+    WCHAR* cmd = (WCHAR*)HeapAlloc(hHeap, 0, COORD_CMDLINE_SIZE * sizeof(WCHAR));
+    if (!cmd) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        PrintError("Winsock startup failed");
+        HeapFree(hHeap, 0, cmd);
+        return FALSE;
+    }
+
+    /* Loopback only, on a port chosen by the system */
+    SOCKET listenSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    ZeroMemory(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (listenSock == INVALID_SOCKET || bind(listenSock, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listenSock, COORD_MAX_WORKERS) != 0 || getsockname(listenSock, (struct sockaddr*)&addr, &addrLen) != 0) {
+        PrintError("Cannot listen on the loopback interface");
+        if (listenSock != INVALID_SOCKET) closesocket(listenSock);
+        WSACleanup();
+        HeapFree(hHeap, 0, cmd);
+        return FALSE;
+    }
+
+    job.hOut = CreateFileW(config->outputPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (job.hOut == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot create output file");
+        closesocket(listenSock);
+        WSACleanup();
+        HeapFree(hHeap, 0, cmd);
+        return FALSE;
+    }
+    InitializeCriticalSection(&job.lock);
+    job.hChanged = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    LARGE_INTEGER freq, startTime, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&startTime);
+
+    DWORD exeLen = GetModuleFileNameW(NULL, exePath, MAX_PATH);
+    if (job.hChanged && exeLen > 0 && exeLen < MAX_PATH &&
+        BuildWorkerCommandLine(cmd, exePath, args, argCount, ntohs(addr.sin_port))) {
+        for (int w = 0; w < config->workers; w++) {
+            /* CreateProcessW may write to the command line, so each worker gets a fresh copy */
+            BuildWorkerCommandLine(cmd, exePath, args, argCount, ntohs(addr.sin_port));
+            hProcesses[started] = StartWorker(exePath, cmd, token, &processIds[started]);
+            if (hProcesses[started]) started++;
+        }
+    }
+    stats->started = started;
+    if (started == 0) PrintError("Cannot start worker processes");
+
+    /* Accept workers while they are alive and there is work for them */
+    while (accepted < started && !JobFinished(&job)) {
+        fd_set readable;
+        struct timeval tv;
+        SOCKET sock;
+
+        FD_ZERO(&readable);
+        FD_SET(listenSock, &readable);
+        tv.tv_sec = 0;
+        tv.tv_usec = COORD_POLL_MS * 1000;
+        int ready = select(0, &readable, NULL, NULL, &tv);
+        if (ready == SOCKET_ERROR) break;
+        if (ready == 0) {
+            QueryPerformanceCounter(&now);
+            if (WaitForMultipleObjects((DWORD)started, hProcesses, TRUE, 0) == WAIT_OBJECT_0) break;
+            if ((now.QuadPart - startTime.QuadPart) * 1000 / freq.QuadPart > COORD_CONNECT_TIMEOUT_MS) break;
+            continue;
+        }
+
+        int w = AcceptWorker(listenSock, token, job.stride, processIds, started, &sock);
+        if (w < 0) continue;
+        processIds[w] = 0;
+
+        CoordConnection* conn = &conns[accepted];
+        conn->job = &job;
+        conn->sock = sock;
+        conn->hProcess = hProcesses[w];
+        conn->index = accepted;
+        conn->produced = 0;
+        conn->ranges = 0;
+        conn->rate = 0;
+        conn->buffer = (char*)HeapAlloc(hHeap, 0, (SIZE_T)job.maxRange * job.stride);
+
+        EnterCriticalSection(&job.lock);
+        job.connected++;
+        LeaveCriticalSection(&job.lock);
+        hThreads[accepted] = conn->buffer ? CreateThread(NULL, 0, CoordConnectionProc, conn, 0, NULL) : NULL;
+        if (!hThreads[accepted]) {
+            EnterCriticalSection(&job.lock);
+            job.connected--;
+            LeaveCriticalSection(&job.lock);
+            if (conn->buffer) HeapFree(hHeap, 0, conn->buffer);
+            closesocket(sock);
+            TerminateProcess(hProcesses[w], 1);
+            continue;
+        }
+        accepted++;
+    }
+    closesocket(listenSock);
+
+    if (accepted > 0) {
+        WaitForMultipleObjects((DWORD)accepted, hThreads, TRUE, INFINITE);
+        for (int c = 0; c < accepted; c++) CloseHandle(hThreads[c]);
+    }
+    stats->connected = accepted;
+
+    /* Every worker lost, or none connected: the coordinator finishes the job */
+    if (!job.aborted && job.written < job.count) FinishLocally(&job);
+    success = !job.aborted && job.written == job.count;
+    if (job.writeFailed) PrintError("Write Failed");
+
+    QueryPerformanceCounter(&now);
+    stats->elapsedMs = (DWORD)((now.QuadPart - startTime.QuadPart) * 1000 / freq.QuadPart);
+
+    stats->minPerWorker = accepted > 0 ? job.count : 0;
+    for (int c = 0; c < accepted; c++) {
+        if (conns[c].produced < stats->minPerWorker) stats->minPerWorker = conns[c].produced;
+        if (conns[c].produced > stats->maxPerWorker) stats->maxPerWorker = conns[c].produced;
+        closesocket(conns[c].sock);
+        HeapFree(hHeap, 0, conns[c].buffer);
+    }
+
+    /* Released workers exit on their own; anything left is stopped */
+    if (started > 0 && WaitForMultipleObjects((DWORD)started, hProcesses, TRUE, COORD_EXIT_WAIT_MS) != WAIT_OBJECT_0) {
+        for (int w = 0; w < started; w++) TerminateProcess(hProcesses[w], 1);
+    }
+    for (int w = 0; w < started; w++) CloseHandle(hProcesses[w]);
+
+    CloseHandle(job.hOut);
+    /* Never leave a partial password file behind */
+    if (!success) DeleteFileW(config->outputPath);
+
+    CloseHandle(job.hChanged);
+    DeleteCriticalSection(&job.lock);
+    WSACleanup();
+    HeapFree(hHeap, 0, cmd);
+    return success;
+}
+
+/**
+ * @brief Runs --count bulk generation with --workers and prints the summary
+ * @param config Password configuration
+ * @param args Argument array
+ * @param argCount Number of arguments
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GenerateDistributed(const PasswordConfig* config, LPWSTR* args, int argCount) {
+    CoordinatorStats stats;
+    char msgBuf[256];
+
+    if (!ValidateBulkConfig(config)) return FALSE;
+
+    BOOL success = RunCoordinator(config, args, argCount, -1, &stats);
+    if (stats.denyExhausted) {
+        wsprintfA(msgBuf, "[ERROR] The deny-list rejected %d passwords in a row; this policy is too weak for it.\r\n",
+                  DENY_MAX_RETRIES);
+        ConsoleWrite(msgBuf);
+    }
+    if (!success) return FALSE;
+
+    wsprintfA(msgBuf, "[INFO] Wrote %d passwords (%d chars each) with %d of %d workers; %d ranges, %d-%d per worker, %d workers lost, %d reassigned, %d generated locally.\r\n",
+              config->count, BatchRecordStride(config) - 2, stats.connected, stats.started, stats.ranges,
+              stats.minPerWorker, stats.maxPerWorker, stats.failedWorkers, stats.reassigned, stats.local);
+    ConsoleWrite(msgBuf);
+    DWORD elapsedMs = stats.elapsedMs > 0 ? stats.elapsedMs : 1;
+    wsprintfA(msgBuf, "[INFO] Generated in %lu ms (%lu passwords/s), worker start-up included.\r\n",
+              stats.elapsedMs, (DWORD)((ULONGLONG)config->count * 1000 / elapsedMs));
+    ConsoleWrite(msgBuf);
+    if (config->bounded) {
+        wsprintfA(msgBuf, "[INFO] Random draws per password: max %d (bounded at %d).\r\n",
+                  stats.maxDraws, STREAM_BOUNDED_DRAWS(BatchRecordStride(config) - 2, config->plan != NULL));
+    } else {
+        wsprintfA(msgBuf, "[INFO] Random draws per password: max %d (rejection sampling, no fixed bound).\r\n",
+                  stats.maxDraws);
+    }
+    ConsoleWrite(msgBuf);
+    if (config->denyList) {
+        char entries[24];
+        FormatULongLong(entries, config->denyList->header->count);
+        wsprintfA(msgBuf, "[INFO] Deny-list: %s entries, %d passwords regenerated.\r\n", entries, stats.denied);
+        ConsoleWrite(msgBuf);
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Serves ranges for a coordinator until told to stop
+ * @param config Password configuration
+ * @return 0 when the coordinator ended the job, 1 on failure
+ */
+int RunWorker(const PasswordConfig* config) {
+    HANDLE hHeap = GetProcessHeap();
+    HANDLE hIn = GetStdHandle(STD_INPUT_HANDLE);
+    CoordHello hello;
+    CoordRange range;
+    CoordResult result;
+    WSADATA wsaData;
+    struct sockaddr_in addr;
+    DWORD got = 0;
+    BOOL noDelay = TRUE;
+    int exitCode = 1;
+
+    /* The token arrives on standard input, written once by the coordinator */
+    while (got < COORD_TOKEN_SIZE) {
+        DWORD n = 0;
+        if (!ReadFile(hIn, hello.token + got, COORD_TOKEN_SIZE - got, &n, NULL) || n == 0) {
+            PrintError("Cannot read the coordinator token");
+            return 1;
+        }
+        got += n;
+    }
+
+    int stride = BatchRecordStride(config);
+    int maxRange = COORD_MAX_RANGE_BYTES / stride;
+    char* buffer = (char*)HeapAlloc(hHeap, 0, (SIZE_T)maxRange * stride);
+    if (!buffer) {
+        PrintError("Memory Error");
+        return 1;
+    }
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        PrintError("Winsock startup failed");
+        HeapFree(hHeap, 0, buffer);
+        return 1;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    ZeroMemory(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)config->workerPort);
+    if (sock == INVALID_SOCKET || connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        PrintError("Cannot connect to the coordinator");
+        if (sock != INVALID_SOCKET) closesocket(sock);
+        WSACleanup();
+        HeapFree(hHeap, 0, buffer);
+        return 1;
+    }
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    hello.magic = COORD_MAGIC;
+    hello.version = COORD_VERSION;
+    hello.processId = GetCurrentProcessId();
+    hello.stride = (DWORD)stride;
+    if (SendAll(sock, &hello, sizeof(hello))) {
+        while (RecvAll(sock, &range, sizeof(range))) {
+            BatchStats stats;
+
+            if (range.count == 0) {
+                exitCode = 0;
+                break;
+            }
+            if (range.count > (DWORD)maxRange) break;
+
+            /* One thread per worker: the process count sets the parallelism */
+            BOOL ok = GenerateBatchThreads(config, (int)range.count, buffer, 1, &stats);
+            result.status = ok ? COORD_STATUS_OK : stats.denyExhausted ? COORD_STATUS_DENIED : COORD_STATUS_FAILED;
+            result.count = ok ? range.count : 0;
+            result.maxDraws = (DWORD)stats.maxDraws;
+            result.denied = (DWORD)stats.denied;
+            BOOL sent = SendAll(sock, &result, sizeof(result)) &&
+                        (!ok || SendAll(sock, buffer, (int)range.count * stride));
+            SecureZeroMemory(buffer, (SIZE_T)range.count * stride);
+            if (!ok || !sent) break;
+        }
+    }
+
+    closesocket(sock);
+    WSACleanup();
+    SecureZeroMemory(hello.token, COORD_TOKEN_SIZE);
+    HeapFree(hHeap, 0, buffer);
+    return exitCode;
+}
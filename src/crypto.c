@@ -0,0 +1,691 @@
+/**
+ * @file crypto.c
+ * @brief X25519 and ChaCha20-Poly1305 implementation
+ * @details Field elements mod 2^255 - 19 are ten signed limbs of alternately 26
+ *          and 25 bits (limb i has weight 2^ceil(25.5 * i)). Additions and
+ *          subtractions are not carried; every multiplication carries its result,
+ *          so a multiplication operand is never more than one addition away from
+ *          a carried value and all 64-bit accumulators stay below 2^61.
+ */
+
+#include "../include/crypto.h"
+
+#define LOAD32_LE(p)  ((DWORD)(p)[0] | ((DWORD)(p)[1] << 8) | ((DWORD)(p)[2] << 16) | ((DWORD)(p)[3] << 24))
+#define ROTL32(v, n)  (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define FIELD_LIMBS   10
+#define LIMB_BITS(i)  (((i) & 1) ? 25 : 26)
+#define A24           121665   /**< (486662 - 2) / 4, RFC 7748 */
+
+typedef INT32 FieldElement[FIELD_LIMBS];
+
+const BYTE X25519_BASE_POINT[X25519_KEY_SIZE] = { 9 };
+
+/**
+ * @brief Poly1305 state with 26-bit limbs
+ */
+typedef struct {
+    DWORD r[5];     /**< Clamped key r */
+    DWORD h[5];     /**< Accumulator */
+    DWORD pad[4];   /**< Key s, added at the end */
+} Poly1305;
+
+/**
+ * @brief Stores a 32-bit value little-endian
+ * @param p Destination
+ * @param v Value
+ */
+static void Store32(BYTE* p, DWORD v) {
+    p[0] = (BYTE)v;
+    p[1] = (BYTE)(v >> 8);
+    p[2] = (BYTE)(v >> 16);
+    p[3] = (BYTE)(v >> 24);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Field arithmetic mod 2^255 - 19                                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Moves the rounded overflow of limb i into the next limb
+ * @param t 64-bit limb accumulators
+ * @param i Limb to carry; limb 9 wraps into limb 0 with factor 19
+ */
+static void CarryLimb(INT64* t, int i) {
+    int bits = LIMB_BITS(i);
+    INT64 carry = (t[i] + ((INT64)1 << (bits - 1))) >> bits;
+    t[i] -= carry * ((INT64)1 << bits);
+    if (i < FIELD_LIMBS - 1) t[i + 1] += carry;
+    else t[0] += carry * 19;
+}
+
+/**
+ * @brief Carries 64-bit limb accumulators into a field element
+ * @param h Output
+ * @param t Accumulators (destroyed)
+ * @details Two interleaved carry chains (0..4 and 4..9) halve the dependency
+ *          length. Rounding carries leave every limb within about half its
+ *          range, signed.
+ */
+static void FeCarry(FieldElement h, INT64* t) {
+    CarryLimb(t, 0); CarryLimb(t, 4);
+    CarryLimb(t, 1); CarryLimb(t, 5);
+    CarryLimb(t, 2); CarryLimb(t, 6);
+    CarryLimb(t, 3); CarryLimb(t, 7);
+    CarryLimb(t, 4); CarryLimb(t, 8);
+    CarryLimb(t, 9);
+    CarryLimb(t, 0);
+    for (int i = 0; i < FIELD_LIMBS; i++) h[i] = (INT32)t[i];
+}
+
+static void FeCopy(FieldElement h, const FieldElement f) {
+    for (int i = 0; i < FIELD_LIMBS; i++) h[i] = f[i];
+}
+
+static void FeSetSmall(FieldElement h, INT32 v) {
+    h[0] = v;
+    for (int i = 1; i < FIELD_LIMBS; i++) h[i] = 0;
+}
+
+static void FeAdd(FieldElement h, const FieldElement f, const FieldElement g) {
+    for (int i = 0; i < FIELD_LIMBS; i++) h[i] = f[i] + g[i];
+}
+
+static void FeSub(FieldElement h, const FieldElement f, const FieldElement g) {
+    for (int i = 0; i < FIELD_LIMBS; i++) h[i] = f[i] - g[i];
+}
+
+/**
+ * @brief h = f * g
+ * @details Two odd limbs multiply to twice the weight of their target limb, so
+ *          odd limbs of g are doubled for odd i. Limbs past 2^255 wrap with
+ *          factor 19.
+ */
+static void FeMul(FieldElement h, const FieldElement f, const FieldElement g) {
+    INT64 t[2 * FIELD_LIMBS - 1];
+    INT32 g2[FIELD_LIMBS];
+
+    for (int j = 0; j < FIELD_LIMBS; j++) g2[j] = (j & 1) ? 2 * g[j] : g[j];
+    for (int k = 0; k < 2 * FIELD_LIMBS - 1; k++) t[k] = 0;
+    for (int i = 0; i < FIELD_LIMBS; i++) {
+        const INT32* gi = (i & 1) ? g2 : g;
+        INT64 fi = f[i];
+        for (int j = 0; j < FIELD_LIMBS; j++) t[i + j] += fi * gi[j];
+    }
+    for (int k = 0; k < FIELD_LIMBS - 1; k++) t[k] += 19 * t[k + FIELD_LIMBS];
+    FeCarry(h, t);
+}
+
+/**
+ * @brief h = f^2, using the symmetry of the cross products
+ */
+static void FeSq(FieldElement h, const FieldElement f) {
+    INT64 t[2 * FIELD_LIMBS - 1];
+    INT32 f2[FIELD_LIMBS];
+
+    for (int j = 0; j < FIELD_LIMBS; j++) f2[j] = (j & 1) ? 2 * f[j] : f[j];
+    for (int k = 0; k < 2 * FIELD_LIMBS - 1; k++) t[k] = 0;
+    for (int i = 0; i < FIELD_LIMBS; i++) {
+        const INT32* fj = (i & 1) ? f2 : f;
+        INT64 fi = f[i];
+        t[2 * i] += fi * fj[i];
+        for (int j = i + 1; j < FIELD_LIMBS; j++) t[i + j] += 2 * fi * fj[j];
+    }
+    for (int k = 0; k < FIELD_LIMBS - 1; k++) t[k] += 19 * t[k + FIELD_LIMBS];
+    FeCarry(h, t);
+}
+
+/**
+ * @brief h = f squared n times
+ */
+static void FeSqN(FieldElement h, const FieldElement f, int n) {
+    FeSq(h, f);
+    for (int i = 1; i < n; i++) FeSq(h, h);
+}
+
+static void FeMulSmall(FieldElement h, const FieldElement f, INT32 n) {
+    INT64 t[FIELD_LIMBS];
+    for (int i = 0; i < FIELD_LIMBS; i++) t[i] = (INT64)f[i] * n;
+    FeCarry(h, t);
+}
+
+/**
+ * @brief Swaps f and g if b is 1, in constant time
+ */
+static void FeSwap(FieldElement f, FieldElement g, DWORD b) {
+    INT32 mask = -(INT32)b;
+    for (int i = 0; i < FIELD_LIMBS; i++) {
+        INT32 x = mask & (f[i] ^ g[i]);
+        f[i] ^= x;
+        g[i] ^= x;
+    }
+}
+
+/**
+ * @brief h = z^(p - 2) = 1 / z
+ * @details Fixed addition chain: 254 squarings and 11 multiplications.
+ */
+static void FeInvert(FieldElement out, const FieldElement z) {
+    FieldElement z2, z9, z11, z5_0, z10_0, z20_0, z50_0, z100_0, t;
+
+    FeSq(z2, z);
+    FeSqN(t, z2, 2);
+    FeMul(z9, t, z);
+    FeMul(z11, z9, z2);
+    FeSq(t, z11);
+    FeMul(z5_0, t, z9);
+    FeSqN(t, z5_0, 5);
+    FeMul(z10_0, t, z5_0);
+    FeSqN(t, z10_0, 10);
+    FeMul(z20_0, t, z10_0);
+    FeSqN(t, z20_0, 20);
+    FeMul(t, t, z20_0);
+    FeSqN(t, t, 10);
+    FeMul(z50_0, t, z10_0);
+    FeSqN(t, z50_0, 50);
+    FeMul(z100_0, t, z50_0);
+    FeSqN(t, z100_0, 100);
+    FeMul(t, t, z100_0);
+    FeSqN(t, t, 50);
+    FeMul(t, t, z50_0);
+    FeSqN(t, t, 5);
+    FeMul(out, t, z11);
+
+    /* The powers reveal the input, which is secret in the batch */
+    SecureZeroMemory(z2, sizeof(z2));
+    SecureZeroMemory(z9, sizeof(z9));
+    SecureZeroMemory(z11, sizeof(z11));
+    SecureZeroMemory(z5_0, sizeof(z5_0));
+    SecureZeroMemory(z10_0, sizeof(z10_0));
+    SecureZeroMemory(z20_0, sizeof(z20_0));
+    SecureZeroMemory(z50_0, sizeof(z50_0));
+    SecureZeroMemory(z100_0, sizeof(z100_0));
+    SecureZeroMemory(t, sizeof(t));
+}
+
+/**
+ * @brief Loads a little-endian u-coordinate, ignoring the top bit
+ */
+static void FeFromBytes(FieldElement h, const BYTE* s) {
+    ULONGLONG acc = 0;
+    int accBits = 0;
+    int pos = 0;
+
+    for (int i = 0; i < FIELD_LIMBS; i++) {
+        int bits = LIMB_BITS(i);
+        while (accBits < bits && pos < X25519_KEY_SIZE) {
+            BYTE b = pos == X25519_KEY_SIZE - 1 ? (BYTE)(s[pos] & 0x7F) : s[pos];
+            acc |= (ULONGLONG)b << accBits;
+            accBits += 8;
+            pos++;
+        }
+        h[i] = (INT32)(acc & (((ULONGLONG)1 << bits) - 1));
+        acc >>= bits;
+        accBits -= bits;
+    }
+}
+
+/**
+ * @brief Stores the fully reduced value of a carried element
+ * @details q is 1 exactly when h >= p; adding 19q and dropping bit 255
+ *          subtracts p in that case.
+ */
+static void FeToBytes(BYTE* s, const FieldElement f) {
+    FieldElement h;
+    FeCopy(h, f);
+
+    INT32 q = (19 * h[9] + ((INT32)1 << 24)) >> 25;
+    for (int i = 0; i < FIELD_LIMBS; i++) q = (h[i] + q) >> LIMB_BITS(i);
+    h[0] += 19 * q;
+    for (int i = 0; i < FIELD_LIMBS - 1; i++) {
+        INT32 carry = h[i] >> LIMB_BITS(i);
+        h[i + 1] += carry;
+        h[i] -= carry * ((INT32)1 << LIMB_BITS(i));
+    }
+    h[9] &= (1 << 25) - 1;
+
+    ULONGLONG acc = 0;
+    int accBits = 0;
+    int pos = 0;
+    for (int i = 0; i < FIELD_LIMBS; i++) {
+        acc |= (ULONGLONG)(DWORD)h[i] << accBits;
+        accBits += LIMB_BITS(i);
+        while (accBits >= 8) {
+            s[pos++] = (BYTE)acc;
+            acc >>= 8;
+            accBits -= 8;
+        }
+    }
+    s[pos] = (BYTE)acc;
+}
+
+/* ------------------------------------------------------------------------- */
+/* X25519                                                                     */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Montgomery ladder, result left in projective form
+ * @param x Output X
+ * @param z Output Z
+ * @param scalar 32-byte scalar (clamped here)
+ * @param point 32-byte u-coordinate
+ */
+static void Ladder(FieldElement x, FieldElement z, const BYTE* scalar, const BYTE* point) {
+    BYTE e[X25519_KEY_SIZE];
+    FieldElement x1, x2, z2, x3, z3, a, aa, b, bb, c, d, da, cb, t;
+    DWORD swap = 0;
+
+    for (int i = 0; i < X25519_KEY_SIZE; i++) e[i] = scalar[i];
+    e[0] &= 248;
+    e[31] &= 127;
+    e[31] |= 64;
+
+    FeFromBytes(x1, point);
+    FeSetSmall(x2, 1);
+    FeSetSmall(z2, 0);
+    FeCopy(x3, x1);
+    FeSetSmall(z3, 1);
+
+    for (int pos = 254; pos >= 0; pos--) {
+        DWORD bit = (e[pos >> 3] >> (pos & 7)) & 1;
+        swap ^= bit;
+        FeSwap(x2, x3, swap);
+        FeSwap(z2, z3, swap);
+        swap = bit;
+
+        FeAdd(a, x2, z2);
+        FeSq(aa, a);
+        FeSub(b, x2, z2);
+        FeSq(bb, b);
+        FeSub(t, aa, bb);            /* E */
+        FeAdd(c, x3, z3);
+        FeSub(d, x3, z3);
+        FeMul(da, d, a);
+        FeMul(cb, c, b);
+        FeAdd(x3, da, cb);
+        FeSq(x3, x3);
+        FeSub(z3, da, cb);
+        FeSq(z3, z3);
+        FeMul(z3, z3, x1);
+        FeMul(x2, aa, bb);
+        FeMulSmall(z2, t, A24);
+        FeAdd(z2, z2, aa);
+        FeMul(z2, z2, t);
+    }
+    FeSwap(x2, x3, swap);
+    FeSwap(z2, z3, swap);
+
+    FeCopy(x, x2);
+    FeCopy(z, z2);
+    SecureZeroMemory(e, sizeof(e));
+    SecureZeroMemory(x2, sizeof(x2));
+    SecureZeroMemory(z2, sizeof(z2));
+    SecureZeroMemory(x3, sizeof(x3));
+    SecureZeroMemory(z3, sizeof(z3));
+    SecureZeroMemory(a, sizeof(a));
+    SecureZeroMemory(aa, sizeof(aa));
+    SecureZeroMemory(b, sizeof(b));
+    SecureZeroMemory(bb, sizeof(bb));
+    SecureZeroMemory(c, sizeof(c));
+    SecureZeroMemory(d, sizeof(d));
+    SecureZeroMemory(da, sizeof(da));
+    SecureZeroMemory(cb, sizeof(cb));
+    SecureZeroMemory(t, sizeof(t));
+}
+
+/**
+ * @brief Computes up to X25519_MAX_BATCH X25519 functions with one field inversion
+ * @param jobs Jobs to run
+ * @param count Number of jobs (1 to X25519_MAX_BATCH)
+ */
+static void X25519Slice(const X25519Job* jobs, int count) {
+    FieldElement x[X25519_MAX_BATCH];
+    FieldElement z[X25519_MAX_BATCH];
+    FieldElement prefix[X25519_MAX_BATCH];
+    FieldElement inverse, zInverse, result;
+    BOOL lowOrder[X25519_MAX_BATCH];
+    BYTE check[X25519_KEY_SIZE];
+
+    for (int i = 0; i < count; i++) {
+        Ladder(x[i], z[i], jobs[i].scalar, jobs[i].point);
+
+        /* Z = 0 only for low-order points; keep it out of the shared product */
+        FeToBytes(check, z[i]);
+        BYTE any = 0;
+        for (int k = 0; k < X25519_KEY_SIZE; k++) any |= check[k];
+        lowOrder[i] = any == 0;
+        if (lowOrder[i]) FeSetSmall(z[i], 1);
+    }
+
+    /* Montgomery's trick: prefix[i] = z[0] * ... * z[i] */
+    FeCopy(prefix[0], z[0]);
+    for (int i = 1; i < count; i++) FeMul(prefix[i], prefix[i - 1], z[i]);
+    FeInvert(inverse, prefix[count - 1]);
+
+    for (int i = count - 1; i >= 0; i--) {
+        if (i > 0) {
+            FeMul(zInverse, inverse, prefix[i - 1]);
+            FeMul(inverse, inverse, z[i]);
+        } else {
+            FeCopy(zInverse, inverse);
+        }
+        FeMul(result, x[i], zInverse);
+        FeToBytes(jobs[i].out, result);
+        if (lowOrder[i]) {
+            for (int k = 0; k < X25519_KEY_SIZE; k++) jobs[i].out[k] = 0;
+        }
+    }
+
+    /* Every intermediate is derived from the secret scalars */
+    SecureZeroMemory(x, sizeof(x));
+    SecureZeroMemory(z, sizeof(z));
+    SecureZeroMemory(prefix, sizeof(prefix));
+    SecureZeroMemory(inverse, sizeof(inverse));
+    SecureZeroMemory(zInverse, sizeof(zInverse));
+    SecureZeroMemory(result, sizeof(result));
+    SecureZeroMemory(check, sizeof(check));
+}
+
+/**
+ * @brief Computes several X25519 functions with one field inversion per slice
+ * @param jobs Jobs to run
+ * @param count Number of jobs; nothing is done for count <= 0
+ */
+void X25519Batch(const X25519Job* jobs, int count) {
+    /* The per-job arrays are sized for one slice */
+    for (int first = 0; first < count; first += X25519_MAX_BATCH) {
+        X25519Slice(jobs + first, count - first < X25519_MAX_BATCH ? count - first : X25519_MAX_BATCH);
+    }
+}
+
+/**
+ * @brief Computes the X25519 function for one scalar and point
+ * @param out 32-byte result
+ * @param scalar 32-byte secret scalar
+ * @param point 32-byte u-coordinate
+ */
+void X25519(BYTE* out, const BYTE* scalar, const BYTE* point) {
+    X25519Job job;
+    job.scalar = scalar;
+    job.point = point;
+    job.out = out;
+    X25519Batch(&job, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+/* ChaCha20 and Poly1305                                                      */
+/* ------------------------------------------------------------------------- */
+
+#define QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8);  \
+    c += d; b ^= c; b = ROTL32(b, 7)
+
+/**
+ * @brief Sets up the ChaCha20 state
+ * @param state 16-word state
+ * @param key 32-byte key
+ * @param counter Block counter
+ * @param nonce 12-byte nonce, or NULL when words 12..15 are set by the caller
+ */
+static void ChaChaInit(DWORD* state, const BYTE* key, DWORD counter, const BYTE* nonce) {
+    state[0] = 0x61707865;
+    state[1] = 0x3320646E;
+    state[2] = 0x79622D32;
+    state[3] = 0x6B206574;
+    for (int i = 0; i < 8; i++) state[4 + i] = LOAD32_LE(key + 4 * i);
+    state[12] = counter;
+    if (nonce) {
+        for (int i = 0; i < 3; i++) state[13 + i] = LOAD32_LE(nonce + 4 * i);
+    }
+}
+
+/**
+ * @brief Runs the 20 ChaCha rounds
+ * @param out 16-word output
+ * @param in 16-word input state
+ * @param feedForward TRUE to add the input (ChaCha20 block), FALSE for HChaCha20
+ */
+static void ChaChaRounds(DWORD* out, const DWORD* in, BOOL feedForward) {
+    DWORD x[16];
+    for (int i = 0; i < 16; i++) x[i] = in[i];
+
+    for (int round = 0; round < 10; round++) {
+        QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+    for (int i = 0; i < 16; i++) out[i] = feedForward ? x[i] + in[i] : x[i];
+    SecureZeroMemory(x, sizeof(x));
+}
+
+/**
+ * @brief XORs data with the ChaCha20 keystream
+ * @param out Output (may equal in)
+ * @param in Input
+ * @param length Bytes
+ * @param key 32-byte key
+ * @param nonce 12-byte nonce
+ * @param counter First block counter
+ */
+static void ChaChaXor(BYTE* out, const BYTE* in, DWORD length, const BYTE* key, const BYTE* nonce, DWORD counter) {
+    DWORD state[16], block[16];
+    BYTE stream[64];
+
+    ChaChaInit(state, key, counter, nonce);
+    while (length > 0) {
+        ChaChaRounds(block, state, TRUE);
+        for (int i = 0; i < 16; i++) Store32(stream + 4 * i, block[i]);
+        DWORD n = length < 64 ? length : 64;
+        for (DWORD i = 0; i < n; i++) out[i] = in[i] ^ stream[i];
+        out += n;
+        in += n;
+        length -= n;
+        state[12]++;
+    }
+    SecureZeroMemory(state, sizeof(state));
+    SecureZeroMemory(block, sizeof(block));
+    SecureZeroMemory(stream, sizeof(stream));
+}
+
+/**
+ * @brief Derives a 32-byte key from a 32-byte secret with HChaCha20
+ * @param out 32-byte output key
+ * @param key 32-byte input secret
+ * @param input 16-byte domain input
+ */
+void HChaCha20(BYTE* out, const BYTE* key, const BYTE* input) {
+    DWORD state[16], x[16];
+
+    ChaChaInit(state, key, LOAD32_LE(input), NULL);
+    for (int i = 1; i < 4; i++) state[12 + i] = LOAD32_LE(input + 4 * i);
+    ChaChaRounds(x, state, FALSE);
+    for (int i = 0; i < 4; i++) {
+        Store32(out + 4 * i, x[i]);
+        Store32(out + 16 + 4 * i, x[12 + i]);
+    }
+    SecureZeroMemory(state, sizeof(state));
+    SecureZeroMemory(x, sizeof(x));
+}
+
+/**
+ * @brief Initializes Poly1305 with a one-time key
+ * @param poly State
+ * @param key 32-byte key (r, then s)
+ */
+static void PolyInit(Poly1305* poly, const BYTE* key) {
+    poly->r[0] = LOAD32_LE(key) & 0x3FFFFFF;
+    poly->r[1] = (LOAD32_LE(key + 3) >> 2) & 0x3FFFF03;
+    poly->r[2] = (LOAD32_LE(key + 6) >> 4) & 0x3FFC0FF;
+    poly->r[3] = (LOAD32_LE(key + 9) >> 6) & 0x3F03FFF;
+    poly->r[4] = (LOAD32_LE(key + 12) >> 8) & 0x00FFFFF;
+    for (int i = 0; i < 5; i++) poly->h[i] = 0;
+    for (int i = 0; i < 4; i++) poly->pad[i] = LOAD32_LE(key + 16 + 4 * i);
+}
+
+/**
+ * @brief Absorbs one 16-byte block
+ * @param poly State
+ * @param m Block
+ * @param hibit 1 << 24 for a full block; 0 for a final partial block that
+ *              already carries its 0x01 terminator
+ */
+static void PolyBlock(Poly1305* poly, const BYTE* m, DWORD hibit) {
+    const DWORD* r = poly->r;
+    DWORD* h = poly->h;
+    DWORD s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+
+    h[0] += LOAD32_LE(m) & 0x3FFFFFF;
+    h[1] += (LOAD32_LE(m + 3) >> 2) & 0x3FFFFFF;
+    h[2] += (LOAD32_LE(m + 6) >> 4) & 0x3FFFFFF;
+    h[3] += (LOAD32_LE(m + 9) >> 6) & 0x3FFFFFF;
+    h[4] += (LOAD32_LE(m + 12) >> 8) | hibit;
+
+    ULONGLONG d0 = (ULONGLONG)h[0] * r[0] + (ULONGLONG)h[1] * s4 + (ULONGLONG)h[2] * s3 + (ULONGLONG)h[3] * s2 + (ULONGLONG)h[4] * s1;
+    ULONGLONG d1 = (ULONGLONG)h[0] * r[1] + (ULONGLONG)h[1] * r[0] + (ULONGLONG)h[2] * s4 + (ULONGLONG)h[3] * s3 + (ULONGLONG)h[4] * s2;
+    ULONGLONG d2 = (ULONGLONG)h[0] * r[2] + (ULONGLONG)h[1] * r[1] + (ULONGLONG)h[2] * r[0] + (ULONGLONG)h[3] * s4 + (ULONGLONG)h[4] * s3;
+    ULONGLONG d3 = (ULONGLONG)h[0] * r[3] + (ULONGLONG)h[1] * r[2] + (ULONGLONG)h[2] * r[1] + (ULONGLONG)h[3] * r[0] + (ULONGLONG)h[4] * s4;
+    ULONGLONG d4 = (ULONGLONG)h[0] * r[4] + (ULONGLONG)h[1] * r[3] + (ULONGLONG)h[2] * r[2] + (ULONGLONG)h[3] * r[1] + (ULONGLONG)h[4] * r[0];
+
+    DWORD c = (DWORD)(d0 >> 26); h[0] = (DWORD)d0 & 0x3FFFFFF;
+    d1 += c; c = (DWORD)(d1 >> 26); h[1] = (DWORD)d1 & 0x3FFFFFF;
+    d2 += c; c = (DWORD)(d2 >> 26); h[2] = (DWORD)d2 & 0x3FFFFFF;
+    d3 += c; c = (DWORD)(d3 >> 26); h[3] = (DWORD)d3 & 0x3FFFFFF;
+    d4 += c; c = (DWORD)(d4 >> 26); h[4] = (DWORD)d4 & 0x3FFFFFF;
+    h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3FFFFFF;
+    h[1] += c;
+}
+
+/**
+ * @brief Absorbs data zero-padded to a multiple of 16 bytes (RFC 8439 pad16)
+ */
+static void PolyPadded(Poly1305* poly, const BYTE* data, DWORD length) {
+    BYTE last[16];
+
+    while (length >= 16) {
+        PolyBlock(poly, data, 1 << 24);
+        data += 16;
+        length -= 16;
+    }
+    if (length > 0) {
+        for (int i = 0; i < 16; i++) last[i] = (DWORD)i < length ? data[i] : 0;
+        PolyBlock(poly, last, 1 << 24);
+    }
+}
+
+/**
+ * @brief Produces the tag: (h mod 2^130 - 5) + s
+ */
+static void PolyFinish(Poly1305* poly, BYTE* tag) {
+    DWORD* h = poly->h;
+    DWORD c, g[5];
+
+    c = h[1] >> 26; h[1] &= 0x3FFFFFF;
+    h[2] += c; c = h[2] >> 26; h[2] &= 0x3FFFFFF;
+    h[3] += c; c = h[3] >> 26; h[3] &= 0x3FFFFFF;
+    h[4] += c; c = h[4] >> 26; h[4] &= 0x3FFFFFF;
+    h[0] += c * 5; c = h[0] >> 26; h[0] &= 0x3FFFFFF;
+    h[1] += c;
+
+    /* g = h - p; keep it if it did not borrow */
+    g[0] = h[0] + 5; c = g[0] >> 26; g[0] &= 0x3FFFFFF;
+    g[1] = h[1] + c; c = g[1] >> 26; g[1] &= 0x3FFFFFF;
+    g[2] = h[2] + c; c = g[2] >> 26; g[2] &= 0x3FFFFFF;
+    g[3] = h[3] + c; c = g[3] >> 26; g[3] &= 0x3FFFFFF;
+    g[4] = h[4] + c - (1 << 26);
+
+    DWORD mask = (g[4] >> 31) - 1;
+    for (int i = 0; i < 5; i++) h[i] = (h[i] & ~mask) | (g[i] & mask);
+
+    DWORD w0 = h[0] | (h[1] << 26);
+    DWORD w1 = (h[1] >> 6) | (h[2] << 20);
+    DWORD w2 = (h[2] >> 12) | (h[3] << 14);
+    DWORD w3 = (h[3] >> 18) | (h[4] << 8);
+
+    ULONGLONG f = (ULONGLONG)w0 + poly->pad[0];
+    Store32(tag, (DWORD)f);
+    f = (ULONGLONG)w1 + poly->pad[1] + (f >> 32);
+    Store32(tag + 4, (DWORD)f);
+    f = (ULONGLONG)w2 + poly->pad[2] + (f >> 32);
+    Store32(tag + 8, (DWORD)f);
+    f = (ULONGLONG)w3 + poly->pad[3] + (f >> 32);
+    Store32(tag + 12, (DWORD)f);
+
+    SecureZeroMemory(poly, sizeof(*poly));
+}
+
+/**
+ * @brief Computes a Poly1305 one-time authenticator (RFC 8439 section 2.5)
+ */
+void Poly1305Mac(BYTE* tag, const BYTE* message, DWORD length, const BYTE* key) {
+    BYTE last[16];
+    Poly1305 poly;
+
+    PolyInit(&poly, key);
+    while (length >= 16) {
+        PolyBlock(&poly, message, 1 << 24);
+        message += 16;
+        length -= 16;
+    }
+    if (length > 0) {
+        for (int i = 0; i < 16; i++) last[i] = (DWORD)i < length ? message[i] : (DWORD)i == length ? 1 : 0;
+        PolyBlock(&poly, last, 0);
+    }
+    PolyFinish(&poly, tag);
+}
+
+/**
+ * @brief Computes the RFC 8439 AEAD tag over aad and ciphertext
+ */
+static void AeadTag(BYTE* tag, const BYTE* ciphertext, DWORD length, const BYTE* aad, DWORD aadLength,
+                    const BYTE* key, const BYTE* nonce) {
+    BYTE polyKey[64];
+    BYTE lengths[16];
+    Poly1305 poly;
+
+    for (int i = 0; i < 64; i++) polyKey[i] = 0;
+    ChaChaXor(polyKey, polyKey, sizeof(polyKey), key, nonce, 0);
+    PolyInit(&poly, polyKey);
+
+    PolyPadded(&poly, aad, aadLength);
+    PolyPadded(&poly, ciphertext, length);
+    Store32(lengths, aadLength);
+    Store32(lengths + 4, 0);
+    Store32(lengths + 8, length);
+    Store32(lengths + 12, 0);
+    PolyBlock(&poly, lengths, 1 << 24);
+    PolyFinish(&poly, tag);
+    SecureZeroMemory(polyKey, sizeof(polyKey));
+}
+
+/**
+ * @brief Encrypts and authenticates with ChaCha20-Poly1305
+ */
+void AeadSeal(BYTE* out, BYTE* tag, const BYTE* in, DWORD length,
+              const BYTE* aad, DWORD aadLength, const BYTE* key, const BYTE* nonce) {
+    ChaChaXor(out, in, length, key, nonce, 1);
+    AeadTag(tag, out, length, aad, aadLength, key, nonce);
+}
+
+/**
+ * @brief Verifies and decrypts ChaCha20-Poly1305
+ * @return TRUE if the tag is valid
+ */
+BOOL AeadOpen(BYTE* out, const BYTE* in, DWORD length, const BYTE* tag,
+              const BYTE* aad, DWORD aadLength, const BYTE* key, const BYTE* nonce) {
+    BYTE expected[AEAD_TAG_SIZE];
+    BYTE diff = 0;
+
+    AeadTag(expected, in, length, aad, aadLength, key, nonce);
+    for (int i = 0; i < AEAD_TAG_SIZE; i++) diff |= expected[i] ^ tag[i];
+    if (diff != 0) return FALSE;
+
+    ChaChaXor(out, in, length, key, nonce, 1);
+    return TRUE;
+}
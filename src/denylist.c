@@ -0,0 +1,920 @@
+/**
+ * @file denylist.c
+ * @brief Deny-list compiler and lookup implementation
+ * @details The compiler is an external sort. Normalizing, sorting and
+ *          deduplicating runs of DENYLIST_RUN_BYTES of input uses one thread
+ *          per processor; the runs are spilled to a temporary file and merged
+ *          by a single thread, which writes the table sequentially. Only the
+ *          block index and block checksums of the table are held in memory.
+ */
+
+#include "../include/denylist.h"
+#include "../include/console_io.h"
+#include "../include/utils.h"
+
+#define FNV64_OFFSET      0xCBF29CE484222325ULL  /**< FNV-1a 64 offset basis */
+#define FNV64_PRIME       0x100000001B3ULL       /**< FNV-1a 64 prime */
+#define FNV32_OFFSET      0x811C9DC5U            /**< FNV-1a 32 offset basis */
+#define FNV32_PRIME       0x01000193U            /**< FNV-1a 32 prime */
+#define SLICE_MARGIN      65536                  /**< Bytes mapped on each side of a slice (allocation granularity) */
+#define RECORD_MAX        (1 + DENYLIST_MAX_ENTRY)  /**< Largest record: length byte and characters */
+
+/**
+ * @brief Normalization table built by NormalizeDenyText() on first use
+ */
+static char g_foldTable[256];
+static volatile LONG g_foldReady = 0;
+
+/**
+ * @brief A sorted, deduplicated run in the spill file
+ */
+typedef struct {
+    ULONGLONG offset;  /**< First byte in the spill file */
+    ULONGLONG size;    /**< Bytes of records */
+} DenyRun;
+
+/**
+ * @brief State shared by the run workers
+ */
+typedef struct {
+    HANDLE hMapping;          /**< Read-only mapping of the input */
+    ULONGLONG inputSize;      /**< Input bytes */
+    LONG slices;              /**< Slices of DENYLIST_RUN_BYTES */
+    volatile LONG nextSlice;  /**< Next slice to claim */
+    HANDLE hSpill;            /**< Spill file holding the runs */
+    CRITICAL_SECTION lock;    /**< Guards every field below */
+    ULONGLONG spillSize;      /**< Bytes written to the spill file */
+    DenyRun* runs;            /**< One run per non-empty slice */
+    int runCount;             /**< Entries in runs */
+    ULONGLONG lines;          /**< Lines seen */
+    ULONGLONG entries;        /**< Valid entries */
+    ULONGLONG runEntries;     /**< Entries left after deduplicating each run */
+    BOOL failed;              /**< A slice could not be mapped or a run not written */
+} CompileJob;
+
+/**
+ * @brief Buffers of one run worker
+ */
+typedef struct {
+    CompileJob* job;   /**< Shared job */
+    BYTE* records;     /**< Normalized records of the current slice */
+    DWORD* refs;       /**< Record offsets, sorted */
+    DWORD* temp;       /**< Merge sort scratch */
+    BYTE* out;         /**< Sorted, deduplicated run */
+} CompileWorker;
+
+/**
+ * @brief Read cursor over one run while merging
+ */
+typedef struct {
+    ULONGLONG next;                   /**< Next spill file byte to read */
+    ULONGLONG end;                    /**< End of the run */
+    DWORD pos;                        /**< Current record in buffer */
+    DWORD fill;                       /**< Valid bytes in buffer */
+    BYTE buffer[DENYLIST_READ_SIZE];  /**< Buffered part of the run */
+} RunReader;
+
+/**
+ * @brief Buffered sequential writer
+ */
+typedef struct {
+    HANDLE hFile;          /**< Output file */
+    ULONGLONG written;     /**< Bytes accepted so far */
+    DWORD used;            /**< Buffered bytes */
+    BOOL ok;               /**< FALSE after a write error */
+    BYTE buffer[DENYLIST_WRITE_SIZE];
+} TableWriter;
+
+/**
+ * @brief Fills the normalization table
+ */
+static void BuildFoldTable(void) {
+    static const char LEET_FROM[] = "0134578@$!";
+    static const char LEET_TO[]   = "oieastbasi";
+
+    for (int c = 0; c < 256; c++) g_foldTable[c] = (char)c;
+    for (int c = 'A'; c <= 'Z'; c++) g_foldTable[c] = (char)(c - 'A' + 'a');
+    for (int i = 0; LEET_FROM[i] != '\0'; i++) g_foldTable[(BYTE)LEET_FROM[i]] = LEET_TO[i];
+    InterlockedExchange(&g_foldReady, 1);
+}
+
+/**
+ * @brief Normalizes text for deny-list matching
+ * @param text Text to normalize in place
+ * @param length Number of bytes
+ */
+void NormalizeDenyText(char* text, int length) {
+    /* Rebuilding concurrently is harmless: every thread writes the same values */
+    if (!g_foldReady) BuildFoldTable();
+    for (int i = 0; i < length; i++) text[i] = g_foldTable[(BYTE)text[i]];
+}
+
+/**
+ * @brief Compares two normalized entries in byte order, shorter prefix first
+ * @param a First entry
+ * @param lengthA Length of a
+ * @param b Second entry
+ * @param lengthB Length of b
+ * @return Negative, zero or positive
+ */
+static int CompareBytes(const BYTE* a, int lengthA, const BYTE* b, int lengthB) {
+    int n = lengthA < lengthB ? lengthA : lengthB;
+    for (int i = 0; i < n; i++) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return lengthA - lengthB;
+}
+
+/**
+ * @brief Compares two records (length byte, then characters)
+ * @param a First record
+ * @param b Second record
+ * @return Negative, zero or positive
+ */
+static int CompareRecords(const BYTE* a, const BYTE* b) {
+    return CompareBytes(a + 1, a[0], b + 1, b[0]);
+}
+
+/**
+ * @brief Appends bytes to the output
+ * @param writer Writer
+ * @param data Bytes
+ * @param length Number of bytes
+ */
+static void WriterPut(TableWriter* writer, const void* data, DWORD length) {
+    const BYTE* bytes = (const BYTE*)data;
+
+    writer->written += length;
+    while (length > 0) {
+        DWORD chunk = DENYLIST_WRITE_SIZE - writer->used;
+        if (chunk > length) chunk = length;
+        CopyMemory(writer->buffer + writer->used, bytes, chunk);
+        writer->used += chunk;
+        bytes += chunk;
+        length -= chunk;
+
+        if (writer->used == DENYLIST_WRITE_SIZE) {
+            DWORD written = 0;
+            if (!WriteFile(writer->hFile, writer->buffer, writer->used, &written, NULL) || written != writer->used) {
+                writer->ok = FALSE;
+            }
+            writer->used = 0;
+        }
+    }
+}
+
+/**
+ * @brief Writes out buffered bytes
+ * @param writer Writer
+ */
+static void WriterFlush(TableWriter* writer) {
+    DWORD written = 0;
+    if (writer->used == 0) return;
+    if (!WriteFile(writer->hFile, writer->buffer, writer->used, &written, NULL) || written != writer->used) {
+        writer->ok = FALSE;
+    }
+    writer->used = 0;
+}
+
+/**
+ * @brief Writes a buffer at a file offset
+ * @param hFile File
+ * @param offset Byte offset
+ * @param data Bytes
+ * @param length Number of bytes
+ * @return TRUE if everything was written
+ */
+static BOOL WriteAt(HANDLE hFile, ULONGLONG offset, const void* data, DWORD length) {
+    OVERLAPPED position;
+    DWORD written = 0;
+
+    ZeroMemory(&position, sizeof(position));
+    position.Offset = (DWORD)offset;
+    position.OffsetHigh = (DWORD)(offset >> 32);
+    return WriteFile(hFile, data, length, &written, &position) && written == length;
+}
+
+/**
+ * @brief Sorts, deduplicates and spills the records of one slice
+ * @param worker Worker holding the records
+ * @param count Number of records
+ * @return TRUE on success, FALSE if the run could not be written
+ * @details Bottom-up merge sort of the record offsets, alternating between
+ *          refs and temp, then one pass that copies each distinct record out.
+ */
+static BOOL SpillRun(CompileWorker* worker, DWORD count) {
+    CompileJob* job = worker->job;
+    DWORD* src = worker->refs;
+    DWORD* dst = worker->temp;
+    const BYTE* records = worker->records;
+
+    for (DWORD width = 1; width < count; width *= 2) {
+        for (DWORD lo = 0; lo < count; lo += 2 * width) {
+            DWORD mid = lo + width < count ? lo + width : count;
+            DWORD hi = lo + 2 * width < count ? lo + 2 * width : count;
+            DWORD i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                dst[k++] = CompareRecords(records + src[i], records + src[j]) <= 0 ? src[i++] : src[j++];
+            }
+            while (i < mid) dst[k++] = src[i++];
+            while (j < hi) dst[k++] = src[j++];
+        }
+        DWORD* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    DWORD size = 0;
+    DWORD unique = 0;
+    const BYTE* previous = NULL;
+    for (DWORD i = 0; i < count; i++) {
+        const BYTE* record = records + src[i];
+        if (previous && CompareRecords(previous, record) == 0) continue;
+        CopyMemory(worker->out + size, record, 1 + (DWORD)record[0]);
+        size += 1 + (DWORD)record[0];
+        previous = record;
+        unique++;
+    }
+
+    /* Reserve the run's place in the spill file, then write it there */
+    EnterCriticalSection(&job->lock);
+    DenyRun* run = &job->runs[job->runCount++];
+    run->offset = job->spillSize;
+    run->size = size;
+    job->spillSize += size;
+    job->runEntries += unique;
+    LeaveCriticalSection(&job->lock);
+
+    return WriteAt(job->hSpill, run->offset, worker->out, size);
+}
+
+/**
+ * @brief Collects the normalized entries of one slice and spills them as a run
+ * @param worker Worker
+ * @param slice Slice index
+ * @return TRUE on success, FALSE on failure
+ * @details A slice owns the lines that start inside it. Its view reaches
+ *          SLICE_MARGIN bytes past each end, so the line before it can be
+ *          skipped and its last line read to the end. Lines longer than the
+ *          margin are noise rather than passwords and are dropped wherever
+ *          they fall, so the table does not depend on slice boundaries.
+ */
+static BOOL ProcessSlice(CompileWorker* worker, LONG slice) {
+    CompileJob* job = worker->job;
+    ULONGLONG sliceStart = (ULONGLONG)slice * DENYLIST_RUN_BYTES;
+    ULONGLONG sliceEnd = sliceStart + DENYLIST_RUN_BYTES < job->inputSize ? sliceStart + DENYLIST_RUN_BYTES : job->inputSize;
+    ULONGLONG viewStart = sliceStart > 0 ? sliceStart - SLICE_MARGIN : 0;
+    ULONGLONG viewEnd = sliceEnd + SLICE_MARGIN < job->inputSize ? sliceEnd + SLICE_MARGIN : job->inputSize;
+
+    const BYTE* view = (const BYTE*)MapViewOfFile(job->hMapping, FILE_MAP_READ, (DWORD)(viewStart >> 32),
+                                                  (DWORD)viewStart, (SIZE_T)(viewEnd - viewStart));
+    if (!view) return FALSE;
+    const BYTE* text = view - viewStart;  /* Indexed by file offset */
+
+    /* Skip the tail of a line that started in the previous slice */
+    ULONGLONG pos = sliceStart;
+    if (pos > 0 && text[pos - 1] != '\n') {
+        while (pos < viewEnd && text[pos] != '\n') pos++;
+        pos++;
+    }
+
+    ULONGLONG lines = 0;
+    DWORD count = 0;
+    DWORD used = 0;
+    while (pos < sliceEnd) {
+        ULONGLONG p = pos;
+        BOOL ascii = TRUE;
+
+        while (p < viewEnd && text[p] != '\n') {
+            if (text[p] >= 0x80) ascii = FALSE;
+            p++;
+        }
+        lines++;
+        /* Past the margin: the line is too long to be anything but noise */
+        if (p == viewEnd && viewEnd < job->inputSize) break;
+
+        ULONGLONG length = p - pos;
+        if (length > 0 && text[p - 1] == '\r') length--;
+        if (ascii && length >= DENYLIST_MIN_ENTRY && p - pos <= SLICE_MARGIN) {
+            /* A cut entry is a prefix of the full one, so it denies at least as much */
+            if (length > DENYLIST_MAX_ENTRY) length = DENYLIST_MAX_ENTRY;
+            BYTE* record = worker->records + used;
+            record[0] = (BYTE)length;
+            CopyMemory(record + 1, text + pos, (SIZE_T)length);
+            NormalizeDenyText((char*)record + 1, (int)length);
+            worker->refs[count++] = used;
+            used += 1 + (DWORD)length;
+        }
+        pos = p + 1;
+    }
+    UnmapViewOfFile(view);
+
+    EnterCriticalSection(&job->lock);
+    job->lines += lines;
+    job->entries += count;
+    LeaveCriticalSection(&job->lock);
+    return count == 0 || SpillRun(worker, count);
+}
+
+/**
+ * @brief Thread procedure: claims slices until none are left
+ * @param param CompileWorker
+ * @return 0
+ */
+static DWORD WINAPI CompileWorkerProc(LPVOID param) {
+    CompileWorker* worker = (CompileWorker*)param;
+    CompileJob* job = worker->job;
+
+    for (;;) {
+        LONG slice = InterlockedIncrement(&job->nextSlice) - 1;
+        if (slice >= job->slices || job->failed) break;
+        if (!ProcessSlice(worker, slice)) {
+            EnterCriticalSection(&job->lock);
+            job->failed = TRUE;
+            LeaveCriticalSection(&job->lock);
+            break;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Makes the next record of a run available
+ * @param job Compile job (spill file)
+ * @param reader Run reader
+ * @return Record, or NULL at the end of the run or on a read error
+ */
+static const BYTE* RunRecord(CompileJob* job, RunReader* reader) {
+    DWORD available = reader->fill - reader->pos;
+
+    if (available == 0 || available < 1 + (DWORD)reader->buffer[reader->pos]) {
+        OVERLAPPED position;
+        DWORD got = 0;
+
+        if (reader->next == reader->end) return NULL;
+        MoveMemory(reader->buffer, reader->buffer + reader->pos, available);
+        reader->pos = 0;
+        reader->fill = available;
+
+        DWORD want = DENYLIST_READ_SIZE - available;
+        if ((ULONGLONG)want > reader->end - reader->next) want = (DWORD)(reader->end - reader->next);
+        ZeroMemory(&position, sizeof(position));
+        position.Offset = (DWORD)reader->next;
+        position.OffsetHigh = (DWORD)(reader->next >> 32);
+        if (!ReadFile(job->hSpill, reader->buffer + available, want, &got, &position) || got != want) return NULL;
+        reader->next += want;
+        reader->fill += want;
+    }
+    return reader->buffer + reader->pos;
+}
+
+/**
+ * @brief Restores the heap order below one position
+ * @param heap Run indices, ordered by current record
+ * @param count Heap size
+ * @param readers Run readers
+ * @param at Position to sift down from
+ */
+static void SiftDown(int* heap, int count, RunReader* readers, int at) {
+    for (;;) {
+        int smallest = at;
+        int left = 2 * at + 1;
+        int right = left + 1;
+        const BYTE* best = readers[heap[at]].buffer + readers[heap[at]].pos;
+
+        if (left < count && CompareRecords(readers[heap[left]].buffer + readers[heap[left]].pos, best) < 0) {
+            smallest = left;
+            best = readers[heap[left]].buffer + readers[heap[left]].pos;
+        }
+        if (right < count && CompareRecords(readers[heap[right]].buffer + readers[heap[right]].pos, best) < 0) {
+            smallest = right;
+        }
+        if (smallest == at) return;
+        int swap = heap[at];
+        heap[at] = heap[smallest];
+        heap[smallest] = swap;
+        at = smallest;
+    }
+}
+
+/**
+ * @brief Continues an FNV-1a 32 checksum over a block's bytes
+ * @param hash Checksum so far (FNV32_OFFSET at the start of a block)
+ * @param data Bytes to add
+ * @param length Number of bytes
+ * @return Updated checksum
+ */
+static DWORD BlockChecksum(DWORD hash, const BYTE* data, ULONGLONG length) {
+    for (ULONGLONG i = 0; i < length; i++) hash = (hash ^ data[i]) * FNV32_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Merges every run into the table body and builds the block index
+ * @param job Compile job
+ * @param writer Table writer, positioned after the header
+ * @param header Output: counts, lengths and blob size
+ * @param index Block index with room for runEntries / DENYLIST_BLOCK + 2 offsets
+ * @param blockSums Output: FNV-1a 32 of each block, with as much room as the index
+ * @return TRUE on success, FALSE on a read error
+ */
+static BOOL MergeRuns(CompileJob* job, TableWriter* writer, DenyListHeader* header, ULONGLONG* index,
+                      DWORD* blockSums) {
+    HANDLE hHeap = GetProcessHeap();
+    BYTE last[RECORD_MAX];
+    BOOL haveLast = FALSE;
+    BOOL ok = TRUE;
+    int heapCount = 0;
+
+    RunReader* readers = (RunReader*)HeapAlloc(hHeap, 0, (SIZE_T)job->runCount * sizeof(RunReader));
+    int* heap = (int*)HeapAlloc(hHeap, 0, (SIZE_T)job->runCount * sizeof(int));
+    if (!readers || !heap) {
+        if (readers) HeapFree(hHeap, 0, readers);
+        if (heap) HeapFree(hHeap, 0, heap);
+        return FALSE;
+    }
+
+    for (int r = 0; r < job->runCount; r++) {
+        readers[r].next = job->runs[r].offset;
+        readers[r].end = job->runs[r].offset + job->runs[r].size;
+        readers[r].pos = 0;
+        readers[r].fill = 0;
+        if (RunRecord(job, &readers[r])) heap[heapCount++] = r;
+        else ok = ok && readers[r].next == readers[r].end;
+    }
+    for (int i = heapCount / 2 - 1; i >= 0; i--) SiftDown(heap, heapCount, readers, i);
+
+    header->count = 0;
+    header->minLength = DENYLIST_MAX_ENTRY;
+    header->maxLength = 0;
+    while (ok && heapCount > 0) {
+        RunReader* reader = &readers[heap[0]];
+        const BYTE* record = reader->buffer + reader->pos;
+
+        /* Runs are deduplicated already; only equal heads of different runs repeat */
+        if (!haveLast || CompareRecords(last, record) != 0) {
+            ULONGLONG block = header->count / DENYLIST_BLOCK;
+            if (header->count % DENYLIST_BLOCK == 0) {
+                index[block] = writer->written;
+                blockSums[block] = FNV32_OFFSET;
+            }
+            blockSums[block] = BlockChecksum(blockSums[block], record, 1 + (DWORD)record[0]);
+            WriterPut(writer, record, 1 + (DWORD)record[0]);
+            if (record[0] < header->minLength) header->minLength = record[0];
+            if (record[0] > header->maxLength) header->maxLength = record[0];
+            CopyMemory(last, record, 1 + (DWORD)record[0]);
+            haveLast = TRUE;
+            header->count++;
+        }
+
+        reader->pos += 1 + (DWORD)record[0];
+        if (!RunRecord(job, reader)) {
+            ok = reader->next == reader->end && reader->pos == reader->fill;
+            heap[0] = heap[--heapCount];
+        }
+        if (heapCount > 0) SiftDown(heap, heapCount, readers, 0);
+    }
+
+    header->blocks = (header->count + DENYLIST_BLOCK - 1) / DENYLIST_BLOCK;
+    header->blobSize = writer->written;
+    index[header->blocks] = writer->written;
+    HeapFree(hHeap, 0, heap);
+    HeapFree(hHeap, 0, readers);
+    return ok;
+}
+
+/**
+ * @brief Computes the header checksum
+ * @param header Header with every field but the checksum set
+ * @param index Block index
+ * @return FNV-1a 64 of the fields before the checksum and the index
+ */
+static ULONGLONG TableChecksum(const DenyListHeader* header, const ULONGLONG* index) {
+    const BYTE* bytes = (const BYTE*)header;
+    const BYTE* indexBytes = (const BYTE*)index;
+    ULONGLONG hash = FNV64_OFFSET;
+    ULONGLONG indexSize = (header->blocks + 1) * sizeof(ULONGLONG);
+
+    for (SIZE_T i = 0; i < sizeof(DenyListHeader) - sizeof(ULONGLONG); i++) hash = (hash ^ bytes[i]) * FNV64_PRIME;
+    for (ULONGLONG i = 0; i < indexSize; i++) hash = (hash ^ indexBytes[i]) * FNV64_PRIME;
+    return hash;
+}
+
+/**
+ * @brief Formats a 64-bit count into a message buffer
+ * @param buffer Output, at least 21 bytes
+ * @param value Value
+ * @return buffer
+ */
+static const char* CountText(char* buffer, ULONGLONG value) {
+    FormatULongLong(buffer, value);
+    return buffer;
+}
+
+/**
+ * @brief Compiles a text list into a binary deny-list table
+ * @param inputPath Text list
+ * @param outputPath Table file
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL CompileDenyList(const WCHAR* inputPath, const WCHAR* outputPath) {
+    static TableWriter writer;
+    static CompileWorker workers[MAX_DENYLIST_THREADS];
+    HANDLE hHeap = GetProcessHeap();
+    HANDLE threads[MAX_DENYLIST_THREADS];
+    LARGE_INTEGER freq, start, end, size;
+    SYSTEM_INFO sysInfo;
+    DenyListHeader header;
+    CompileJob job;
+    char msgBuf[320];
+    char linesText[24], uniqueText[24], entriesText[24];
+    BOOL success = FALSE;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    HANDLE hInput = CreateFileW(inputPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hInput == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot open deny-list input");
+        return FALSE;
+    }
+    if (!GetFileSizeEx(hInput, &size) || size.QuadPart == 0 ||
+        (ULONGLONG)size.QuadPart / DENYLIST_RUN_BYTES >= MAXLONG) {
+        ConsoleWrite("[ERROR] Deny-list input is empty or too large.\r\n");
+        CloseHandle(hInput);
+        return FALSE;
+    }
+
+    ZeroMemory(&job, sizeof(job));
+    job.inputSize = (ULONGLONG)size.QuadPart;
+    job.slices = (LONG)((job.inputSize + DENYLIST_RUN_BYTES - 1) / DENYLIST_RUN_BYTES);
+    job.hMapping = CreateFileMappingA(hInput, NULL, PAGE_READONLY, 0, 0, NULL);
+    job.runs = (DenyRun*)HeapAlloc(hHeap, 0, (SIZE_T)job.slices * sizeof(DenyRun));
+    if (!job.hMapping || !job.runs) {
+        PrintError(job.hMapping ? "Memory Error" : "Cannot map deny-list input");
+        if (job.hMapping) CloseHandle(job.hMapping);
+        if (job.runs) HeapFree(hHeap, 0, job.runs);
+        CloseHandle(hInput);
+        return FALSE;
+    }
+
+    /* Runs go next to the output, which has to hold the table anyway */
+    int pathLength = lstrlenW(outputPath);
+    WCHAR* spillPath = (WCHAR*)HeapAlloc(hHeap, 0, (SIZE_T)(pathLength + 6) * sizeof(WCHAR));
+    if (spillPath) {
+        lstrcpyW(spillPath, outputPath);
+        lstrcatW(spillPath, L".runs");
+        job.hSpill = CreateFileW(spillPath, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                                 FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        HeapFree(hHeap, 0, spillPath);
+    }
+    if (!spillPath || job.hSpill == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot create deny-list run file");
+        HeapFree(hHeap, 0, job.runs);
+        CloseHandle(job.hMapping);
+        CloseHandle(hInput);
+        return FALSE;
+    }
+    InitializeCriticalSection(&job.lock);
+
+    /* Phase 1: one thread per processor (at most one per slice) builds runs */
+    GetSystemInfo(&sysInfo);
+    int threadCount = (int)sysInfo.dwNumberOfProcessors;
+    if (threadCount > MAX_DENYLIST_THREADS) threadCount = MAX_DENYLIST_THREADS;
+    if (threadCount > job.slices) threadCount = (int)job.slices;
+    if (threadCount < 1) threadCount = 1;
+
+    SIZE_T recordBytes = DENYLIST_RUN_BYTES + SLICE_MARGIN + RECORD_MAX;
+    SIZE_T refCount = DENYLIST_RUN_BYTES / (DENYLIST_MIN_ENTRY + 1) + 2;
+    SIZE_T workerBytes = 2 * recordBytes + 2 * refCount * sizeof(DWORD);
+    int ready = 0;
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].job = &job;
+        workers[t].records = (BYTE*)HeapAlloc(hHeap, 0, recordBytes);
+        workers[t].out = (BYTE*)HeapAlloc(hHeap, 0, recordBytes);
+        workers[t].refs = (DWORD*)HeapAlloc(hHeap, 0, 2 * refCount * sizeof(DWORD));
+        workers[t].temp = workers[t].refs ? workers[t].refs + refCount : NULL;
+        if (!workers[t].records || !workers[t].out || !workers[t].refs) break;
+        ready++;
+    }
+    if (ready < threadCount) {
+        /* Fewer workers is fine; none is not */
+        if (workers[ready].records) HeapFree(hHeap, 0, workers[ready].records);
+        if (workers[ready].out) HeapFree(hHeap, 0, workers[ready].out);
+        if (workers[ready].refs) HeapFree(hHeap, 0, workers[ready].refs);
+        threadCount = ready;
+    }
+
+    int started = 0;
+    if (threadCount > 0) {
+        for (int t = 1; t < threadCount; t++) {
+            threads[started] = CreateThread(NULL, 0, CompileWorkerProc, &workers[t], 0, NULL);
+            if (threads[started]) started++;
+        }
+        CompileWorkerProc(&workers[0]);
+        if (started > 0) {
+            WaitForMultipleObjects((DWORD)started, threads, TRUE, INFINITE);
+            for (int t = 0; t < started; t++) CloseHandle(threads[t]);
+        }
+    }
+    for (int t = 0; t < threadCount; t++) {
+        HeapFree(hHeap, 0, workers[t].records);
+        HeapFree(hHeap, 0, workers[t].out);
+        HeapFree(hHeap, 0, workers[t].refs);
+    }
+    CloseHandle(job.hMapping);
+    CloseHandle(hInput);
+    ULONGLONG runPeak = (ULONGLONG)threadCount * workerBytes;
+
+    ULONGLONG* index = NULL;
+    DWORD* blockSums = NULL;
+    ULONGLONG mergePeak = 0;
+    if (threadCount == 0) {
+        PrintError("Memory Error");
+    } else if (job.failed) {
+        PrintError("Cannot write deny-list runs");
+    } else if (job.entries == 0) {
+        ConsoleWrite("[ERROR] Deny-list input has no usable entries.\r\n");
+    } else {
+        /* Phase 2: one merge pass writes the table; the header goes in last */
+        SIZE_T indexCount = (SIZE_T)(job.runEntries / DENYLIST_BLOCK + 2);
+        index = (ULONGLONG*)HeapAlloc(hHeap, 0, indexCount * sizeof(ULONGLONG));
+        blockSums = (DWORD*)HeapAlloc(hHeap, 0, indexCount * sizeof(DWORD));
+        mergePeak = (ULONGLONG)indexCount * (sizeof(ULONGLONG) + sizeof(DWORD)) +
+                    (ULONGLONG)job.runCount * sizeof(RunReader) + sizeof(writer);
+        HANDLE hOut = index && blockSums
+                          ? CreateFileW(outputPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL)
+                          : INVALID_HANDLE_VALUE;
+        if (!index || !blockSums) {
+            PrintError("Memory Error");
+        } else if (hOut == INVALID_HANDLE_VALUE) {
+            PrintError("Cannot create deny-list table");
+        } else {
+            static const BYTE padding[sizeof(ULONGLONG)] = { 0 };
+
+            ZeroMemory(&header, sizeof(header));
+            writer.hFile = hOut;
+            writer.used = 0;
+            writer.ok = TRUE;
+            writer.written = 0;
+            WriterPut(&writer, &header, sizeof(header));
+            writer.written = 0;  /* Blob offsets count from the end of the header */
+
+            BOOL merged = MergeRuns(&job, &writer, &header, index, blockSums);
+            DWORD pad = (DWORD)((sizeof(ULONGLONG) - (sizeof(header) + header.blobSize) % sizeof(ULONGLONG)) % sizeof(ULONGLONG));
+            WriterPut(&writer, padding, pad);
+            for (ULONGLONG b = 0; b <= header.blocks; b++) WriterPut(&writer, &index[b], sizeof(ULONGLONG));
+            for (ULONGLONG b = 0; b < header.blocks; b++) WriterPut(&writer, &blockSums[b], sizeof(DWORD));
+            WriterFlush(&writer);
+
+            header.magic = DENYLIST_MAGIC;
+            header.version = DENYLIST_VERSION;
+            header.checksum = TableChecksum(&header, index);
+            success = merged && writer.ok && WriteAt(hOut, 0, &header, sizeof(header));
+            CloseHandle(hOut);
+            if (!merged) PrintError("Cannot read deny-list runs");
+            else if (!success) PrintError("Write Failed");
+            if (!success) DeleteFileW(outputPath);
+        }
+    }
+
+    if (index) HeapFree(hHeap, 0, index);
+    if (blockSums) HeapFree(hHeap, 0, blockSums);
+    CloseHandle(job.hSpill);
+    DeleteCriticalSection(&job.lock);
+    int runCount = job.runCount;
+    HeapFree(hHeap, 0, job.runs);
+
+    if (success) {
+        QueryPerformanceCounter(&end);
+        ULONGLONG peak = runPeak > mergePeak ? runPeak : mergePeak;
+        wsprintfA(msgBuf, "[INFO] Compiled %s lines into %s unique entries (%s usable) with %d threads and %d runs in %lu ms; peak buffers %lu MB.\r\n",
+                  CountText(linesText, job.lines), CountText(uniqueText, header.count), CountText(entriesText, job.entries),
+                  threadCount, runCount, (DWORD)((end.QuadPart - start.QuadPart) * 1000 / freq.QuadPart),
+                  (DWORD)(peak >> 20));
+        ConsoleWrite(msgBuf);
+    }
+    return success;
+}
+
+/**
+ * @brief Maps a compiled deny-list for lookups
+ * @param path Table file
+ * @return Open list, or NULL on failure
+ */
+DenyList* OpenDenyList(const WCHAR* path) {
+    HANDLE hHeap = GetProcessHeap();
+    LARGE_INTEGER size;
+
+    DenyList* list = (DenyList*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, sizeof(DenyList));
+    if (!list) {
+        PrintError("Memory Error");
+        return NULL;
+    }
+
+    list->hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (list->hFile == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot open deny-list");
+        HeapFree(hHeap, 0, list);
+        return NULL;
+    }
+    if (!GetFileSizeEx(list->hFile, &size) || (ULONGLONG)size.QuadPart < sizeof(DenyListHeader) ||
+        (ULONGLONG)size.QuadPart > (SIZE_T)-1) {
+        ConsoleWrite("[ERROR] Deny-list file is truncated or too large.\r\n");
+        CloseHandle(list->hFile);
+        HeapFree(hHeap, 0, list);
+        return NULL;
+    }
+
+    list->hMapping = CreateFileMappingA(list->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    list->view = list->hMapping ? (const BYTE*)MapViewOfFile(list->hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!list->view) {
+        PrintError("Cannot map deny-list");
+        CloseDenyList(list);
+        return NULL;
+    }
+
+    list->header = (const DenyListHeader*)list->view;
+    const DenyListHeader* header = list->header;
+    if (header->magic != DENYLIST_MAGIC || header->version != DENYLIST_VERSION) {
+        ConsoleWrite("[ERROR] Not a deny-list table of this version; recompile it with --compile-denylist.\r\n");
+        CloseDenyList(list);
+        return NULL;
+    }
+
+    /* Sizes first, in an order that cannot overflow, so the index can be read safely */
+    ULONGLONG fileSize = (ULONGLONG)size.QuadPart;
+    ULONGLONG bodySize = fileSize - sizeof(DenyListHeader);
+    ULONGLONG indexStart = 0;
+    BOOL valid = header->count > 0 && header->count <= bodySize / 2 &&
+                 header->blocks == (header->count + DENYLIST_BLOCK - 1) / DENYLIST_BLOCK &&
+                 header->minLength >= DENYLIST_MIN_ENTRY && header->minLength <= header->maxLength &&
+                 header->maxLength <= DENYLIST_MAX_ENTRY && header->blobSize <= bodySize;
+    if (valid) {
+        indexStart = (sizeof(DenyListHeader) + header->blobSize + sizeof(ULONGLONG) - 1) / sizeof(ULONGLONG) * sizeof(ULONGLONG);
+        valid = indexStart <= fileSize &&
+                fileSize - indexStart == (header->blocks + 1) * sizeof(ULONGLONG) + header->blocks * sizeof(DWORD);
+    }
+    if (!valid) {
+        ConsoleWrite("[ERROR] Deny-list table size does not match its header.\r\n");
+        CloseDenyList(list);
+        return NULL;
+    }
+
+    list->blob = list->view + sizeof(DenyListHeader);
+    list->index = (const ULONGLONG*)(list->view + indexStart);
+    list->blockSums = (const DWORD*)(list->index + header->blocks + 1);
+    if (TableChecksum(header, list->index) != header->checksum) {
+        ConsoleWrite("[ERROR] Deny-list checksum mismatch; the table is corrupt.\r\n");
+        CloseDenyList(list);
+        return NULL;
+    }
+
+    /* Every block must be non-empty and inside the blob */
+    BOOL ordered = list->index[0] == 0 && list->index[header->blocks] == header->blobSize;
+    for (ULONGLONG b = 0; ordered && b < header->blocks; b++) ordered = list->index[b] < list->index[b + 1];
+    if (!ordered) {
+        ConsoleWrite("[ERROR] Deny-list index is out of order; the table is corrupt.\r\n");
+        CloseDenyList(list);
+        return NULL;
+    }
+
+    list->verified = (volatile LONG*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, (SIZE_T)((header->blocks + 31) / 32) * sizeof(LONG));
+    if (!list->verified) {
+        PrintError("Memory Error");
+        CloseDenyList(list);
+        return NULL;
+    }
+    return list;
+}
+
+/**
+ * @brief Unmaps a deny-list
+ * @param list List to close
+ */
+void CloseDenyList(const DenyList* list) {
+    if (!list) return;
+    if (list->view) UnmapViewOfFile(list->view);
+    if (list->hMapping) CloseHandle(list->hMapping);
+    if (list->hFile && list->hFile != INVALID_HANDLE_VALUE) CloseHandle(list->hFile);
+    if (list->verified) HeapFree(GetProcessHeap(), 0, (LPVOID)list->verified);
+    HeapFree(GetProcessHeap(), 0, (LPVOID)list);
+}
+
+/**
+ * @brief Reads the entry at a blob position, clamped to its block
+ * @param list Open deny-list
+ * @param pos Position of the length byte
+ * @param end End of the block
+ * @param length Output: entry length (0 if the record is damaged)
+ * @return Entry characters
+ */
+static const BYTE* BlockEntry(const DenyList* list, ULONGLONG pos, ULONGLONG end, int* length) {
+    ULONGLONG available = end - pos - 1;
+    *length = (ULONGLONG)list->blob[pos] <= available ? list->blob[pos] : 0;
+    return list->blob + pos + 1;
+}
+
+/**
+ * @brief Checks a block against its checksum the first time it is read
+ * @param list Open deny-list
+ * @param block Block number
+ * @return TRUE if the block is intact, FALSE if it is damaged (reported once)
+ * @details Threads racing on a new block may both hash it; the bit is only ever set.
+ */
+static BOOL CheckBlock(const DenyList* list, ULONGLONG block) {
+    volatile LONG* word = &list->verified[block / 32];
+    LONG bit = (LONG)(1UL << (block % 32));
+    char msgBuf[96];
+    char number[24];
+
+    if (*word & bit) return TRUE;
+
+    ULONGLONG start = list->index[block];
+    if (BlockChecksum(FNV32_OFFSET, list->blob + start, list->index[block + 1] - start) != list->blockSums[block]) {
+        if (InterlockedExchange((volatile LONG*)&list->corrupt, 1) == 0) {
+            wsprintfA(msgBuf, "[ERROR] Deny-list block %s fails its checksum; the table is corrupt.\r\n",
+                      CountText(number, block));
+            ConsoleWrite(msgBuf);
+        }
+        return FALSE;
+    }
+    InterlockedOr(word, bit);
+    return TRUE;
+}
+
+/**
+ * @brief Finds the largest entry that is not above a key
+ * @param list Open deny-list
+ * @param key Normalized key
+ * @param keyLength Key length
+ * @param length Output: length of the entry found
+ * @return Entry characters, or NULL if every entry is above the key or a block
+ *         read is damaged (list->corrupt is then set)
+ */
+static const BYTE* FindFloor(const DenyList* list, const BYTE* key, int keyLength, int* length) {
+    ULONGLONG lo = 0;
+    ULONGLONG hi = list->header->blocks;
+    const BYTE* best = NULL;
+
+    /* Last block whose first entry is not above the key */
+    while (lo < hi) {
+        ULONGLONG mid = lo + (hi - lo) / 2;
+        int entryLength;
+        if (!CheckBlock(list, mid)) return NULL;
+        const BYTE* entry = BlockEntry(list, list->index[mid], list->index[mid + 1], &entryLength);
+        if (CompareBytes(entry, entryLength, key, keyLength) <= 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0 || !CheckBlock(list, lo - 1)) return NULL;
+
+    ULONGLONG pos = list->index[lo - 1];
+    ULONGLONG end = list->index[lo];
+    while (pos < end) {
+        int entryLength;
+        const BYTE* entry = BlockEntry(list, pos, end, &entryLength);
+        if (entryLength == 0 || CompareBytes(entry, entryLength, key, keyLength) > 0) break;
+        best = entry;
+        *length = entryLength;
+        pos += 1 + (ULONGLONG)entryLength;
+    }
+    return best;
+}
+
+/**
+ * @brief Checks whether a password contains a denied entry
+ * @param list Open deny-list
+ * @param password Password
+ * @param length Password length
+ * @return TRUE if denied
+ */
+BOOL IsPasswordDenied(const DenyList* list, const char* password, int length) {
+    BYTE normalized[MAX_PASSWORD_LENGTH];
+    int minLength = (int)list->header->minLength;
+    int maxLength = (int)list->header->maxLength;
+
+    if (list->corrupt) return TRUE;
+    for (int i = 0; i < length; i++) normalized[i] = (BYTE)password[i];
+    NormalizeDenyText((char*)normalized, length);
+
+    for (int startPos = 0; startPos + minLength <= length; startPos++) {
+        const BYTE* key = normalized + startPos;
+        int keyLength = length - startPos < maxLength ? length - startPos : maxLength;
+
+        /* An entry that is a prefix of the key sorts between it and the floor, so the
+           floor shares it; otherwise only entries within the common prefix remain */
+        while (keyLength >= minLength) {
+            int entryLength;
+            const BYTE* entry = FindFloor(list, key, keyLength, &entryLength);
+            if (list->corrupt) return TRUE;
+            if (!entry) break;
+
+            int common = 0;
+            while (common < entryLength && common < keyLength && entry[common] == key[common]) common++;
+            if (common == entryLength) return TRUE;
+            if (common >= keyLength) break;  /* Only possible in a damaged table */
+            keyLength = common;
+        }
+    }
+    return FALSE;
+}
@@ -0,0 +1,433 @@
+/**
+ * @file intersect.c
+ * @brief Policy intersection and composition plan implementation
+ * @details Rules are merged keeping the policy that set each binding value, so a
+ *          conflict can name both sides. The plan is compiled in three passes over
+ *          all category compositions of the chosen length: find the most likely
+ *          one, sum the weights that survive pruning, then store the cumulative
+ *          thresholds the stream searches.
+ */
+
+#include "../include/intersect.h"
+#include "../include/profile_cache.h"
+#include "../include/console_io.h"
+#include "../include/strength.h"
+
+#define CATEGORY_COUNT 3  /**< Letters, numbers, symbols */
+
+static const char* const CATEGORY_NAMES[CATEGORY_COUNT] = { "Letters", "Numbers", "Symbols" };
+
+/**
+ * @brief A merged rule value and the policy that set it
+ */
+typedef struct {
+    int value;           /**< Binding value */
+    const char* source;  /**< Policy name, NULL for the built-in default */
+} PolicyBound;
+
+/**
+ * @brief Rules of all policies merged so far
+ */
+typedef struct {
+    PolicyBound minLength;                  /**< Largest MinLength */
+    PolicyBound maxLength;                  /**< Smallest MaxLength */
+    PolicyBound minCount[CATEGORY_COUNT];   /**< Largest Min<Category> */
+    const char* disabledBy[CATEGORY_COUNT]; /**< Policy (or flag) that forbids the category */
+    const char* disabledKey[CATEGORY_COUNT];/**< Rule that forbids it, e.g. "Symbols=0" */
+    const char* noLeadingDigit;             /**< Policy with NoLeadingDigit=1 */
+    const char* noLeadingSymbol;            /**< Policy with NoLeadingSymbol=1 */
+    char symbols[MAX_SYMBOL_SET];           /**< Symbols every policy allows */
+} PolicyRules;
+
+/**
+ * @brief Prints a conflict between two rules
+ * @param ruleA First rule, e.g. "MinLength=14"
+ * @param sourceA Policy of the first rule
+ * @param ruleB Second rule
+ * @param sourceB Policy of the second rule
+ */
+static void ReportConflict(const char* ruleA, const char* sourceA, const char* ruleB, const char* sourceB) {
+    char msgBuf[2 * MAX_PROFILE_NAME + 160];
+    wsprintfA(msgBuf, "[ERROR] Policies conflict: %s (%s) vs %s (%s).\r\n",
+              ruleA, sourceA ? sourceA : "default", ruleB, sourceB ? sourceB : "default");
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Raises a lower bound if the policy sets a larger value
+ * @param bound Merged bound
+ * @param value Policy value (-1 = not set)
+ * @param source Policy name
+ */
+static void RaiseBound(PolicyBound* bound, int value, const char* source) {
+    if (value > bound->value) {
+        bound->value = value;
+        bound->source = source;
+    }
+}
+
+/**
+ * @brief Merges one policy into the rules
+ * @param rules Rules merged so far
+ * @param entry Policy to add
+ */
+static void MergePolicy(PolicyRules* rules, const ProfileEntry* entry) {
+    const int counts[CATEGORY_COUNT] = { entry->letters, entry->numbers, entry->symbols };
+    const int minimums[CATEGORY_COUNT] = { entry->minLetters, entry->minNumbers, entry->minSymbols };
+
+    RaiseBound(&rules->minLength, entry->minLength, entry->name);
+    if (entry->maxLength != -1 && entry->maxLength < rules->maxLength.value) {
+        rules->maxLength.value = entry->maxLength;
+        rules->maxLength.source = entry->name;
+    }
+
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        RaiseBound(&rules->minCount[c], minimums[c], entry->name);
+        if (counts[c] == 0 && !rules->disabledBy[c]) {
+            rules->disabledBy[c] = entry->name;
+            rules->disabledKey[c] = c == 0 ? "Letters=0" : (c == 1 ? "Numbers=0" : "Symbols=0");
+        }
+    }
+
+    /* Keep only the symbols this policy allows as well */
+    if (entry->allowedSymbols[0] != '\0') {
+        int kept = 0;
+        for (int i = 0; rules->symbols[i] != '\0'; i++) {
+            for (int j = 0; entry->allowedSymbols[j] != '\0'; j++) {
+                if (entry->allowedSymbols[j] == rules->symbols[i]) {
+                    rules->symbols[kept++] = rules->symbols[i];
+                    break;
+                }
+            }
+        }
+        rules->symbols[kept] = '\0';
+        if (kept == 0 && !rules->disabledBy[2]) {
+            rules->disabledBy[2] = entry->name;
+            rules->disabledKey[2] = "AllowedSymbols";
+        }
+    }
+
+    if (entry->noLeadingDigit == 1 && !rules->noLeadingDigit) rules->noLeadingDigit = entry->name;
+    if (entry->noLeadingSymbol == 1 && !rules->noLeadingSymbol) rules->noLeadingSymbol = entry->name;
+}
+
+/**
+ * @brief Checks the merged rules and picks the password length
+ * @param rules Merged rules
+ * @param defaultLength Length used when no policy sets MaxLength
+ * @param length Output: chosen length
+ * @return TRUE if some password can satisfy every rule, FALSE (conflict printed) otherwise
+ */
+static BOOL ResolveRules(const PolicyRules* rules, int defaultLength, int* length) {
+    char ruleA[64];
+    char ruleB[64];
+    int minTotal = 0;
+
+    if (rules->minLength.value > rules->maxLength.value) {
+        wsprintfA(ruleA, "MinLength=%d", rules->minLength.value);
+        wsprintfA(ruleB, "MaxLength=%d", rules->maxLength.value);
+        ReportConflict(ruleA, rules->minLength.source, ruleB, rules->maxLength.source);
+        return FALSE;
+    }
+
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        if (rules->minCount[c].value > 0 && rules->disabledBy[c]) {
+            wsprintfA(ruleA, "Min%s=%d", CATEGORY_NAMES[c], rules->minCount[c].value);
+            ReportConflict(ruleA, rules->minCount[c].source, rules->disabledKey[c], rules->disabledBy[c]);
+            return FALSE;
+        }
+        minTotal += rules->minCount[c].value;
+    }
+    if (minTotal > rules->maxLength.value) {
+        wsprintfA(ruleA, "MinLetters+MinNumbers+MinSymbols=%d", minTotal);
+        wsprintfA(ruleB, "MaxLength=%d", rules->maxLength.value);
+        ReportConflict(ruleA, "combined", ruleB, rules->maxLength.source);
+        return FALSE;
+    }
+
+    if (rules->disabledBy[0] && rules->disabledBy[1] && rules->disabledBy[2]) {
+        ConsoleWrite("[ERROR] Policies conflict: no character category is allowed by all policies.\r\n");
+        return FALSE;
+    }
+
+    /* Letters can always lead; otherwise a digit or symbol must be allowed first */
+    if (rules->disabledBy[0] &&
+        (rules->disabledBy[1] || rules->noLeadingDigit) &&
+        (rules->disabledBy[2] || rules->noLeadingSymbol)) {
+        const char* leadRule = rules->noLeadingDigit ? "NoLeadingDigit=1" : "NoLeadingSymbol=1";
+        const char* leadSource = rules->noLeadingDigit ? rules->noLeadingDigit : rules->noLeadingSymbol;
+        ReportConflict(leadRule, leadSource, rules->disabledKey[0], rules->disabledBy[0]);
+        return FALSE;
+    }
+
+    /* Strongest length all policies accept; without MaxLength, the configured one */
+    *length = rules->maxLength.source ? rules->maxLength.value : defaultLength;
+    if (*length < rules->minLength.value) *length = rules->minLength.value;
+    if (*length < minTotal) *length = minTotal;
+    if (*length > rules->maxLength.value) *length = rules->maxLength.value;
+    return TRUE;
+}
+
+/**
+ * @brief Computes the log2 weight of one composition
+ * @param logFact log2(n!) table
+ * @param logInt log2(n) table (index 0 unused)
+ * @param logSize log2 of each category's alphabet size
+ * @param rules Merged rules (leading restrictions)
+ * @param length Password length
+ * @param k Category counts
+ * @param weight Output: log2 of the number of passwords with this composition
+ * @return FALSE if no password of this composition has an allowed first character
+ */
+static BOOL CompositionWeight(const double* logFact, const double* logInt, const double* logSize,
+                              const PolicyRules* rules, int length, const int* k, double* weight) {
+    int leading = k[0] + (rules->noLeadingDigit ? 0 : k[1]) + (rules->noLeadingSymbol ? 0 : k[2]);
+    if (leading == 0) return FALSE;
+
+    /* Arrangements x character choices x share of arrangements with an allowed lead */
+    *weight = logFact[length] - logFact[k[0]] - logFact[k[1]] - logFact[k[2]]
+            + logInt[leading] - logInt[length];
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        if (k[c] > 0) *weight += k[c] * logSize[c];
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Intersects named policies and compiles a CompositionPlan into the configuration
+ * @param names Comma-separated profile names
+ * @param config Configuration to update
+ * @return TRUE on success, FALSE on missing profile or conflict
+ */
+BOOL IntersectPolicies(const char* names, PasswordConfig* config) {
+    ProfileEntry entries[MAX_INTERSECT_POLICIES];
+    HANDLE hHeap = GetProcessHeap();
+    LARGE_INTEGER freq, start, end;
+    PolicyRules rules;
+    PlanCacheKey key;
+    PlanCacheResult result;
+    char name[MAX_PROFILE_NAME];
+    char msgBuf[128];
+    int policyCount = 0;
+    int length;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    int defaultLength = (config->useLetters ? config->letterLength : 0) +
+                        (config->useNumbers ? config->numberLength : 0) +
+                        (config->useSymbols ? config->symbolLength : 0);
+
+    /* Same profiles and inputs as a cached run: reuse its plan */
+    ZeroMemory(&key, sizeof(key));
+    lstrcpynA(key.names, names, MAX_INTERSECT_NAMES);
+    key.defaultLength = defaultLength;
+    key.flags = (config->useLetters ? PLAN_KEY_LETTERS : 0) | (config->useNumbers ? PLAN_KEY_NUMBERS : 0) |
+                (config->useSymbols ? PLAN_KEY_SYMBOLS : 0) |
+                (config->noLeadingDigit ? PLAN_KEY_NO_LEADING_DIGIT : 0) |
+                (config->noLeadingSymbol ? PLAN_KEY_NO_LEADING_SYMBOL : 0);
+    lstrcpyA(key.symbolSet, config->symbolSet);
+    CompositionPlan* cachedPlan = ProfileCacheFindPlan(&key, &result);
+    if (cachedPlan) {
+        config->useLetters = result.letters > 0;
+        config->useNumbers = result.numbers > 0;
+        config->useSymbols = result.symbols > 0;
+        config->letterLength = result.letters;
+        config->numberLength = result.numbers;
+        config->symbolLength = result.symbols;
+        lstrcpyA(config->symbolSet, result.symbolSet);
+        config->noLeadingDigit = (result.flags & PLAN_KEY_NO_LEADING_DIGIT) != 0;
+        config->noLeadingSymbol = (result.flags & PLAN_KEY_NO_LEADING_SYMBOL) != 0;
+
+        QueryPerformanceCounter(&end);
+        cachedPlan->compileMicros = (DWORD)((end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart);
+        cachedPlan->cached = TRUE;
+        config->plan = cachedPlan;
+        return TRUE;
+    }
+
+    /* Built-in limits; categories already disabled on the command line stay disabled */
+    rules.minLength.value = MIN_PASSWORD_LENGTH;
+    rules.minLength.source = NULL;
+    rules.maxLength.value = MAX_PASSWORD_LENGTH;
+    rules.maxLength.source = NULL;
+    rules.noLeadingDigit = config->noLeadingDigit ? "command line" : NULL;
+    rules.noLeadingSymbol = config->noLeadingSymbol ? "command line" : NULL;
+    lstrcpyA(rules.symbols, config->symbolSet[0] ? config->symbolSet : CHARSET_SYMBOLS);
+    const BOOL enabled[CATEGORY_COUNT] = { config->useLetters, config->useNumbers, config->useSymbols };
+    static const char* const DISABLE_FLAGS[CATEGORY_COUNT] = { "--no-letters", "--no-numbers", "--no-symbols" };
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        rules.minCount[c].value = 0;
+        rules.minCount[c].source = NULL;
+        rules.disabledBy[c] = enabled[c] ? NULL : "command line";
+        rules.disabledKey[c] = DISABLE_FLAGS[c];
+    }
+
+    /* Look up and merge each policy in the list */
+    for (int i = 0; ; i++) {
+        if (names[i] == ',' || names[i] == '\0') {
+            if (i == 0 || names[i - 1] == ',') {
+                ConsoleWrite("[ERROR] Invalid value for --intersect. Expected profile names separated by commas.\r\n");
+                return FALSE;
+            }
+            if (names[i] == '\0') break;
+            continue;
+        }
+
+        int n = 0;
+        while (names[i] != ',' && names[i] != '\0') {
+            /* A longer name would be cut into a different profile's name */
+            if (n == MAX_PROFILE_NAME - 1) {
+                wsprintfA(msgBuf, "[ERROR] Invalid value for --intersect. Profile names are at most %d characters.\r\n",
+                          MAX_PROFILE_NAME - 1);
+                ConsoleWrite(msgBuf);
+                return FALSE;
+            }
+            name[n++] = names[i++];
+        }
+        name[n] = '\0';
+        i--;
+
+        if (policyCount == MAX_INTERSECT_POLICIES) {
+            /* Rule profiles from --profile are compiled as part of the same list */
+            ConsoleWrite("[ERROR] Too many policies for --profile and --intersect.\r\n");
+            return FALSE;
+        }
+        if (!FindProfile(name, &entries[policyCount])) return FALSE;
+        MergePolicy(&rules, &entries[policyCount]);
+        policyCount++;
+    }
+
+    if (!ResolveRules(&rules, defaultLength, &length)) return FALSE;
+
+    /* log2 tables for factorials and small integers */
+    double* logInt = (double*)HeapAlloc(hHeap, 0, 2 * (SIZE_T)(length + 1) * sizeof(double));
+    if (!logInt) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    double* logFact = logInt + length + 1;
+    logInt[0] = 0.0;
+    logFact[0] = 0.0;
+    for (int n = 1; n <= length; n++) {
+        logInt[n] = Log2((double)n);
+        logFact[n] = logFact[n - 1] + logInt[n];
+    }
+
+    double logSize[CATEGORY_COUNT];
+    int lo[CATEGORY_COUNT];
+    int hi[CATEGORY_COUNT];
+    logSize[0] = Log2((double)lstrlenA(CHARSET_LETTERS));
+    logSize[1] = Log2((double)lstrlenA(CHARSET_NUMBERS));
+    logSize[2] = rules.symbols[0] ? Log2((double)lstrlenA(rules.symbols)) : 0.0;
+    for (int c = 0; c < CATEGORY_COUNT; c++) {
+        lo[c] = rules.minCount[c].value;
+        hi[c] = rules.disabledBy[c] ? 0 : length;
+    }
+
+    /* Pass 1: most likely composition; pass 2: surviving entries and their total;
+       pass 3: cumulative thresholds */
+    CompositionPlan* plan = NULL;
+    double maxWeight = 0.0;
+    double total = 0.0;
+    double cumulative = 0.0;
+    int best[CATEGORY_COUNT] = { 0, 0, 0 };
+    int entryCount = 0;
+    for (int pass = 1; pass <= 3; pass++) {
+        int k[CATEGORY_COUNT];
+        for (k[0] = lo[0]; k[0] <= hi[0]; k[0]++) {
+            for (k[1] = lo[1]; k[1] <= hi[1] && k[0] + k[1] <= length; k[1]++) {
+                double weight;
+                k[2] = length - k[0] - k[1];
+                if (k[2] < lo[2] || k[2] > hi[2]) continue;
+                if (!CompositionWeight(logFact, logInt, logSize, &rules, length, k, &weight)) continue;
+
+                if (pass == 1) {
+                    if (entryCount == 0 || weight > maxWeight) {
+                        maxWeight = weight;
+                        best[0] = k[0]; best[1] = k[1]; best[2] = k[2];
+                    }
+                    entryCount = 1;
+                } else if (weight >= maxWeight - PLAN_PRUNE_BITS) {
+                    double share = Exp2(weight - maxWeight);
+                    if (pass == 2) {
+                        total += share;
+                        entryCount++;
+                        continue;
+                    }
+
+                    /* Thresholds that do not advance have zero probability at this resolution */
+                    cumulative += share;
+                    ULONGLONG threshold = (ULONGLONG)(LONGLONG)(cumulative / total * (double)(1LL << PLAN_THRESHOLD_BITS));
+                    if (plan->count > 0 && threshold <= plan->entries[plan->count - 1].threshold) continue;
+                    plan->entries[plan->count].threshold = threshold;
+                    plan->entries[plan->count].letters = (WORD)k[0];
+                    plan->entries[plan->count].numbers = (WORD)k[1];
+                    plan->entries[plan->count].symbols = (WORD)k[2];
+                    plan->count++;
+                }
+            }
+        }
+
+        if (pass == 1) {
+            if (entryCount == 0) {
+                char msgBuf[128];
+                wsprintfA(msgBuf, "[ERROR] Policies conflict: no password of length %d satisfies every rule.\r\n", length);
+                ConsoleWrite(msgBuf);
+                HeapFree(hHeap, 0, logInt);
+                return FALSE;
+            }
+            entryCount = 0;
+        } else if (pass == 2) {
+            plan = (CompositionPlan*)HeapAlloc(hHeap, 0,
+                sizeof(CompositionPlan) + (SIZE_T)(entryCount - 1) * sizeof(CompositionEntry));
+            if (!plan) {
+                PrintError("Memory Error");
+                HeapFree(hHeap, 0, logInt);
+                return FALSE;
+            }
+            plan->count = 0;
+        }
+    }
+    HeapFree(hHeap, 0, logInt);
+
+    /* Rounding must not leave a gap at the top of the range */
+    plan->entries[plan->count - 1].threshold = 1ULL << PLAN_THRESHOLD_BITS;
+    plan->length = length;
+    plan->policies = policyCount;
+    plan->bits = maxWeight + Log2(total);
+    plan->cached = FALSE;
+
+    /* Counts describe the most likely composition; the stream draws the actual one */
+    config->useLetters = best[0] > 0;
+    config->useNumbers = best[1] > 0;
+    config->useSymbols = best[2] > 0;
+    config->letterLength = best[0];
+    config->numberLength = best[1];
+    config->symbolLength = best[2];
+    lstrcpyA(config->symbolSet, rules.symbols);
+    config->noLeadingDigit = rules.noLeadingDigit != NULL;
+    config->noLeadingSymbol = rules.noLeadingSymbol != NULL;
+
+    QueryPerformanceCounter(&end);
+    plan->compileMicros = (DWORD)((end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart);
+    config->plan = plan;
+
+    ZeroMemory(&result, sizeof(result));
+    result.letters = best[0];
+    result.numbers = best[1];
+    result.symbols = best[2];
+    result.flags = (config->noLeadingDigit ? PLAN_KEY_NO_LEADING_DIGIT : 0) |
+                   (config->noLeadingSymbol ? PLAN_KEY_NO_LEADING_SYMBOL : 0);
+    lstrcpyA(result.symbolSet, config->symbolSet);
+    ProfileCacheStorePlan(&key, &result, plan);
+    return TRUE;
+}
+
+/**
+ * @brief Releases a plan created by IntersectPolicies()
+ * @param plan Plan to free
+ */
+void FreeCompositionPlan(const CompositionPlan* plan) {
+    if (plan) HeapFree(GetProcessHeap(), 0, (LPVOID)plan);
+}
@@ -8,6 +8,11 @@
 
 #include "../include/password_gen.h"
 #include "../include/console_io.h"
+#include "../include/batch_gen.h"
+#include "../include/password_stream.h"
+#include "../include/denylist.h"
+#include "../include/seal.h"
+#include "../include/utils.h"
 
 /**
  * @brief Copies generated password to Windows clipboard
@@ -289,4 +294,213 @@ void GenerateAdvanced(int letterCount, int numberCount, int symbolCount,
 
     HeapFree(hHeap, 0, pbBuffer);
     HeapFree(hHeap, 0, passwordString);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Writes one slab of output records to the file or the console
+ * @param hOut Output file, NULL for console output
+ * @param data Records
+ * @param size Bytes to write
+ * @return TRUE on success, FALSE on write failure (error already printed)
+ */
+static BOOL WriteSlab(HANDLE hOut, const char* data, DWORD size) {
+    if (hOut) {
+        DWORD bytesWritten = 0;
+        if (!WriteFile(hOut, data, size, &bytesWritten, NULL) || bytesWritten != size) {
+            PrintError("Write Failed");
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    /* Console output in OUTPUT_CHUNK_SIZE pieces to keep pipe writes bounded */
+    DWORD offset = 0;
+    while (offset < size) {
+        DWORD chunk = size - offset;
+        if (chunk > OUTPUT_CHUNK_SIZE) chunk = OUTPUT_CHUNK_SIZE;
+        ConsoleWriteN(data + offset, (int)chunk);
+        offset += chunk;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Checks that a configuration can produce bulk passwords
+ * @param config Password configuration
+ * @return TRUE if valid, FALSE after printing the reason
+ */
+BOOL ValidateBulkConfig(const PasswordConfig* config) {
+    char msgBuf[128];
+    int totalLength = BatchRecordStride(config) - 2;
+
+    if ((!config->useLetters && !config->useNumbers && !config->useSymbols) ||
+        totalLength < MIN_PASSWORD_LENGTH || totalLength > MAX_PASSWORD_LENGTH) {
+        wsprintfA(msgBuf, "[ERROR] Invalid configuration: enable a category and use %d-%d total characters.\r\n",
+                  MIN_PASSWORD_LENGTH, MAX_PASSWORD_LENGTH);
+        ConsoleWrite(msgBuf);
+        return FALSE;
+    }
+    if (!config->plan && (config->noLeadingDigit || config->noLeadingSymbol) &&
+        !(config->useLetters && config->letterLength > 0) &&
+        (config->noLeadingDigit || !config->useNumbers || config->numberLength == 0) &&
+        (config->noLeadingSymbol || !config->useSymbols || config->symbolLength == 0)) {
+        ConsoleWrite("[ERROR] Invalid configuration: the leading-character rules exclude every category.\r\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Generates config->count passwords, one per line, to console or file
+ * @param config Password configuration
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GenerateMany(const PasswordConfig* config) {
+    HANDLE hHeap = GetProcessHeap();
+    HANDLE hOut = NULL;
+    char msgBuf[224];
+    BatchStats stats;
+    LARGE_INTEGER freq;
+    int stride = BatchRecordStride(config);
+    int totalLength = stride - 2;
+    BOOL success = TRUE;
+
+    if (!ValidateBulkConfig(config)) return FALSE;
+
+    /* Sealed delivery: one password per recipient, in recipient order */
+    RecipientList* recipients = NULL;
+    int count = config->count;
+    if (config->sealPath) {
+        recipients = LoadRecipients(config->sealPath);
+        if (!recipients) return FALSE;
+        count = recipients->count;
+    }
+
+    /* Records are generated and written one slab at a time, so memory use does not grow with count */
+    int slabRecords = BULK_SLAB_BYTES / stride;
+    if (slabRecords > count) slabRecords = count;
+    int outStride = recipients ? SEAL_RECORD_STRIDE(totalLength) : stride;
+    char* buffer = (char*)HeapAlloc(hHeap, 0, (SIZE_T)slabRecords * stride);
+    char* sealed = recipients ? (char*)HeapAlloc(hHeap, 0, (SIZE_T)slabRecords * outStride) : NULL;
+    if (!buffer || (recipients && !sealed)) {
+        PrintError("Memory Error");
+        if (buffer) HeapFree(hHeap, 0, buffer);
+        if (sealed) HeapFree(hHeap, 0, sealed);
+        FreeRecipients(recipients);
+        return FALSE;
+    }
+
+    if (config->outputPath) {
+        hOut = CreateFileW(config->outputPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hOut == INVALID_HANDLE_VALUE) {
+            PrintError("Cannot create output file");
+            HeapFree(hHeap, 0, buffer);
+            if (sealed) HeapFree(hHeap, 0, sealed);
+            FreeRecipients(recipients);
+            return FALSE;
+        }
+    }
+
+    QueryPerformanceFrequency(&freq);
+    LONGLONG generateTicks = 0;
+    LONGLONG sealTicks = 0;
+    SealStats sealStats;
+    int slabs = 0;
+    sealStats.threads = 0;
+    sealStats.batches = 0;
+
+    for (int first = 0; first < count && success; first += slabRecords) {
+        int n = count - first < slabRecords ? count - first : slabRecords;
+        BatchStats slabStats;
+        LARGE_INTEGER start, end;
+
+        QueryPerformanceCounter(&start);
+        BOOL generated = GenerateBatch(config, n, buffer, &slabStats);
+        QueryPerformanceCounter(&end);
+        generateTicks += end.QuadPart - start.QuadPart;
+        if (slabs++ == 0) stats = slabStats;
+        else MergeBatchStats(&stats, &slabStats);
+
+        if (!generated && slabStats.denyExhausted) {
+            /* A damaged table denies everything and has already said so */
+            if (!config->denyList->corrupt) {
+                wsprintfA(msgBuf, "[ERROR] The deny-list rejected %d passwords in a row; this policy is too weak for it.\r\n",
+                          DENY_MAX_RETRIES);
+                ConsoleWrite(msgBuf);
+            }
+            success = FALSE;
+        } else if (!generated) {
+            PrintError("GenRandom Failed");
+            success = FALSE;
+        } else if (recipients) {
+            /* The sealed records replace the plaintext ones as output */
+            RecipientList slabRecipients;
+            SealStats slabSealStats;
+            slabRecipients.count = n;
+            slabRecipients.keys = recipients->keys + (SIZE_T)first * X25519_KEY_SIZE;
+
+            QueryPerformanceCounter(&start);
+            success = SealRecords(buffer, stride, &slabRecipients, sealed, &slabSealStats);
+            QueryPerformanceCounter(&end);
+            sealTicks += end.QuadPart - start.QuadPart;
+            if (slabSealStats.threads > sealStats.threads) sealStats.threads = slabSealStats.threads;
+            sealStats.batches += slabSealStats.batches;
+            if (success) success = WriteSlab(hOut, sealed, (DWORD)n * (DWORD)outStride);
+        } else {
+            success = WriteSlab(hOut, buffer, (DWORD)n * (DWORD)stride);
+        }
+        SecureZeroMemory(buffer, (SIZE_T)n * stride);
+    }
+
+    if (hOut) {
+        CloseHandle(hOut);
+        /* Never leave a partial password file behind */
+        if (!success) DeleteFileW(config->outputPath);
+    }
+
+    if (success && hOut) {
+        wsprintfA(msgBuf, "[INFO] Wrote %d passwords (%d chars each); %d slabs, %d threads, %d chunks, %d-%d per thread, %d reassigned.\r\n",
+                  count, totalLength, slabs, stats.threads, stats.chunks,
+                  stats.minPerThread, stats.maxPerThread, stats.reassigned);
+        ConsoleWrite(msgBuf);
+        LONGLONG micros = generateTicks * 1000000 / freq.QuadPart;
+        wsprintfA(msgBuf, "[INFO] Generated in %lu us (%lu ns per password).\r\n",
+                  (DWORD)micros, (DWORD)(micros * 1000 / count));
+        ConsoleWrite(msgBuf);
+        if (config->plan) {
+            int tenths = (int)(config->plan->bits * 10.0 + 0.5);
+            wsprintfA(msgBuf, "[INFO] Intersection of %d policies: length %d, %d compositions, %d.%d bits, %s in %lu us.\r\n",
+                      config->plan->policies, config->plan->length, config->plan->count,
+                      tenths / 10, tenths % 10, config->plan->cached ? "loaded from cache" : "compiled",
+                      config->plan->compileMicros);
+            ConsoleWrite(msgBuf);
+        }
+        if (stats.drawBound > 0) {
+            wsprintfA(msgBuf, "[INFO] Random draws per password: max %d (bounded at %d).\r\n",
+                      stats.maxDraws, stats.drawBound);
+        } else {
+            wsprintfA(msgBuf, "[INFO] Random draws per password: max %d (rejection sampling, no fixed bound).\r\n",
+                      stats.maxDraws);
+        }
+        ConsoleWrite(msgBuf);
+        if (config->denyList) {
+            char entries[24];
+            FormatULongLong(entries, config->denyList->header->count);
+            wsprintfA(msgBuf, "[INFO] Deny-list: %s entries, %d passwords regenerated.\r\n", entries, stats.denied);
+            ConsoleWrite(msgBuf);
+        }
+        if (recipients) {
+            if (sealTicks < 1) sealTicks = 1;
+            wsprintfA(msgBuf, "[INFO] Sealed to %d recipients with %d threads in %lu ms (%lu seals/s, %d key agreements per inversion).\r\n",
+                      count, sealStats.threads, (DWORD)(sealTicks * 1000 / freq.QuadPart),
+                      (DWORD)((LONGLONG)count * freq.QuadPart / sealTicks), 2 * SEAL_BATCH);
+            ConsoleWrite(msgBuf);
+        }
+    }
+
+    SecureZeroMemory(buffer, (SIZE_T)slabRecords * stride);
+    HeapFree(hHeap, 0, buffer);
+    if (sealed) HeapFree(hHeap, 0, sealed);
+    FreeRecipients(recipients);
+    return success;
+}
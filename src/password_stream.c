@@ -0,0 +1,394 @@
+/**
+ * @file password_stream.c
+ * @brief Streaming password generation implementation
+ * @details Generates passwords from a pool of random bytes that is refilled in
+ *          STREAM_POOL_SIZE batches, instead of calling CryptGenRandom for every
+ *          password and every shuffle step. With asyncRefill, a helper thread
+ *          fills a second pool while the first is consumed. This file and charset.c form the
+ *          generation core; with WINPASS_FREESTANDING defined they use no heap,
+ *          no CryptoAPI and no Win32 imports.
+ */
+
+#include "../include/password_stream.h"
+
+/**
+ * @brief Refills the random pool from the stream's random source
+ * @param stream Stream whose pool is refilled
+ * @return TRUE on success, FALSE if the random source failed
+ */
+static BOOL StreamRefill(PasswordStream* stream) {
+#ifndef WINPASS_FREESTANDING
+    if (stream->hRefillThread) {
+        /* Usually already signalled: the spare was filled while this pool was consumed */
+        WaitForSingleObject(stream->hRefillDone, INFINITE);
+        if (stream->refillFailed) return FALSE;
+
+        BYTE* full = stream->spare;
+        stream->spare = stream->active;
+        stream->active = full;
+        stream->poolPos = 0;
+        stream->refills++;
+        SetEvent(stream->hRefillWanted);
+        return TRUE;
+    }
+#endif
+    if (!stream->randomFill(stream->randomContext, stream->active, STREAM_POOL_SIZE)) {
+        return FALSE;
+    }
+    stream->poolPos = 0;
+    stream->refills++;
+    return TRUE;
+}
+
+#ifndef WINPASS_FREESTANDING
+/**
+ * @brief Helper thread of an async stream: fills the spare buffer on request
+ * @param param The PasswordStream
+ * @return 0
+ */
+static DWORD WINAPI StreamRefillProc(LPVOID param) {
+    PasswordStream* stream = (PasswordStream*)param;
+
+    for (;;) {
+        WaitForSingleObject(stream->hRefillWanted, INFINITE);
+        if (stream->refillStop) break;
+        stream->refillFailed = !stream->randomFill(stream->randomContext, stream->spare, STREAM_POOL_SIZE);
+        SetEvent(stream->hRefillDone);
+    }
+    return 0;
+}
+
+/**
+ * @brief Starts the refill helper thread of a stream opened with asyncRefill
+ * @param stream Stream whose active pool was just filled
+ * @return TRUE on success, FALSE if the spare pool, an event or the thread
+ *         could not be created (the spare pool is then released by StreamClose)
+ * @details hRefillWanted starts signalled, so the helper fills the spare pool
+ *          right away.
+ */
+static BOOL StreamStartRefillThread(PasswordStream* stream) {
+    stream->spareBuffer = (BYTE*)HeapAlloc(GetProcessHeap(), 0, STREAM_POOL_SIZE);
+    if (!stream->spareBuffer) return FALSE;
+    stream->spare = stream->spareBuffer;
+    stream->refillStop = 0;
+    stream->refillFailed = FALSE;
+    stream->hRefillWanted = CreateEventA(NULL, FALSE, TRUE, NULL);
+    stream->hRefillDone = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (stream->hRefillWanted && stream->hRefillDone) {
+        stream->hRefillThread = CreateThread(NULL, 0, StreamRefillProc, stream, 0, NULL);
+    }
+    if (stream->hRefillThread) return TRUE;
+
+    if (stream->hRefillWanted) CloseHandle(stream->hRefillWanted);
+    if (stream->hRefillDone) CloseHandle(stream->hRefillDone);
+    return FALSE;
+}
+#endif
+
+/**
+ * @brief Draws a value in [0, range) from 64 pool bits without rejection
+ * @param stream Open stream
+ * @param range Number of possible values (must be > 0)
+ * @param value Output for the random value
+ * @return TRUE on success, FALSE if the pool could not be refilled
+ * @details Computes floor(x * range / 2^64) for a uniform 64-bit x. Each result
+ *          occurs for floor(2^64 / range) or one more values of x, so its
+ *          probability is off by less than 2^-64 (relative error below 2^-54
+ *          for the largest range here, MAX_PASSWORD_LENGTH). The 64x32 multiply
+ *          is split into two 32x32 products so no 128-bit type or runtime helper
+ *          is needed.
+ */
+static BOOL StreamBoundedBelow(PasswordStream* stream, DWORD range, DWORD* value) {
+    if (stream->poolPos + 8 > STREAM_POOL_SIZE) {
+        if (!StreamRefill(stream)) return FALSE;
+    }
+    BYTE* p = stream->active + stream->poolPos;
+    DWORD lo = (DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24);
+    DWORD hi = (DWORD)p[4] | ((DWORD)p[5] << 8) | ((DWORD)p[6] << 16) | ((DWORD)p[7] << 24);
+    stream->poolPos += 8;
+    stream->draws++;
+
+    /* (hi * 2^32 + lo) * range >> 64, carrying the low product into the high one */
+    ULONGLONG high = (ULONGLONG)hi * range + (((ULONGLONG)lo * range) >> 32);
+    *value = (DWORD)(high >> 32);
+    return TRUE;
+}
+
+/**
+ * @brief Draws a uniform random value in [0, range) from the pool
+ * @param stream Open stream
+ * @param range Number of possible values (must be > 0)
+ * @param value Output for the random value
+ * @return TRUE on success, FALSE if the pool could not be refilled
+ * @details Same Rejection Sampling threshold as ShufflePassword(), but the DWORDs
+ *          come from the batched pool instead of individual CryptGenRandom calls.
+ *          Bounded streams use StreamBoundedBelow() instead.
+ */
+static BOOL StreamRandomBelow(PasswordStream* stream, DWORD range, DWORD* value) {
+    DWORD dwThreshold = MAXDWORD - (MAXDWORD % range);
+    DWORD dwRandomValue;
+
+    if (stream->config.bounded) return StreamBoundedBelow(stream, range, value);
+
+    do {
+        if (stream->poolPos + (int)sizeof(DWORD) > STREAM_POOL_SIZE) {
+            if (!StreamRefill(stream)) return FALSE;
+        }
+        BYTE* p = stream->active + stream->poolPos;
+        dwRandomValue = (DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24);
+        stream->poolPos += sizeof(DWORD);
+        stream->draws++;
+    } while (dwRandomValue >= dwThreshold);
+
+    *value = dwRandomValue % range;
+    return TRUE;
+}
+
+/**
+ * @brief Appends count characters picked uniformly from charset
+ * @param stream Open stream
+ * @param pos Current write position in the password buffer (advanced on return)
+ * @param charset Character set to pick from
+ * @param count Number of characters to append
+ * @return TRUE on success, FALSE on random failure
+ */
+static BOOL StreamAppendFrom(PasswordStream* stream, int* pos, const char* charset, int count) {
+    DWORD charsetLen = 0;
+    DWORD index;
+
+    /* Counted inline rather than with lstrlenA so the core needs no Win32 imports */
+    while (charset[charsetLen] != '\0') charsetLen++;
+
+    for (int i = 0; i < count; i++) {
+        if (!StreamRandomBelow(stream, charsetLen, &index)) return FALSE;
+        stream->password[(*pos)++] = charset[index];
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Copies the configuration into the stream and validates it
+ * @param stream Stream state to initialize
+ * @param config Password configuration
+ * @return TRUE if at least one category is enabled and the length is in range
+ */
+static BOOL StreamSetConfig(PasswordStream* stream, const PasswordConfig* config) {
+    stream->config = *config;
+    stream->active = stream->pool;
+    stream->draws = 0;
+    stream->maxDraws = 0;
+    stream->refills = 0;
+    stream->symbols = stream->config.symbolSet[0] != '\0' ? stream->config.symbolSet : CHARSET_SYMBOLS;
+
+    if (!config->useLetters && !config->useNumbers && !config->useSymbols) return FALSE;
+#ifdef WINPASS_FREESTANDING
+    if (config->asyncRefill) return FALSE;
+#endif
+
+    /* Calculate total password length from enabled categories */
+    int letters = config->useLetters ? config->letterLength : 0;
+    int numbers = config->useNumbers ? config->numberLength : 0;
+    int symbols = config->useSymbols ? config->symbolLength : 0;
+    stream->length = letters + numbers + symbols;
+
+    if (config->plan) return config->plan->count > 0 && config->plan->length == stream->length;
+
+    /* A leading-character rule needs at least one allowed first character */
+    if (letters + (config->noLeadingDigit ? 0 : numbers) + (config->noLeadingSymbol ? 0 : symbols) == 0) return FALSE;
+
+    return stream->length >= MIN_PASSWORD_LENGTH && stream->length <= MAX_PASSWORD_LENGTH;
+}
+
+/**
+ * @brief Draws the category counts of the next password from the plan
+ * @param stream Open stream with a plan
+ * @param counts Output: letters, numbers, symbols
+ * @return TRUE on success, FALSE on random failure
+ * @details Takes PLAN_THRESHOLD_BITS pool bits and binary-searches the first
+ *          entry whose threshold exceeds them, so the cost is bounded by
+ *          log2(count) steps and one draw.
+ */
+static BOOL StreamPickComposition(PasswordStream* stream, int* counts) {
+    const CompositionPlan* plan = stream->config.plan;
+    ULONGLONG x = 0;
+
+    if (stream->poolPos + 8 > STREAM_POOL_SIZE) {
+        if (!StreamRefill(stream)) return FALSE;
+    }
+    for (int i = 0; i < 8; i++) x = (x << 8) | stream->active[stream->poolPos + i];
+    stream->poolPos += 8;
+    stream->draws++;
+    x >>= 64 - PLAN_THRESHOLD_BITS;
+
+    int lo = 0;
+    int hi = plan->count - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (x < plan->entries[mid].threshold) hi = mid;
+        else lo = mid + 1;
+    }
+    counts[0] = plan->entries[lo].letters;
+    counts[1] = plan->entries[lo].numbers;
+    counts[2] = plan->entries[lo].symbols;
+    return TRUE;
+}
+
+#ifndef WINPASS_FREESTANDING
+/**
+ * @brief RandomFillProc backed by the stream's own CryptoAPI context
+ * @param context The PasswordStream owning the context
+ * @param buffer Buffer to fill
+ * @param length Number of bytes
+ * @return Result of CryptGenRandom
+ */
+static BOOL CryptoApiFill(void* context, BYTE* buffer, DWORD length) {
+    return CryptGenRandom(((PasswordStream*)context)->hCryptProv, length, buffer);
+}
+
+/**
+ * @brief Opens a stream for the given configuration using CryptoAPI
+ * @param stream Stream state to initialize
+ * @param config Password configuration
+ * @return TRUE on success, FALSE on invalid configuration or CryptoAPI failure
+ */
+BOOL StreamOpen(PasswordStream* stream, const PasswordConfig* config) {
+    stream->hCryptProv = 0;
+    stream->hRefillThread = NULL;
+    stream->spareBuffer = NULL;
+    if (!StreamSetConfig(stream, config)) return FALSE;
+
+    if (!CryptAcquireContext(&stream->hCryptProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+        stream->hCryptProv = 0;
+        return FALSE;
+    }
+
+    stream->randomFill = CryptoApiFill;
+    stream->randomContext = stream;
+
+    /* First refill happens here so StreamNext() never pays the context setup */
+    if (!StreamRefill(stream) || (config->asyncRefill && !StreamStartRefillThread(stream))) {
+        StreamClose(stream);
+        return FALSE;
+    }
+    return TRUE;
+}
+#endif
+
+/**
+ * @brief Opens a stream that draws randomness from a caller-provided source
+ * @param stream Stream state to initialize
+ * @param config Password configuration
+ * @param randomFill Random source
+ * @param context Context for randomFill
+ * @return TRUE on success, FALSE on invalid configuration or random failure
+ */
+BOOL StreamOpenWithSource(PasswordStream* stream, const PasswordConfig* config,
+                          RandomFillProc randomFill, void* context) {
+#ifndef WINPASS_FREESTANDING
+    stream->hCryptProv = 0;
+    stream->hRefillThread = NULL;
+    stream->spareBuffer = NULL;
+#endif
+    if (!randomFill || !StreamSetConfig(stream, config)) return FALSE;
+
+    stream->randomFill = randomFill;
+    stream->randomContext = context;
+
+    if (!StreamRefill(stream)) {
+        StreamClose(stream);
+        return FALSE;
+    }
+#ifndef WINPASS_FREESTANDING
+    if (config->asyncRefill && !StreamStartRefillThread(stream)) {
+        StreamClose(stream);
+        return FALSE;
+    }
+#endif
+    return TRUE;
+}
+
+/**
+ * @brief Generates the next password of the stream
+ * @param stream Open stream
+ * @param length Optional output for the password length
+ * @return Pointer to the password inside the stream, NULL on failure
+ */
+const char* StreamNext(PasswordStream* stream, int* length) {
+    const PasswordConfig* config = &stream->config;
+    int counts[3];
+    int pos = 0;
+    int first = 0;
+
+    stream->draws = 0;
+
+    counts[0] = config->useLetters ? config->letterLength : 0;
+    counts[1] = config->useNumbers ? config->numberLength : 0;
+    counts[2] = config->useSymbols ? config->symbolLength : 0;
+    if (config->plan && !StreamPickComposition(stream, counts)) return NULL;
+
+    /* Phase 1: assemble categories in order [letters][numbers][symbols] */
+    if (!StreamAppendFrom(stream, &pos, CHARSET_LETTERS, counts[0])) return NULL;
+    if (!StreamAppendFrom(stream, &pos, CHARSET_NUMBERS, counts[1])) return NULL;
+    if (!StreamAppendFrom(stream, &pos, stream->symbols, counts[2])) return NULL;
+    stream->password[pos] = '\0';
+
+    /* Leading rule: move a uniformly chosen allowed character to the front */
+    if (config->noLeadingDigit || config->noLeadingSymbol) {
+        int skipDigits = config->noLeadingDigit ? counts[1] : 0;
+        DWORD k;
+        if (!StreamRandomBelow(stream, (DWORD)(pos - skipDigits - (config->noLeadingSymbol ? counts[2] : 0)), &k)) return NULL;
+
+        /* Allowed positions are the letters, then digits and symbols unless excluded */
+        if ((int)k >= counts[0]) k += skipDigits;
+        char temp = stream->password[0];
+        stream->password[0] = stream->password[k];
+        stream->password[k] = temp;
+        first = 1;
+    }
+
+    /* Phase 2: Fisher-Yates shuffle to hide the category ordering */
+    for (int i = pos - 1; i > first; i--) {
+        DWORD j;
+        if (!StreamRandomBelow(stream, (DWORD)(i + 1 - first), &j)) return NULL;
+        j += first;
+
+        char temp = stream->password[i];
+        stream->password[i] = stream->password[j];
+        stream->password[j] = temp;
+    }
+
+    if (stream->draws > stream->maxDraws) stream->maxDraws = stream->draws;
+    if (length) *length = pos;
+    return stream->password;
+}
+
+/**
+ * @brief Closes the stream and wipes its buffers
+ * @param stream Stream to close
+ */
+void StreamClose(PasswordStream* stream) {
+#ifndef WINPASS_FREESTANDING
+    if (stream->hRefillThread) {
+        stream->refillStop = 1;
+        SetEvent(stream->hRefillWanted);
+        WaitForSingleObject(stream->hRefillThread, INFINITE);
+        CloseHandle(stream->hRefillThread);
+        CloseHandle(stream->hRefillWanted);
+        CloseHandle(stream->hRefillDone);
+        stream->hRefillThread = NULL;
+    }
+    if (stream->hCryptProv) {
+        CryptReleaseContext(stream->hCryptProv, 0);
+        stream->hCryptProv = 0;
+    }
+#endif
+    SecureZeroMemory(stream->pool, sizeof(stream->pool));
+#ifndef WINPASS_FREESTANDING
+    if (stream->spareBuffer) {
+        SecureZeroMemory(stream->spareBuffer, STREAM_POOL_SIZE);
+        HeapFree(GetProcessHeap(), 0, stream->spareBuffer);
+        stream->spareBuffer = NULL;
+    }
+#endif
+    SecureZeroMemory(stream->password, sizeof(stream->password));
+}
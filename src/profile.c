@@ -0,0 +1,423 @@
+/**
+ * @file profile.c
+ * @brief Named password profile implementation
+ * @details Reads profile sections with GetPrivateProfileIntA so the file format is
+ *          plain INI and can be edited with any text editor. Long-running modes
+ *          publish all profiles as an immutable snapshot instead: the one reader
+ *          thread loads the current pointer without locking, a reload swaps in a
+ *          new snapshot, and the replaced one is freed once that reader reports a
+ *          quiescent point. Reclamation is single-reader by design; a second
+ *          reader thread would need its own quiescent points tracked.
+ */
+
+#include "../include/profile.h"
+#include "../include/profile_cache.h"
+#include "../include/console_io.h"
+#include "../include/server.h"
+#include "../include/strength.h"
+
+/**
+ * @brief Builds the full path of the profile file
+ * @param path Output buffer
+ * @param maxLen Size of the output buffer
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL GetProfilePath(char* path, int maxLen) {
+    DWORD len = GetModuleFileNameA(NULL, path, (DWORD)maxLen);
+    if (len == 0 || len >= (DWORD)maxLen) return FALSE;
+
+    /* Strip the executable name, keeping the trailing backslash */
+    int dirLen = (int)len;
+    while (dirLen > 0 && path[dirLen - 1] != '\\' && path[dirLen - 1] != '/') dirLen--;
+
+    if (dirLen + lstrlenA(PROFILE_FILE_NAME) + 1 > maxLen) return FALSE;
+    lstrcpyA(path + dirLen, PROFILE_FILE_NAME);
+    return TRUE;
+}
+
+/**
+ * @brief Builds the path of a file in the per-user data directory
+ * @param fileName File name
+ * @param path Output buffer
+ * @param maxLen Size of the output buffer
+ * @return TRUE on success, FALSE if the directory is unknown or cannot be created
+ */
+BOOL GetUserDataPath(const char* fileName, char* path, int maxLen) {
+    DWORD len = GetEnvironmentVariableA("LOCALAPPDATA", path, (DWORD)maxLen);
+    if (len == 0 || len >= (DWORD)maxLen) return FALSE;
+    if ((int)len + lstrlenA(USER_DATA_DIR_NAME) + lstrlenA(fileName) + 3 > maxLen) return FALSE;
+
+    lstrcatA(path, "\\" USER_DATA_DIR_NAME);
+    if (!CreateDirectoryA(path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS) return FALSE;
+    lstrcatA(path, "\\");
+    lstrcatA(path, fileName);
+    return TRUE;
+}
+
+/**
+ * @brief Compiled registry published to readers
+ * @details Immutable once published. Replaced snapshots are linked through
+ *          retiredNext until the reader passes a quiescent point.
+ */
+struct ProfileSnapshot {
+    struct ProfileSnapshot* retiredNext;  /**< Next snapshot waiting to be freed */
+    DWORD version;                        /**< Reload counter */
+    int count;                            /**< Number of entries */
+    ProfileEntry* entries;                /**< Profiles, from ReadProfiles() */
+};
+
+static ProfileSnapshot* volatile g_currentSnapshot = NULL;  /**< Published registry, NULL if not in use */
+static ProfileSnapshot* volatile g_retiredSnapshots = NULL; /**< Replaced snapshots not yet freed */
+static volatile LONG g_snapshotVersion = 0;                 /**< Last published version */
+
+/**
+ * @brief Reads one key and validates its range
+ * @param name Profile name
+ * @param key INI key
+ * @param path Profile file path
+ * @param minValue Smallest accepted value
+ * @param maxValue Largest accepted value
+ * @param report TRUE to print an error for an out-of-range value
+ * @param value Output: the value, or -1 if the key is absent
+ * @return TRUE if the key is absent or valid, FALSE if out of range
+ */
+static BOOL ReadProfileKey(const char* name, const char* key, const char* path,
+                           int minValue, int maxValue, BOOL report, int* value) {
+    char msgBuf[192];
+    int val = (int)GetPrivateProfileIntA(name, key, -1, path);
+
+    *value = -1;
+    if (val == -1) return TRUE;  /* Key not present: keep current value */
+    if (val < minValue || val > maxValue) {
+        if (!report) return FALSE;
+        wsprintfA(msgBuf, "[ERROR] Profile '%s': %s must be between %d and %d.\r\n",
+                  name, key, minValue, maxValue);
+        ConsoleWrite(msgBuf);
+        return FALSE;
+    }
+    *value = val;
+    return TRUE;
+}
+
+/**
+ * @brief Reads and validates one profile section from the file
+ * @param name Profile name
+ * @param path Profile file path
+ * @param report TRUE to print an error if the section is missing or invalid
+ * @param entry Output entry
+ * @return TRUE if the section exists and is valid, FALSE otherwise
+ */
+static BOOL ReadProfileEntry(const char* name, const char* path, BOOL report, ProfileEntry* entry) {
+    char keys[16];
+    char msgBuf[MAX_PATH + 128];
+
+    /* A NULL key name lists the section's keys; zero bytes means no such section */
+    if (GetPrivateProfileStringA(name, NULL, "", keys, sizeof(keys), path) == 0) {
+        if (!report) return FALSE;
+        wsprintfA(msgBuf, "[ERROR] Profile '%s' not found in %s\r\n", name, path);
+        ConsoleWrite(msgBuf);
+        return FALSE;
+    }
+
+    lstrcpynA(entry->name, name, MAX_PROFILE_NAME);
+    if (!ReadProfileKey(name, "Letters", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->letters) ||
+        !ReadProfileKey(name, "Numbers", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->numbers) ||
+        !ReadProfileKey(name, "Symbols", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->symbols) ||
+        !ReadProfileKey(name, "Count", path, 1, MAX_INT_PARSE_VALUE, report, &entry->count) ||
+        !ReadProfileKey(name, "MinLength", path, MIN_PASSWORD_LENGTH, MAX_PASSWORD_LENGTH, report, &entry->minLength) ||
+        !ReadProfileKey(name, "MaxLength", path, MIN_PASSWORD_LENGTH, MAX_PASSWORD_LENGTH, report, &entry->maxLength) ||
+        !ReadProfileKey(name, "MinLetters", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->minLetters) ||
+        !ReadProfileKey(name, "MinNumbers", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->minNumbers) ||
+        !ReadProfileKey(name, "MinSymbols", path, 0, MAX_CATEGORY_LENGTH - 1, report, &entry->minSymbols) ||
+        !ReadProfileKey(name, "NoLeadingDigit", path, 0, 1, report, &entry->noLeadingDigit) ||
+        !ReadProfileKey(name, "NoLeadingSymbol", path, 0, 1, report, &entry->noLeadingSymbol)) {
+        return FALSE;
+    }
+
+    /* AllowedSymbols must be a non-empty subset of CHARSET_SYMBOLS (Symbols=0 disables them).
+       Each symbol counts once in the alphabet size, so a repeated one is an error; a value
+       too long for the buffer always repeats one, so truncation is caught here too. */
+    GetPrivateProfileStringA(name, "AllowedSymbols", "", entry->allowedSymbols, MAX_SYMBOL_SET, path);
+    for (int i = 0; entry->allowedSymbols[i] != '\0'; i++) {
+        BOOL known = FALSE;
+        for (int j = 0; CHARSET_SYMBOLS[j] != '\0'; j++) {
+            if (CHARSET_SYMBOLS[j] == entry->allowedSymbols[i]) known = TRUE;
+        }
+        if (!known) {
+            if (!report) return FALSE;
+            wsprintfA(msgBuf, "[ERROR] Profile '%s': AllowedSymbols may only contain %s\r\n", name, CHARSET_SYMBOLS);
+            ConsoleWrite(msgBuf);
+            return FALSE;
+        }
+        for (int j = 0; j < i; j++) {
+            if (entry->allowedSymbols[j] != entry->allowedSymbols[i]) continue;
+            if (!report) return FALSE;
+            wsprintfA(msgBuf, "[ERROR] Profile '%s': AllowedSymbols lists '%c' more than once.\r\n",
+                      name, entry->allowedSymbols[i]);
+            ConsoleWrite(msgBuf);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Applies a profile entry on top of a configuration
+ * @param entry Profile values (-1 = keep)
+ * @param config Configuration to update
+ */
+static void ApplyProfileEntry(const ProfileEntry* entry, PasswordConfig* config) {
+    /* A zero length disables the category, matching --no-<category> */
+    if (entry->letters != -1) {
+        config->useLetters = (entry->letters > 0);
+        config->letterLength = entry->letters;
+    }
+    if (entry->numbers != -1) {
+        config->useNumbers = (entry->numbers > 0);
+        config->numberLength = entry->numbers;
+    }
+    if (entry->symbols != -1) {
+        config->useSymbols = (entry->symbols > 0);
+        config->symbolLength = entry->symbols;
+    }
+    if (entry->count != -1) config->count = entry->count;
+    if (entry->allowedSymbols[0] != '\0') lstrcpyA(config->symbolSet, entry->allowedSymbols);
+    if (entry->noLeadingDigit != -1) config->noLeadingDigit = entry->noLeadingDigit;
+    if (entry->noLeadingSymbol != -1) config->noLeadingSymbol = entry->noLeadingSymbol;
+}
+
+/**
+ * @brief Looks up a profile by name
+ * @param name Profile name
+ * @param entry Output entry
+ * @return TRUE on success, FALSE if missing or invalid
+ */
+BOOL FindProfile(const char* name, ProfileEntry* entry) {
+    char path[MAX_PATH];
+    char msgBuf[MAX_PROFILE_NAME + 64];
+
+    /* Registry published: lock-free lookup in the current snapshot */
+    ProfileSnapshot* snapshot = (ProfileSnapshot*)InterlockedCompareExchangePointer(
+        (PVOID volatile*)&g_currentSnapshot, NULL, NULL);
+    if (snapshot) {
+        for (int i = 0; i < snapshot->count; i++) {
+            if (lstrcmpiA(snapshot->entries[i].name, name) == 0) {
+                *entry = snapshot->entries[i];
+                return TRUE;
+            }
+        }
+        wsprintfA(msgBuf, "[ERROR] Profile '%s' not found.\r\n", name);
+        ConsoleWrite(msgBuf);
+        return FALSE;
+    }
+
+    /* Compiled cache: one mapped copy instead of a dozen INI reads */
+    if (ProfileCacheFind(name, entry)) return TRUE;
+
+    /* Missing or invalid profiles are read from the file to report why */
+    if (!GetProfilePath(path, sizeof(path))) {
+        PrintError("Cannot locate profile file");
+        return FALSE;
+    }
+    return ReadProfileEntry(name, path, TRUE, entry);
+}
+
+/**
+ * @brief Applies a named profile on top of an existing configuration
+ * @param name Profile name
+ * @param config Configuration to update
+ * @param hasRules Output: TRUE if the profile sets a rule key
+ * @return TRUE on success, FALSE if missing or invalid
+ */
+BOOL LoadProfile(const char* name, PasswordConfig* config, BOOL* hasRules) {
+    ProfileEntry entry;
+
+    if (!FindProfile(name, &entry)) return FALSE;
+
+    ApplyProfileEntry(&entry, config);
+    *hasRules = ProfileHasRules(&entry);
+    return TRUE;
+}
+
+/**
+ * @brief Checks whether a profile sets a rule key
+ * @param entry Profile values
+ * @return TRUE if MinLength, MaxLength or a Min<Category> key is set
+ */
+BOOL ProfileHasRules(const ProfileEntry* entry) {
+    return entry->minLength >= 0 || entry->maxLength >= 0 || entry->minLetters >= 0 ||
+           entry->minNumbers >= 0 || entry->minSymbols >= 0;
+}
+
+/**
+ * @brief Checks whether an INI section holds settings rather than a profile
+ * @param section Section name
+ * @return TRUE for [Calibration] and [Tenant.*] sections, in any letter case
+ * @details Section names are case-insensitive to the private profile API, so
+ *          the prefix is compared the same way.
+ */
+static BOOL IsReservedSection(const char* section) {
+    char prefix[sizeof(SERVE_TENANT_PREFIX)];
+
+    if (lstrcmpiA(section, CALIBRATION_SECTION) == 0) return TRUE;
+    lstrcpynA(prefix, section, sizeof(prefix));
+    return lstrcmpiA(prefix, SERVE_TENANT_PREFIX) == 0;
+}
+
+/**
+ * @brief Reads the section names of the profile file
+ * @param path Profile file path
+ * @param namesLen Output: bytes of names, excluding the final null
+ * @return Double-null-terminated list to release with HeapFree(), NULL on failure
+ * @details Grows the buffer while the API reports truncation (size - 2 bytes).
+ */
+static char* ReadSectionNames(const char* path, DWORD* namesLen) {
+    HANDLE hHeap = GetProcessHeap();
+    DWORD size = PROFILE_SECTIONS_SIZE;
+
+    for (;;) {
+        char* names = (char*)HeapAlloc(hHeap, 0, size);
+        if (!names) return NULL;
+        *namesLen = GetPrivateProfileSectionNamesA(names, size, path);
+        if (*namesLen != size - 2) return names;
+        HeapFree(hHeap, 0, names);
+        if (size >= 0x40000000) return NULL;
+        size *= 2;
+    }
+}
+
+/**
+ * @brief Reads the profiles of every non-reserved section
+ * @param path Profile file path
+ * @param strict TRUE to report and fail on the first invalid profile,
+ *        FALSE to leave invalid profiles out
+ * @param count Output: number of entries
+ * @return Entries to release with HeapFree(), NULL on failure
+ */
+static ProfileEntry* ReadProfiles(const char* path, BOOL strict, int* count) {
+    HANDLE hHeap = GetProcessHeap();
+    DWORD namesLen;
+    int sections = 0;
+
+    char* names = ReadSectionNames(path, &namesLen);
+    if (!names) return NULL;
+    for (DWORD i = 0; i < namesLen; i += lstrlenA(names + i) + 1) sections++;
+
+    ProfileEntry* entries = (ProfileEntry*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, (SIZE_T)(sections > 0 ? sections : 1) * sizeof(ProfileEntry));
+    if (!entries) {
+        HeapFree(hHeap, 0, names);
+        return NULL;
+    }
+
+    *count = 0;
+    for (DWORD i = 0; i < namesLen; i += lstrlenA(names + i) + 1) {
+        if (IsReservedSection(names + i)) continue;
+        if (!strict && lstrlenA(names + i) >= MAX_PROFILE_NAME) continue;
+        if (ReadProfileEntry(names + i, path, strict, &entries[*count])) {
+            (*count)++;
+        } else if (strict) {
+            HeapFree(hHeap, 0, entries);
+            entries = NULL;
+            break;
+        }
+    }
+    HeapFree(hHeap, 0, names);
+    return entries;
+}
+
+/**
+ * @brief Reads every valid profile from the file
+ * @param path Profile file path
+ * @param count Output: number of entries
+ * @return Entries to release with HeapFree(), NULL on failure
+ * @details Invalid sections are left out; looking one up reads the file and reports it.
+ */
+ProfileEntry* ReadAllProfiles(const char* path, int* count) {
+    return ReadProfiles(path, FALSE, count);
+}
+
+/**
+ * @brief Reads every profile from the file and publishes a new snapshot
+ * @return TRUE if published, FALSE if the file is invalid (old snapshot stays active)
+ * @details Safe to call from several threads at once (the serving thread on
+ *          RELOAD and the console control thread on Ctrl+Break): every call
+ *          reads into its own heap buffers and only the publication is shared.
+ */
+BOOL ProfileRegistryLoad(void) {
+    char path[MAX_PATH];
+    char msgBuf[128];
+    HANDLE hHeap = GetProcessHeap();
+    LARGE_INTEGER freq, start, end;
+    int count;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+
+    if (!GetProfilePath(path, sizeof(path))) {
+        PrintError("Cannot locate profile file");
+        return FALSE;
+    }
+
+    ProfileSnapshot* snapshot = (ProfileSnapshot*)HeapAlloc(hHeap, 0, sizeof(ProfileSnapshot));
+    if (!snapshot) {
+        PrintError("Memory Error");
+        return FALSE;
+    }
+    snapshot->entries = ReadProfiles(path, TRUE, &count);
+    if (!snapshot->entries) {
+        HeapFree(hHeap, 0, snapshot);
+        return FALSE;
+    }
+    snapshot->count = count;
+    snapshot->version = (DWORD)InterlockedIncrement(&g_snapshotVersion);
+
+    /* Publish, then retire the previous snapshot with a lock-free push */
+    ProfileSnapshot* old = (ProfileSnapshot*)InterlockedExchangePointer(
+        (PVOID volatile*)&g_currentSnapshot, snapshot);
+    if (old) {
+        ProfileSnapshot* head;
+        do {
+            head = g_retiredSnapshots;
+            old->retiredNext = head;
+        } while (InterlockedCompareExchangePointer((PVOID volatile*)&g_retiredSnapshots, old, head) != head);
+    }
+
+    QueryPerformanceCounter(&end);
+    wsprintfA(msgBuf, "[INFO] Loaded %d profiles (version %lu) in %lu us\r\n", snapshot->count,
+              snapshot->version, (DWORD)((end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart));
+    ConsoleWrite(msgBuf);
+    return TRUE;
+}
+
+/**
+ * @brief Frees a snapshot and its entries
+ * @param snapshot Snapshot no reader can still hold
+ */
+static void FreeSnapshot(ProfileSnapshot* snapshot) {
+    HeapFree(GetProcessHeap(), 0, snapshot->entries);
+    HeapFree(GetProcessHeap(), 0, snapshot);
+}
+
+/**
+ * @brief Frees snapshots that were replaced before this quiescent point
+ */
+void ProfileRegistryQuiesce(void) {
+    ProfileSnapshot* retired = (ProfileSnapshot*)InterlockedExchangePointer(
+        (PVOID volatile*)&g_retiredSnapshots, NULL);
+
+    while (retired) {
+        ProfileSnapshot* next = retired->retiredNext;
+        FreeSnapshot(retired);
+        retired = next;
+    }
+}
+
+/**
+ * @brief Unpublishes the registry and frees every snapshot
+ */
+void ProfileRegistryShutdown(void) {
+    ProfileSnapshot* current = (ProfileSnapshot*)InterlockedExchangePointer(
+        (PVOID volatile*)&g_currentSnapshot, NULL);
+    if (current) FreeSnapshot(current);
+    ProfileRegistryQuiesce();
+}
@@ -0,0 +1,397 @@
+/**
+ * @file profile_cache.c
+ * @brief Profile cache implementation
+ * @details The cache is opened at most once per process, on the first lookup.
+ *          A valid file stays mapped read-only; a rebuilt or extended cache is
+ *          served from the heap copy that was written. Lookups run while the
+ *          command line is parsed, on one thread.
+ */
+
+#include "../include/profile_cache.h"
+
+#define CACHE_ALIGN(size) (((size) + 7) & ~(DWORD)7)  /**< Records start on 8-byte boundaries */
+
+/**
+ * @brief One cached intersection plan
+ * @details The plan's entries extend past the end of the structure.
+ */
+typedef struct {
+    DWORD size;              /**< Bytes of this record, a multiple of 8 */
+    DWORD reserved;          /**< Zero */
+    PlanCacheKey key;        /**< Inputs */
+    PlanCacheResult result;  /**< Configuration values */
+    CompositionPlan plan;    /**< Compiled plan (allocated with plan.count entries) */
+} CachedPlan;
+
+/**
+ * @brief The open cache
+ */
+typedef struct {
+    BOOL opened;                       /**< Open was attempted since the last close */
+    BOOL disabled;                     /**< ProfileCacheEnable(FALSE) */
+    HANDLE hFile;                      /**< Mapped file, NULL for a heap image */
+    HANDLE hMapping;                   /**< Read-only mapping */
+    const BYTE* base;                  /**< Cache image, NULL if unavailable */
+    const ProfileCacheHeader* header;  /**< Header at base */
+    char path[MAX_PATH];               /**< Cache file path */
+} ProfileCacheState;
+
+static ProfileCacheState g_cache = { 0 };
+
+/**
+ * @brief Size of a plan record with a given number of entries
+ * @param count Plan entries
+ * @return Record bytes, rounded up to 8
+ */
+static DWORD PlanRecordSize(int count) {
+    return CACHE_ALIGN((DWORD)(sizeof(CachedPlan) + (SIZE_T)(count - 1) * sizeof(CompositionEntry)));
+}
+
+/**
+ * @brief Offset of the first plan record
+ * @param header Cache header
+ * @return Byte offset from the start of the image
+ */
+static DWORD FirstPlanOffset(const ProfileCacheHeader* header) {
+    return CACHE_ALIGN((DWORD)(sizeof(ProfileCacheHeader) + (SIZE_T)header->entryCount * sizeof(ProfileEntry)));
+}
+
+/**
+ * @brief Checks that a cached plan can be handed to the stream as it is
+ * @param record Plan record, already known to lie inside the image
+ * @return TRUE if the plan is usable
+ * @details The stream trusts a plan without re-deriving it: it binary-searches
+ *          the thresholds, draws from the charset of every nonzero count, and
+ *          picks the first character among the positions the leading rules
+ *          allow. So thresholds must strictly increase up to
+ *          2^PLAN_THRESHOLD_BITS, a category may only have characters if it
+ *          was enabled (and, for symbols, if the symbol set is not empty), and
+ *          every entry must leave an allowed first character.
+ */
+static BOOL ValidatePlan(const CachedPlan* record) {
+    const CompositionPlan* plan = &record->plan;
+    const PlanCacheResult* result = &record->result;
+    BOOL noLeadingDigit = (result->flags & PLAN_KEY_NO_LEADING_DIGIT) != 0;
+    BOOL noLeadingSymbol = (result->flags & PLAN_KEY_NO_LEADING_SYMBOL) != 0;
+
+    if (result->letters < 0 || result->numbers < 0 || result->symbols < 0 ||
+        result->letters + result->numbers + result->symbols != plan->length) return FALSE;
+
+    for (int i = 0; i < plan->count; i++) {
+        const CompositionEntry* entry = &plan->entries[i];
+        if (entry->letters + entry->numbers + entry->symbols != plan->length) return FALSE;
+        if (i > 0 && entry->threshold <= plan->entries[i - 1].threshold) return FALSE;
+        if ((entry->letters > 0 && !(record->key.flags & PLAN_KEY_LETTERS)) ||
+            (entry->numbers > 0 && !(record->key.flags & PLAN_KEY_NUMBERS)) ||
+            (entry->symbols > 0 && (!(record->key.flags & PLAN_KEY_SYMBOLS) || result->symbolSet[0] == '\0'))) {
+            return FALSE;
+        }
+        if (entry->letters + (noLeadingDigit ? 0 : entry->numbers) + (noLeadingSymbol ? 0 : entry->symbols) == 0) {
+            return FALSE;
+        }
+    }
+    return plan->entries[plan->count - 1].threshold == 1ULL << PLAN_THRESHOLD_BITS;
+}
+
+/**
+ * @brief Checks that a mapped image is a complete cache of the current profile file
+ * @param base Image
+ * @param size Image size
+ * @param sourcePath Profile file path
+ * @param sourceSize Profile file size
+ * @param sourceTime Profile file last write time
+ * @return TRUE if the image can be used
+ * @details The file is written by this module and replaced atomically, so
+ *          there is no checksum to compute at startup. Strings must be
+ *          terminated, and every plan must pass ValidatePlan(), since the
+ *          stream uses a mapped plan directly. Any failure is a cache miss:
+ *          the cache is rebuilt from the profile file.
+ */
+static BOOL ValidateCache(const BYTE* base, DWORD size, const char* sourcePath,
+                          ULONGLONG sourceSize, ULONGLONG sourceTime) {
+    const ProfileCacheHeader* header = (const ProfileCacheHeader*)base;
+
+    if (size < sizeof(ProfileCacheHeader)) return FALSE;
+    if (header->magic != PROFILE_CACHE_MAGIC || header->version != PROFILE_CACHE_VERSION ||
+        header->entrySize != sizeof(ProfileEntry) || header->fileSize != size) return FALSE;
+    if (header->sourceSize != sourceSize || header->sourceTime != sourceTime) return FALSE;
+    if (header->sourcePath[MAX_PATH - 1] != '\0' || lstrcmpiA(header->sourcePath, sourcePath) != 0) return FALSE;
+    if (header->entryCount > size / sizeof(ProfileEntry) || header->planCount > MAX_CACHED_PLANS) return FALSE;
+
+    const ProfileEntry* entries = (const ProfileEntry*)(base + sizeof(ProfileCacheHeader));
+    DWORD offset = FirstPlanOffset(header);
+    if (offset > size) return FALSE;
+    for (DWORD i = 0; i < header->entryCount; i++) {
+        if (entries[i].name[MAX_PROFILE_NAME - 1] != '\0' ||
+            entries[i].allowedSymbols[MAX_SYMBOL_SET - 1] != '\0') return FALSE;
+    }
+
+    for (DWORD p = 0; p < header->planCount; p++) {
+        if (size - offset < sizeof(CachedPlan)) return FALSE;
+        const CachedPlan* record = (const CachedPlan*)(base + offset);
+        const CompositionPlan* plan = &record->plan;
+        if (plan->count < 1 || plan->length < MIN_PASSWORD_LENGTH || plan->length > MAX_PASSWORD_LENGTH ||
+            (DWORD)plan->count > (size - offset) / sizeof(CompositionEntry) ||
+            record->size != PlanRecordSize(plan->count) || record->size > size - offset) return FALSE;
+        if (record->key.names[MAX_INTERSECT_NAMES - 1] != '\0' ||
+            record->key.symbolSet[MAX_SYMBOL_SET - 1] != '\0' ||
+            record->result.symbolSet[MAX_SYMBOL_SET - 1] != '\0') return FALSE;
+        if (!ValidatePlan(record)) return FALSE;
+        offset += record->size;
+    }
+    return offset == size;
+}
+
+/**
+ * @brief Releases the current image
+ */
+static void ReleaseCache(void) {
+    if (g_cache.hFile) {
+        if (g_cache.base) UnmapViewOfFile(g_cache.base);
+        if (g_cache.hMapping) CloseHandle(g_cache.hMapping);
+        CloseHandle(g_cache.hFile);
+    } else if (g_cache.base) {
+        HeapFree(GetProcessHeap(), 0, (LPVOID)g_cache.base);
+    }
+    g_cache.hFile = NULL;
+    g_cache.hMapping = NULL;
+    g_cache.base = NULL;
+    g_cache.header = NULL;
+}
+
+/**
+ * @brief Maps the cache file if it is valid for the profile file
+ * @param sourcePath Profile file path
+ * @param sourceSize Profile file size
+ * @param sourceTime Profile file last write time
+ * @return TRUE if mapped
+ */
+static BOOL MapCacheFile(const char* sourcePath, ULONGLONG sourceSize, ULONGLONG sourceTime) {
+    LARGE_INTEGER size;
+
+    HANDLE hFile = CreateFileA(g_cache.path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return FALSE;
+    if (!GetFileSizeEx(hFile, &size) || size.QuadPart < (LONGLONG)sizeof(ProfileCacheHeader) ||
+        size.QuadPart > 0x7FFFFFFF) {
+        CloseHandle(hFile);
+        return FALSE;
+    }
+
+    g_cache.hFile = hFile;
+    g_cache.hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    g_cache.base = g_cache.hMapping ? (const BYTE*)MapViewOfFile(g_cache.hMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!g_cache.base || !ValidateCache(g_cache.base, (DWORD)size.QuadPart, sourcePath, sourceSize, sourceTime)) {
+        ReleaseCache();
+        return FALSE;
+    }
+    g_cache.header = (const ProfileCacheHeader*)g_cache.base;
+    return TRUE;
+}
+
+/**
+ * @brief Writes an image to the cache file and makes it the current image
+ * @param image Heap image; ownership passes to the cache
+ * @details The previous image is released first, since a mapped file cannot
+ *          be replaced. A failed write only means the next run rebuilds.
+ */
+static void PublishImage(BYTE* image) {
+    const ProfileCacheHeader* header = (const ProfileCacheHeader*)image;
+    char tempPath[MAX_PATH + 16];
+    DWORD written = 0;
+
+    ReleaseCache();
+    g_cache.base = image;
+    g_cache.header = header;
+
+    wsprintfA(tempPath, "%s.%lu", g_cache.path, GetCurrentProcessId());
+    HANDLE hOut = CreateFileA(tempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hOut == INVALID_HANDLE_VALUE) return;
+    BOOL ok = WriteFile(hOut, image, header->fileSize, &written, NULL) && written == header->fileSize;
+    CloseHandle(hOut);
+    if (!ok || !MoveFileExA(tempPath, g_cache.path, MOVEFILE_REPLACE_EXISTING)) DeleteFileA(tempPath);
+}
+
+/**
+ * @brief Compiles every profile of the file into a new cache image
+ * @param sourcePath Profile file path
+ * @param sourceSize Profile file size
+ * @param sourceTime Profile file last write time
+ * @return TRUE if the image was built
+ */
+static BOOL BuildCache(const char* sourcePath, ULONGLONG sourceSize, ULONGLONG sourceTime) {
+    HANDLE hHeap = GetProcessHeap();
+    int count = 0;
+
+    ProfileEntry* entries = ReadAllProfiles(sourcePath, &count);
+    if (!entries) return FALSE;
+
+    DWORD size = CACHE_ALIGN((DWORD)(sizeof(ProfileCacheHeader) + (SIZE_T)count * sizeof(ProfileEntry)));
+    BYTE* image = (BYTE*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, size);
+    if (!image) {
+        HeapFree(hHeap, 0, entries);
+        return FALSE;
+    }
+
+    ProfileCacheHeader* header = (ProfileCacheHeader*)image;
+    header->magic = PROFILE_CACHE_MAGIC;
+    header->version = PROFILE_CACHE_VERSION;
+    header->entrySize = sizeof(ProfileEntry);
+    header->entryCount = (DWORD)count;
+    header->planCount = 0;
+    header->fileSize = size;
+    header->sourceSize = sourceSize;
+    header->sourceTime = sourceTime;
+    lstrcpynA(header->sourcePath, sourcePath, MAX_PATH);
+    CopyMemory(image + sizeof(ProfileCacheHeader), entries, (SIZE_T)count * sizeof(ProfileEntry));
+    HeapFree(hHeap, 0, entries);
+
+    PublishImage(image);
+    return TRUE;
+}
+
+/**
+ * @brief Opens the cache on first use
+ * @return TRUE if an image is available
+ */
+static BOOL EnsureCacheOpen(void) {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    char sourcePath[MAX_PATH];
+
+    if (g_cache.disabled) return FALSE;
+    if (g_cache.opened) return g_cache.base != NULL;
+    g_cache.opened = TRUE;
+
+    /* No profile file or no per-user directory: every lookup reads the file */
+    if (!GetProfilePath(sourcePath, sizeof(sourcePath)) ||
+        !GetFileAttributesExA(sourcePath, GetFileExInfoStandard, &attributes) ||
+        !GetUserDataPath(PROFILE_CACHE_FILE_NAME, g_cache.path, sizeof(g_cache.path))) return FALSE;
+
+    ULONGLONG sourceSize = ((ULONGLONG)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+    ULONGLONG sourceTime = ((ULONGLONG)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+                           attributes.ftLastWriteTime.dwLowDateTime;
+    if (MapCacheFile(sourcePath, sourceSize, sourceTime)) return TRUE;
+    return BuildCache(sourcePath, sourceSize, sourceTime);
+}
+
+/**
+ * @brief Looks up a valid profile in the cache
+ * @param name Profile name
+ * @param entry Output entry
+ * @return TRUE on a hit
+ */
+BOOL ProfileCacheFind(const char* name, ProfileEntry* entry) {
+    int count;
+    const ProfileEntry* entries = ProfileCacheEntries(&count);
+
+    for (int i = 0; entries && i < count; i++) {
+        if (lstrcmpiA(entries[i].name, name) == 0) {
+            *entry = entries[i];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Returns every cached profile
+ * @param count Output: number of entries
+ * @return Entries, NULL if the cache is unavailable
+ */
+const ProfileEntry* ProfileCacheEntries(int* count) {
+    *count = 0;
+    if (!EnsureCacheOpen()) return NULL;
+    *count = (int)g_cache.header->entryCount;
+    return (const ProfileEntry*)(g_cache.base + sizeof(ProfileCacheHeader));
+}
+
+/**
+ * @brief Checks whether a cached plan was compiled from the same inputs
+ * @param record Cached plan
+ * @param key Inputs of the current run
+ * @return TRUE on a match
+ */
+static BOOL PlanKeyMatches(const CachedPlan* record, const PlanCacheKey* key) {
+    return record->key.defaultLength == key->defaultLength && record->key.flags == key->flags &&
+           lstrcmpA(record->key.symbolSet, key->symbolSet) == 0 &&
+           lstrcmpiA(record->key.names, key->names) == 0;
+}
+
+/**
+ * @brief Looks up a compiled intersection plan
+ * @param key Inputs of the --intersect run
+ * @param result Output: configuration values
+ * @return Heap copy of the plan, NULL on a miss
+ */
+CompositionPlan* ProfileCacheFindPlan(const PlanCacheKey* key, PlanCacheResult* result) {
+    if (!EnsureCacheOpen()) return NULL;
+
+    DWORD offset = FirstPlanOffset(g_cache.header);
+    for (DWORD p = 0; p < g_cache.header->planCount; p++) {
+        const CachedPlan* record = (const CachedPlan*)(g_cache.base + offset);
+        offset += record->size;
+        if (!PlanKeyMatches(record, key)) continue;
+
+        SIZE_T planSize = sizeof(CompositionPlan) + (SIZE_T)(record->plan.count - 1) * sizeof(CompositionEntry);
+        CompositionPlan* plan = (CompositionPlan*)HeapAlloc(GetProcessHeap(), 0, planSize);
+        if (!plan) return NULL;
+        CopyMemory(plan, &record->plan, planSize);
+        *result = record->result;
+        return plan;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Adds a compiled intersection plan to the cache file
+ * @param key Inputs of the --intersect run
+ * @param result Configuration values
+ * @param plan Compiled plan
+ */
+void ProfileCacheStorePlan(const PlanCacheKey* key, const PlanCacheResult* result, const CompositionPlan* plan) {
+    if (!EnsureCacheOpen()) return;
+
+    /* Drop the oldest plan when full, keeping the profiles */
+    const ProfileCacheHeader* old = g_cache.header;
+    DWORD firstPlan = FirstPlanOffset(old);
+    DWORD keepFrom = firstPlan;
+    DWORD planCount = old->planCount;
+    if (planCount == MAX_CACHED_PLANS) {
+        keepFrom += ((const CachedPlan*)(g_cache.base + firstPlan))->size;
+        planCount--;
+    }
+
+    DWORD recordSize = PlanRecordSize(plan->count);
+    DWORD keptSize = old->fileSize - keepFrom;
+    BYTE* image = (BYTE*)HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, firstPlan + keptSize + recordSize);
+    if (!image) return;
+    CopyMemory(image, g_cache.base, firstPlan);
+    CopyMemory(image + firstPlan, g_cache.base + keepFrom, keptSize);
+
+    CachedPlan* record = (CachedPlan*)(image + firstPlan + keptSize);
+    record->size = recordSize;
+    record->key = *key;
+    record->result = *result;
+    CopyMemory(&record->plan, plan, sizeof(CompositionPlan) + (SIZE_T)(plan->count - 1) * sizeof(CompositionEntry));
+
+    ProfileCacheHeader* header = (ProfileCacheHeader*)image;
+    header->planCount = planCount + 1;
+    header->fileSize = firstPlan + keptSize + recordSize;
+    PublishImage(image);
+}
+
+/**
+ * @brief Enables or disables the cache for this process
+ * @param enable TRUE to use the cache
+ */
+void ProfileCacheEnable(BOOL enable) {
+    g_cache.disabled = !enable;
+}
+
+/**
+ * @brief Unmaps the cache
+ */
+void ProfileCacheClose(void) {
+    ReleaseCache();
+    g_cache.opened = FALSE;
+}
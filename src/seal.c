@@ -0,0 +1,567 @@
+/**
+ * @file seal.c
+ * @brief Per-recipient sealed delivery implementation
+ * @details Sealing mirrors GenerateBatch(): worker threads claim fixed batches
+ *          of records from a shared counter, and each batch writes only its own
+ *          output records, so no other synchronization is needed.
+ */
+
+#include "../include/seal.h"
+#include "../include/console_io.h"
+#include "../include/hashes.h"
+
+#define SEAL_MAX_FILE   0x40000000  /**< Largest recipient or sealed file read (1 GB) */
+#define SEAL_MAX_RECORD (MAX_PASSWORD_LENGTH + SEAL_OVERHEAD)  /**< Largest decoded record */
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * @brief Shared state of one SealRecords() call
+ */
+typedef struct {
+    const char* records;           /**< Password records */
+    int stride;                    /**< Bytes per password record */
+    int length;                    /**< Password length */
+    const RecipientList* recipients;
+    char* sealed;                  /**< Output records */
+    int sealedStride;              /**< Bytes per output record */
+    volatile LONG next;            /**< Next unclaimed record */
+    volatile LONG batches;         /**< Batches sealed */
+    volatile LONG randomFailed;    /**< Set when a worker could not get random bytes */
+    volatile LONG weakRecipient;   /**< 1-based line of a low-order recipient key, 0 if none */
+} SealJob;
+
+/**
+ * @brief Writes bytes as lowercase hex
+ * @param out 2 * length characters
+ * @param in Bytes
+ * @param length Number of bytes
+ */
+static void HexEncode(char* out, const BYTE* in, int length) {
+    for (int i = 0; i < length; i++) {
+        out[2 * i] = HEX_DIGITS[in[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[in[i] & 0x0F];
+    }
+}
+
+/**
+ * @brief Value of one hex digit
+ * @param c Character
+ * @return 0-15, or -1 if c is not a hex digit
+ */
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decodes 2 * length hex characters
+ * @param out length bytes
+ * @param in Hex text
+ * @param length Number of bytes
+ * @return TRUE if every character was a hex digit
+ */
+static BOOL HexDecode(BYTE* out, const char* in, int length) {
+    for (int i = 0; i < length; i++) {
+        int hi = HexValue(in[2 * i]);
+        int lo = HexValue(in[2 * i + 1]);
+        if (hi < 0 || lo < 0) return FALSE;
+        out[i] = (BYTE)(hi << 4 | lo);
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Reads a whole file into a heap buffer
+ * @param path File
+ * @param size Output: bytes read
+ * @return Buffer to release with HeapFree, or NULL (message already printed)
+ */
+static char* ReadWholeFile(const WCHAR* path, DWORD* size) {
+    LARGE_INTEGER fileSize;
+
+    HANDLE hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot open file");
+        return NULL;
+    }
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart > SEAL_MAX_FILE) {
+        ConsoleWrite("[ERROR] File is too large.\r\n");
+        CloseHandle(hFile);
+        return NULL;
+    }
+
+    *size = (DWORD)fileSize.QuadPart;
+    char* data = (char*)HeapAlloc(GetProcessHeap(), 0, *size + 1);
+    if (!data) {
+        PrintError("Memory Error");
+        CloseHandle(hFile);
+        return NULL;
+    }
+
+    DWORD bytesRead = 0;
+    if (*size > 0 && (!ReadFile(hFile, data, *size, &bytesRead, NULL) || bytesRead != *size)) {
+        PrintError("Read Failed");
+        HeapFree(GetProcessHeap(), 0, data);
+        CloseHandle(hFile);
+        return NULL;
+    }
+    CloseHandle(hFile);
+    return data;
+}
+
+/**
+ * @brief Finds the next line of a text buffer
+ * @param data Text
+ * @param size Text size
+ * @param pos In: start of the line; out: start of the following line
+ * @param length Output: line length without CR/LF and trailing blanks
+ * @return Start of the line
+ */
+static const char* NextLine(const char* data, DWORD size, DWORD* pos, DWORD* length) {
+    const char* line = data + *pos;
+    DWORD end = *pos;
+
+    while (end < size && data[end] != '\n') end++;
+    DWORD n = end - *pos;
+    while (n > 0 && (line[n - 1] == '\r' || line[n - 1] == ' ' || line[n - 1] == '\t')) n--;
+    *length = n;
+    *pos = end < size ? end + 1 : end;
+    return line;
+}
+
+/**
+ * @brief Loads a recipient file
+ * @param path Text file with one hex public key per line
+ * @return Recipient list, or NULL on error
+ */
+RecipientList* LoadRecipients(const WCHAR* path) {
+    HANDLE hHeap = GetProcessHeap();
+    char msgBuf[128];
+    DWORD size, pos, length;
+
+    char* data = ReadWholeFile(path, &size);
+    if (!data) return NULL;
+
+    /* Every key line is at least 64 characters, which bounds the count */
+    RecipientList* list = (RecipientList*)HeapAlloc(hHeap, 0, sizeof(RecipientList));
+    BYTE* keys = list ? (BYTE*)HeapAlloc(hHeap, 0, (size / (2 * X25519_KEY_SIZE) + 1) * X25519_KEY_SIZE) : NULL;
+    if (!keys) {
+        PrintError("Memory Error");
+        if (list) HeapFree(hHeap, 0, list);
+        HeapFree(hHeap, 0, data);
+        return NULL;
+    }
+    list->keys = keys;
+    list->count = 0;
+
+    pos = 0;
+    int lineNumber = 0;
+    while (pos < size) {
+        const char* line = NextLine(data, size, &pos, &length);
+        lineNumber++;
+        if (length == 0) continue;
+        if (length != 2 * X25519_KEY_SIZE ||
+            !HexDecode(keys + (SIZE_T)list->count * X25519_KEY_SIZE, line, X25519_KEY_SIZE)) {
+            wsprintfA(msgBuf, "[ERROR] Recipient line %d is not a 64-digit hex public key.\r\n", lineNumber);
+            ConsoleWrite(msgBuf);
+            FreeRecipients(list);
+            HeapFree(hHeap, 0, data);
+            return NULL;
+        }
+        list->count++;
+    }
+    HeapFree(hHeap, 0, data);
+
+    if (list->count == 0) {
+        ConsoleWrite("[ERROR] Recipient file has no public keys.\r\n");
+        FreeRecipients(list);
+        return NULL;
+    }
+    return list;
+}
+
+/**
+ * @brief Releases a list from LoadRecipients()
+ * @param list List to free (may be NULL)
+ */
+void FreeRecipients(const RecipientList* list) {
+    if (!list) return;
+    HeapFree(GetProcessHeap(), 0, list->keys);
+    HeapFree(GetProcessHeap(), 0, (LPVOID)list);
+}
+
+/**
+ * @brief Derives the AEAD key of a record from its shared secret
+ * @param key 32-byte output
+ * @param shared X25519 shared secret
+ */
+static void DeriveSealKey(BYTE* key, const BYTE* shared) {
+    HChaCha20(key, shared, (const BYTE*)SEAL_KDF_INPUT);
+}
+
+/**
+ * @brief Computes the key ID that starts each record sealed to a public key
+ * @param id SEAL_KEY_ID_SIZE-byte output
+ * @param publicKey 32-byte recipient public key
+ */
+static void RecipientKeyId(BYTE* id, const BYTE* publicKey) {
+    Blake2b(id, SEAL_KEY_ID_SIZE, publicKey, X25519_KEY_SIZE, NULL, 0);
+}
+
+/**
+ * @brief Seals records [first, first + n) of a job
+ * @param job Seal job
+ * @param first First record
+ * @param n Number of records (at most SEAL_BATCH)
+ * @param scalars n ephemeral secret scalars
+ */
+static void SealBatch(SealJob* job, int first, int n, const BYTE* scalars) {
+    static const BYTE NONCE[AEAD_NONCE_SIZE] = { 0 };
+    X25519Job jobs[2 * SEAL_BATCH];
+    BYTE ephemeral[SEAL_BATCH][X25519_KEY_SIZE];
+    BYTE shared[SEAL_BATCH][X25519_KEY_SIZE];
+    BYTE key[AEAD_KEY_SIZE];
+    BYTE aad[2 * X25519_KEY_SIZE];
+    BYTE record[SEAL_MAX_RECORD];
+
+    /* Ephemeral public keys and shared secrets of the batch share one inversion */
+    for (int i = 0; i < n; i++) {
+        jobs[2 * i].scalar = scalars + i * X25519_KEY_SIZE;
+        jobs[2 * i].point = X25519_BASE_POINT;
+        jobs[2 * i].out = ephemeral[i];
+        jobs[2 * i + 1].scalar = scalars + i * X25519_KEY_SIZE;
+        jobs[2 * i + 1].point = job->recipients->keys + (SIZE_T)(first + i) * X25519_KEY_SIZE;
+        jobs[2 * i + 1].out = shared[i];
+    }
+    X25519Batch(jobs, 2 * n);
+
+    for (int i = 0; i < n; i++) {
+        const BYTE* recipient = jobs[2 * i + 1].point;
+        BYTE any = 0;
+        for (int k = 0; k < X25519_KEY_SIZE; k++) any |= shared[i][k];
+        if (any == 0) {
+            /* Low-order key: the shared secret would be public */
+            InterlockedExchange(&job->weakRecipient, first + i + 1);
+            continue;
+        }
+
+        DeriveSealKey(key, shared[i]);
+        RecipientKeyId(record, recipient);
+        for (int k = 0; k < X25519_KEY_SIZE; k++) {
+            record[SEAL_KEY_ID_SIZE + k] = ephemeral[i][k];
+            aad[k] = ephemeral[i][k];
+            aad[X25519_KEY_SIZE + k] = recipient[k];
+        }
+        AeadSeal(record + SEAL_KEY_ID_SIZE + X25519_KEY_SIZE, record + SEAL_KEY_ID_SIZE + X25519_KEY_SIZE + job->length,
+                 (const BYTE*)job->records + (SIZE_T)(first + i) * job->stride, (DWORD)job->length,
+                 aad, sizeof(aad), key, NONCE);
+
+        char* out = job->sealed + (SIZE_T)(first + i) * job->sealedStride;
+        HexEncode(out, record, job->length + SEAL_OVERHEAD);
+        out[job->sealedStride - 2] = '\r';
+        out[job->sealedStride - 1] = '\n';
+    }
+
+    SecureZeroMemory(shared, sizeof(shared));
+    SecureZeroMemory(key, sizeof(key));
+    SecureZeroMemory(record, sizeof(record));
+}
+
+/**
+ * @brief Thread procedure: claims and seals batches until the job is exhausted
+ * @param param Pointer to the SealJob
+ * @return 0 on success, 1 on failure
+ */
+static DWORD WINAPI SealWorkerProc(LPVOID param) {
+    SealJob* job = (SealJob*)param;
+    HCRYPTPROV hCryptProv = 0;
+    BYTE scalars[SEAL_BATCH * X25519_KEY_SIZE];
+    DWORD result = 0;
+
+    if (!CryptAcquireContext(&hCryptProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+        InterlockedExchange(&job->randomFailed, 1);
+        return 1;
+    }
+
+    for (;;) {
+        int first = (int)InterlockedExchangeAdd(&job->next, SEAL_BATCH);
+        if (first >= job->recipients->count || job->randomFailed) break;
+        int n = job->recipients->count - first;
+        if (n > SEAL_BATCH) n = SEAL_BATCH;
+
+        /* One CryptoAPI call for all ephemeral keys of the batch */
+        if (!CryptGenRandom(hCryptProv, (DWORD)n * X25519_KEY_SIZE, scalars)) {
+            InterlockedExchange(&job->randomFailed, 1);
+            result = 1;
+            break;
+        }
+        SealBatch(job, first, n, scalars);
+        InterlockedIncrement(&job->batches);
+    }
+
+    SecureZeroMemory(scalars, sizeof(scalars));
+    CryptReleaseContext(hCryptProv, 0);
+    return result;
+}
+
+/**
+ * @brief Seals record i of a password buffer to recipient i
+ * @param records Password records
+ * @param stride Bytes per password record
+ * @param recipients Recipients
+ * @param sealed Output records
+ * @param stats Optional statistics output
+ * @return TRUE on success, FALSE on failure
+ */
+BOOL SealRecords(const char* records, int stride, const RecipientList* recipients, char* sealed, SealStats* stats) {
+    SealJob job;
+    HANDLE threads[MAX_SEAL_THREADS];
+    SYSTEM_INFO sysInfo;
+    char msgBuf[128];
+
+    job.records = records;
+    job.stride = stride;
+    job.length = stride - 2;
+    job.recipients = recipients;
+    job.sealed = sealed;
+    job.sealedStride = SEAL_RECORD_STRIDE(job.length);
+    job.next = 0;
+    job.batches = 0;
+    job.randomFailed = 0;
+    job.weakRecipient = 0;
+
+    /* One worker per processor, but no more workers than batches */
+    GetSystemInfo(&sysInfo);
+    int threadCount = (int)sysInfo.dwNumberOfProcessors;
+    int batchCount = (recipients->count + SEAL_BATCH - 1) / SEAL_BATCH;
+    if (threadCount > MAX_SEAL_THREADS) threadCount = MAX_SEAL_THREADS;
+    if (threadCount > batchCount) threadCount = batchCount;
+    if (threadCount < 1) threadCount = 1;
+
+    int started = 0;
+    if (threadCount > 1) {
+        for (int t = 0; t < threadCount; t++) {
+            threads[t] = CreateThread(NULL, 0, SealWorkerProc, &job, 0, NULL);
+            if (!threads[t]) break;
+            started++;
+        }
+    }
+    if (started == 0) {
+        SealWorkerProc(&job);
+        started = 1;
+    } else {
+        WaitForMultipleObjects((DWORD)started, threads, TRUE, INFINITE);
+        for (int t = 0; t < started; t++) CloseHandle(threads[t]);
+    }
+
+    if (stats) {
+        stats->threads = started;
+        stats->batches = (int)job.batches;
+    }
+    if (job.randomFailed) {
+        PrintError("GenRandom Failed");
+        return FALSE;
+    }
+    if (job.weakRecipient) {
+        wsprintfA(msgBuf, "[ERROR] Recipient key %d is a low-order point and cannot be sealed to.\r\n",
+                  (int)job.weakRecipient);
+        ConsoleWrite(msgBuf);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Reads a secret key file
+ * @param path File with the hex secret key on its first line
+ * @param secret 32-byte output
+ * @return TRUE on success (message printed on failure)
+ */
+static BOOL ReadSecretKey(const WCHAR* path, BYTE* secret) {
+    DWORD size, pos = 0, length;
+
+    char* data = ReadWholeFile(path, &size);
+    if (!data) return FALSE;
+
+    const char* line = NextLine(data, size, &pos, &length);
+    BOOL ok = length == 2 * X25519_KEY_SIZE && HexDecode(secret, line, X25519_KEY_SIZE);
+    SecureZeroMemory(data, size);
+    HeapFree(GetProcessHeap(), 0, data);
+    if (!ok) ConsoleWrite("[ERROR] Key file must hold a 64-digit hex secret key.\r\n");
+    return ok;
+}
+
+/**
+ * @brief Opens the records of sealed text that belong to a secret key
+ * @param data Sealed records
+ * @param size Bytes of data
+ * @param secret Secret key
+ * @param proc Receives each opened password
+ * @param context Passed to proc
+ * @param malformed Output: TRUE if a line was malformed
+ * @return Number of records opened
+ */
+int OpenSealedRecords(const char* data, DWORD size, const BYTE* secret, SealedPasswordProc proc, void* context,
+                      BOOL* malformed) {
+    static const BYTE NONCE[AEAD_NONCE_SIZE] = { 0 };
+    static BYTE records[SEAL_BATCH][SEAL_MAX_RECORD];
+    int recordLength[SEAL_BATCH];
+    BYTE shared[SEAL_BATCH][X25519_KEY_SIZE];
+    X25519Job jobs[SEAL_BATCH];
+    BYTE publicKey[X25519_KEY_SIZE];
+    BYTE keyId[SEAL_KEY_ID_SIZE];
+    BYTE key[AEAD_KEY_SIZE];
+    BYTE aad[2 * X25519_KEY_SIZE];
+    DWORD pos = 0, length;
+    int opened = 0;
+
+    *malformed = FALSE;
+    X25519(publicKey, secret, X25519_BASE_POINT);
+    RecipientKeyId(keyId, publicKey);
+
+    while (pos < size) {
+        /* Decode up to SEAL_BATCH records carrying this key's ID */
+        int n = 0;
+        while (n < SEAL_BATCH && pos < size) {
+            const char* line = NextLine(data, size, &pos, &length);
+            if (length == 0) continue;
+            int bytes = (int)(length / 2);
+            if (length % 2 != 0 || bytes < MIN_PASSWORD_LENGTH + SEAL_OVERHEAD ||
+                bytes > SEAL_MAX_RECORD || !HexDecode(records[n], line, SEAL_KEY_ID_SIZE)) {
+                *malformed = TRUE;
+                continue;
+            }
+            BYTE diff = 0;
+            for (int k = 0; k < SEAL_KEY_ID_SIZE; k++) diff |= records[n][k] ^ keyId[k];
+            if (diff != 0) continue;
+            if (!HexDecode(records[n], line, bytes)) {
+                *malformed = TRUE;
+                continue;
+            }
+            recordLength[n] = bytes - SEAL_OVERHEAD;
+            jobs[n].scalar = secret;
+            jobs[n].point = records[n] + SEAL_KEY_ID_SIZE;
+            jobs[n].out = shared[n];
+            n++;
+        }
+        if (n == 0) break;
+        X25519Batch(jobs, n);
+
+        for (int i = 0; i < n; i++) {
+            BYTE* ephemeral = records[i] + SEAL_KEY_ID_SIZE;
+            BYTE* password = ephemeral + X25519_KEY_SIZE;
+            BYTE any = 0;
+            for (int k = 0; k < X25519_KEY_SIZE; k++) any |= shared[i][k];
+            if (any == 0) continue;
+
+            DeriveSealKey(key, shared[i]);
+            for (int k = 0; k < X25519_KEY_SIZE; k++) {
+                aad[k] = ephemeral[k];
+                aad[X25519_KEY_SIZE + k] = publicKey[k];
+            }
+            /* A colliding key ID from another recipient fails authentication here */
+            if (AeadOpen(password, password, (DWORD)recordLength[i], password + recordLength[i],
+                         aad, sizeof(aad), key, NONCE)) {
+                proc(context, (const char*)password, recordLength[i]);
+                opened++;
+            }
+        }
+    }
+
+    SecureZeroMemory(records, sizeof(records));
+    SecureZeroMemory(shared, sizeof(shared));
+    SecureZeroMemory(key, sizeof(key));
+    return opened;
+}
+
+/**
+ * @brief SealedPasswordProc that prints each password on its own line
+ * @param context Unused
+ * @param password Password
+ * @param length Password length
+ */
+static void PrintOpenedPassword(void* context, const char* password, int length) {
+    ConsoleWriteN(password, length);
+    ConsoleWrite("\r\n");
+}
+
+/**
+ * @brief Opens the records of a sealed file that belong to a secret key
+ * @param sealedPath Sealed file
+ * @param keyPath Secret key file
+ * @return TRUE if at least one record opened
+ */
+BOOL OpenSealedFile(const WCHAR* sealedPath, const WCHAR* keyPath) {
+    BYTE secret[X25519_KEY_SIZE];
+    DWORD size;
+    BOOL malformed;
+
+    if (!ReadSecretKey(keyPath, secret)) return FALSE;
+
+    char* data = ReadWholeFile(sealedPath, &size);
+    if (!data) {
+        SecureZeroMemory(secret, sizeof(secret));
+        return FALSE;
+    }
+
+    int opened = OpenSealedRecords(data, size, secret, PrintOpenedPassword, NULL, &malformed);
+    SecureZeroMemory(secret, sizeof(secret));
+    HeapFree(GetProcessHeap(), 0, data);
+
+    if (opened == 0) {
+        ConsoleWrite(malformed ? "[ERROR] No record opened; the file contains malformed lines.\r\n"
+                               : "[ERROR] No record in this file is sealed to this key.\r\n");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Creates a recipient key pair
+ * @param path New file for the hex secret key
+ * @return TRUE on success
+ */
+BOOL GenerateKeyFile(const WCHAR* path) {
+    HCRYPTPROV hCryptProv = 0;
+    BYTE secret[X25519_KEY_SIZE];
+    BYTE publicKey[X25519_KEY_SIZE];
+    char text[2 * X25519_KEY_SIZE + 2];
+    BOOL success = FALSE;
+
+    if (!CryptAcquireContext(&hCryptProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+        PrintError("Crypto Context Failed");
+        return FALSE;
+    }
+    if (!CryptGenRandom(hCryptProv, sizeof(secret), secret)) {
+        PrintError("GenRandom Failed");
+        CryptReleaseContext(hCryptProv, 0);
+        return FALSE;
+    }
+    CryptReleaseContext(hCryptProv, 0);
+
+    /* Never overwrite an existing key: the records sealed to it would be lost */
+    HANDLE hOut = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hOut == INVALID_HANDLE_VALUE) {
+        PrintError("Cannot create key file (it may already exist)");
+    } else {
+        DWORD bytesWritten = 0;
+        HexEncode(text, secret, X25519_KEY_SIZE);
+        text[2 * X25519_KEY_SIZE] = '\r';
+        text[2 * X25519_KEY_SIZE + 1] = '\n';
+        success = WriteFile(hOut, text, sizeof(text), &bytesWritten, NULL) && bytesWritten == sizeof(text);
+        CloseHandle(hOut);
+        if (!success) PrintError("Write Failed");
+    }
+
+    if (success) {
+        X25519(publicKey, secret, X25519_BASE_POINT);
+        HexEncode(text, publicKey, X25519_KEY_SIZE);
+        ConsoleWriteN(text, sizeof(text));
+    }
+    SecureZeroMemory(secret, sizeof(secret));
+    SecureZeroMemory(text, sizeof(text));
+    return success;
+}
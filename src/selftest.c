@@ -0,0 +1,475 @@
+/**
+ * @file selftest.c
+ * @brief Known-answer tests of the built-in primitives, a seal round trip, a stream stack check and a coordinator test
+ * @details Each test computes a digest, tag, key or ciphertext and compares its
+ *          hexadecimal form with the published value (RFC 7748 for X25519, RFC
+ *          8439 for Poly1305 and ChaCha20-Poly1305); a seal round trip then
+ *          checks the sealed-delivery record format end to end. bcrypt has no
+ *          hexadecimal reference, so its expected bytes are the decoded hash
+ *          of the OpenBSD test vector
+ *          $2a$05$CCCCCCCCCCCCCCCCCCCCC.E5YPO9kmyuRGyh0XouQYb4YMJKvyOeW.
+ */
+
+#include "../include/selftest.h"
+#include "../include/console_io.h"
+#include "../include/hashes.h"
+#include "../include/password_stream.h"
+#include "../include/batch_gen.h"
+#include "../include/coordinator.h"
+#include "../include/crypto.h"
+#include "../include/seal.h"
+
+#define STACK_PAINT_SIZE  8192  /**< Stack bytes painted below the stream test's frame */
+#define STACK_PAINT_BYTE  0xA5  /**< Paint pattern */
+#define STACK_TEST_COUNT  2000  /**< Passwords per mode, enough for several pool refills */
+#define COORD_TEST_COUNT   100000  /**< Passwords of the coordinator test */
+#define COORD_TEST_WORKERS 3       /**< Worker processes of the coordinator test */
+#define X25519_ITERATIONS  1000    /**< Iterations of the RFC 7748 section 5.2 iterated test */
+#define SEAL_TEST_LENGTH   16      /**< Password length of the seal round trip */
+
+/** Number of failed tests in the current run */
+static int g_failures = 0;
+
+/**
+ * @brief Compares bytes with a lowercase hexadecimal string and reports the result
+ * @param name Test name
+ * @param actual Computed bytes
+ * @param expectedHex Expected value, two hex digits per byte
+ * @param length Number of bytes
+ */
+static void CheckHex(const char* name, const BYTE* actual, const char* expectedHex, int length) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    char msgBuf[128];
+    BOOL ok = lstrlenA(expectedHex) == length * 2;
+
+    for (int i = 0; ok && i < length; i++) {
+        if (expectedHex[2 * i] != HEX_DIGITS[actual[i] >> 4] || expectedHex[2 * i + 1] != HEX_DIGITS[actual[i] & 0x0F]) ok = FALSE;
+    }
+    if (!ok) g_failures++;
+    wsprintfA(msgBuf, "[TEST] %s: %s\r\n", name, ok ? "OK" : "FAILED");
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Decodes a lowercase hexadecimal test vector
+ * @param out Output, length bytes
+ * @param hex Two hex digits per byte
+ * @param length Number of bytes
+ */
+static void DecodeHex(BYTE* out, const char* hex, int length) {
+    for (int i = 0; i < length; i++) {
+        BYTE high = (BYTE)(hex[2 * i] <= '9' ? hex[2 * i] - '0' : hex[2 * i] - 'a' + 10);
+        BYTE low = (BYTE)(hex[2 * i + 1] <= '9' ? hex[2 * i + 1] - '0' : hex[2 * i + 1] - 'a' + 10);
+        out[i] = (BYTE)((high << 4) | low);
+    }
+}
+
+/**
+ * @brief Compares two byte ranges
+ * @param a First range
+ * @param b Second range
+ * @param length Number of bytes
+ * @return TRUE if they are equal
+ */
+static BOOL SameBytes(const void* a, const void* b, DWORD length) {
+    for (DWORD i = 0; i < length; i++) {
+        if (((const BYTE*)a)[i] != ((const BYTE*)b)[i]) return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Tests the hash functions used by crack-time calibration
+ */
+static void TestHashes(void) {
+    static const BYTE BCRYPT_SALT[BCRYPT_SALT_SIZE] = {
+        0x10, 0x41, 0x04, 0x10, 0x41, 0x04, 0x10, 0x41, 0x04, 0x10, 0x41, 0x04, 0x10, 0x41, 0x04, 0x10
+    };
+    BYTE digest[BLAKE2B_MAX_OUT];
+    BYTE password[32], salt[16], secret[8], ad[12];
+    Argon2Params params;
+
+    Md5Short((const BYTE*)"abc", 3, digest);
+    CheckHex("MD5 (RFC 1321)", digest, "900150983cd24fb0d6963f7d28e17f72", MD5_DIGEST_SIZE);
+    Sha1Short((const BYTE*)"abc", 3, digest);
+    CheckHex("SHA-1 (FIPS 180-4)", digest, "a9993e364706816aba3e25717850c26c9cd0d89d", SHA1_DIGEST_SIZE);
+    Sha256Short((const BYTE*)"abc", 3, digest);
+    CheckHex("SHA-256 (FIPS 180-4)", digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", SHA256_DIGEST_SIZE);
+    Blake2b(digest, BLAKE2B_MAX_OUT, (const BYTE*)"abc", 3, NULL, 0);
+    CheckHex("BLAKE2b-512 (RFC 7693)", digest,
+             "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+             "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923", BLAKE2B_MAX_OUT);
+    Bcrypt((const BYTE*)"U*U", 4, BCRYPT_SALT, 5, digest);
+    CheckHex("bcrypt (OpenBSD)", digest, "1bb69143f9a8d304c8d23d99ab049a77a68e2ccc744206", BCRYPT_HASH_SIZE);
+
+    /* RFC 9106 section 5.3 */
+    FillMemory(password, sizeof(password), 0x01);
+    FillMemory(salt, sizeof(salt), 0x02);
+    FillMemory(secret, sizeof(secret), 0x03);
+    FillMemory(ad, sizeof(ad), 0x04);
+    params.password = password;
+    params.passwordLength = sizeof(password);
+    params.salt = salt;
+    params.saltLength = sizeof(salt);
+    params.secret = secret;
+    params.secretLength = sizeof(secret);
+    params.ad = ad;
+    params.adLength = sizeof(ad);
+    params.passes = 3;
+    params.memoryKiB = 32;
+    params.lanes = 4;
+    BYTE* memory = (BYTE*)HeapAlloc(GetProcessHeap(), 0, Argon2MemorySize(params.memoryKiB, params.lanes));
+    if (!memory) {
+        ConsoleWrite("[TEST] Argon2id (RFC 9106): FAILED\r\n");
+        g_failures++;
+        return;
+    }
+    Argon2id(&params, digest, 32, memory);
+    HeapFree(GetProcessHeap(), 0, memory);
+    CheckHex("Argon2id (RFC 9106)", digest, "0d640df58d78766c08c037a34a8b53c9d01ef0452d75b65eb52520e96b01e659", 32);
+}
+
+/**
+ * @brief Minimal RandomFillProc for the stack test (xorshift32, not secure)
+ * @param context Pointer to the DWORD state
+ * @param buffer Buffer to fill
+ * @param length Number of bytes
+ * @return TRUE
+ */
+static BOOL TestFill(void* context, BYTE* buffer, DWORD length) {
+    DWORD* state = (DWORD*)context;
+    for (DWORD i = 0; i < length; i++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 17;
+        *state ^= *state << 5;
+        buffer[i] = (BYTE)*state;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Fills the stack area below the caller's frame with STACK_PAINT_BYTE
+ * @details Must not be inlined: its frame has to occupy the same addresses as the
+ *          stream calls that follow and the scan that measures them.
+ */
+static __attribute__((noinline)) void PaintStack(void) {
+    volatile BYTE area[STACK_PAINT_SIZE];
+    for (int i = 0; i < STACK_PAINT_SIZE; i++) area[i] = STACK_PAINT_BYTE;
+    (void)area;
+}
+
+/**
+ * @brief Counts the painted bytes that were overwritten since PaintStack()
+ * @return Bytes from the deepest overwritten byte to the top of the area
+ * @details The stack grows down, so the scan starts at the lowest address and
+ *          stops at the first byte that no longer holds the pattern.
+ */
+static __attribute__((noinline)) int ScanStack(void) {
+    volatile BYTE area[STACK_PAINT_SIZE];
+    int untouched = 0;
+    while (untouched < STACK_PAINT_SIZE && area[untouched] == STACK_PAINT_BYTE) untouched++;
+    return STACK_PAINT_SIZE - untouched;
+}
+
+/**
+ * @brief Checks the stream's stack usage against STREAM_STACK_BOUND
+ * @details Opens and runs streams in default, bounded, leading-rule and
+ *          restricted-symbol mode between painting and scanning, with a fill
+ *          function that calls nothing, as STREAM_STACK_BOUND assumes.
+ */
+static void TestStreamStack(void) {
+    static PasswordStream stream;
+    PasswordConfig configs[3];
+    DWORD state = 0x12345678;
+    char msgBuf[128];
+    BOOL ok = TRUE;
+
+    for (int m = 0; m < 3; m++) {
+        ParseArguments(NULL, 0, &configs[m]);
+    }
+    configs[1].bounded = TRUE;
+    configs[2].noLeadingDigit = TRUE;
+    configs[2].noLeadingSymbol = TRUE;
+    lstrcpyA(configs[2].symbolSet, "!@#");
+
+    PaintStack();
+    for (int m = 0; m < 3 && ok; m++) {
+        if (!StreamOpenWithSource(&stream, &configs[m], TestFill, &state)) {
+            ok = FALSE;
+            break;
+        }
+        for (int i = 0; i < STACK_TEST_COUNT && ok; i++) {
+            if (!StreamNext(&stream, NULL)) ok = FALSE;
+        }
+        StreamClose(&stream);
+    }
+    int used = ScanStack();
+
+    if (!ok || used > STREAM_STACK_BOUND) {
+        ok = FALSE;
+        g_failures++;
+    }
+    wsprintfA(msgBuf, "[TEST] Stream stack usage (%d of %d bytes): %s\r\n", used, STREAM_STACK_BOUND, ok ? "OK" : "FAILED");
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Checks that every record of a coordinator test file has the policy's shape
+ * @param path Output file
+ * @param count Expected records
+ * @param stride Bytes per record
+ * @return TRUE if the file holds count records of 10 letters, 4 digits and 2 symbols
+ */
+static BOOL CheckCoordinatorOutput(const WCHAR* path, int count, int stride) {
+    HANDLE hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return FALSE;
+
+    DWORD size = (DWORD)count * (DWORD)stride;
+    DWORD got = 0;
+    char* data = (char*)HeapAlloc(GetProcessHeap(), 0, size + 1);
+    BOOL ok = data && ReadFile(hFile, data, size + 1, &got, NULL) && got == size;
+    CloseHandle(hFile);
+
+    for (int r = 0; ok && r < count; r++) {
+        const char* record = data + (SIZE_T)r * stride;
+        int letters = 0, digits = 0, symbols = 0;
+        for (int i = 0; i < stride - 2; i++) {
+            char c = record[i];
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) letters++;
+            else if (c >= '0' && c <= '9') digits++;
+            else if (c > ' ' && c <= '~') symbols++;
+        }
+        ok = letters == 10 && digits == 4 && symbols == 2 && record[stride - 2] == '\r' && record[stride - 1] == '\n';
+    }
+    if (data) {
+        SecureZeroMemory(data, size);
+        HeapFree(GetProcessHeap(), 0, data);
+    }
+    return ok;
+}
+
+/**
+ * @brief Runs a coordinated job with real worker processes and kills one
+ * @details The first worker to connect is terminated while it holds its second
+ *          range; the job must still write every record, with the lost range
+ *          generated by another worker or by the coordinator.
+ */
+static void TestCoordinator(void) {
+    static const WCHAR* const ARGS[] = { L"WinPass.exe", L"--letters=10", L"--numbers=4", L"--symbols=2" };
+    PasswordConfig config;
+    CoordinatorStats stats;
+    WCHAR path[MAX_PATH];
+    char msgBuf[192];
+    int argCount = sizeof(ARGS) / sizeof(ARGS[0]);
+
+    DWORD len = GetTempPathW(MAX_PATH - 24, path);
+    BOOL ok = len > 0 && len < MAX_PATH - 24 && ParseArguments((LPWSTR*)ARGS, argCount, &config);
+    if (ok) {
+        lstrcatW(path, L"winpass_selftest.txt");
+        config.count = COORD_TEST_COUNT;
+        config.outputPath = path;
+        config.workers = COORD_TEST_WORKERS;
+        ok = RunCoordinator(&config, (LPWSTR*)ARGS, argCount, 0, &stats) &&
+             stats.failedWorkers == 1 && stats.reassigned + stats.local > 0 &&
+             CheckCoordinatorOutput(path, COORD_TEST_COUNT, BatchRecordStride(&config));
+        DeleteFileW(path);
+    }
+
+    if (!ok) g_failures++;
+    wsprintfA(msgBuf, "[TEST] Coordinator, %d worker processes, one killed (%d reassigned, %d local): %s\r\n",
+              COORD_TEST_WORKERS, ok ? stats.reassigned : 0, ok ? stats.local : 0, ok ? "OK" : "FAILED");
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Tests X25519 against RFC 7748, through both the single and the batched path
+ */
+static void TestCurve25519(void) {
+    BYTE scalar[2][X25519_KEY_SIZE], point[2][X25519_KEY_SIZE], out[2][X25519_KEY_SIZE];
+    BYTE k[X25519_KEY_SIZE], u[X25519_KEY_SIZE];
+    X25519Job jobs[2];
+
+    /* Section 5.2, the two single-call vectors, computed as one batch */
+    DecodeHex(scalar[0], "a546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4", X25519_KEY_SIZE);
+    DecodeHex(point[0], "e6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c", X25519_KEY_SIZE);
+    DecodeHex(scalar[1], "4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d", X25519_KEY_SIZE);
+    DecodeHex(point[1], "e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493", X25519_KEY_SIZE);
+    for (int i = 0; i < 2; i++) {
+        jobs[i].scalar = scalar[i];
+        jobs[i].point = point[i];
+        jobs[i].out = out[i];
+    }
+    X25519Batch(jobs, 2);
+    CheckHex("X25519 (RFC 7748 5.2, vector 1)", out[0],
+             "c3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552", X25519_KEY_SIZE);
+    CheckHex("X25519 (RFC 7748 5.2, vector 2)", out[1],
+             "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957", X25519_KEY_SIZE);
+
+    /* Section 5.2, iterated: k, u = X25519(k, u), k */
+    CopyMemory(k, X25519_BASE_POINT, X25519_KEY_SIZE);
+    CopyMemory(u, X25519_BASE_POINT, X25519_KEY_SIZE);
+    for (int i = 0; i < X25519_ITERATIONS; i++) {
+        X25519(out[0], k, u);
+        CopyMemory(u, k, X25519_KEY_SIZE);
+        CopyMemory(k, out[0], X25519_KEY_SIZE);
+    }
+    CheckHex("X25519 (RFC 7748 5.2, 1000 iterations)", k,
+             "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51", X25519_KEY_SIZE);
+
+    /* Section 6.1, Diffie-Hellman */
+    DecodeHex(scalar[0], "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a", X25519_KEY_SIZE);
+    DecodeHex(scalar[1], "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb", X25519_KEY_SIZE);
+    X25519(out[0], scalar[0], X25519_BASE_POINT);
+    CheckHex("X25519 public key (RFC 7748 6.1, Alice)", out[0],
+             "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a", X25519_KEY_SIZE);
+    X25519(out[1], scalar[1], X25519_BASE_POINT);
+    CheckHex("X25519 public key (RFC 7748 6.1, Bob)", out[1],
+             "de9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f", X25519_KEY_SIZE);
+    X25519(k, scalar[0], out[1]);
+    CheckHex("X25519 shared secret (RFC 7748 6.1, Alice)", k,
+             "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742", X25519_KEY_SIZE);
+    X25519(k, scalar[1], out[0]);
+    CheckHex("X25519 shared secret (RFC 7748 6.1, Bob)", k,
+             "4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742", X25519_KEY_SIZE);
+}
+
+/**
+ * @brief Tests Poly1305 and ChaCha20-Poly1305 against RFC 8439
+ */
+static void TestAead(void) {
+    static const char PLAINTEXT[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one "
+                                    "tip for the future, sunscreen would be it.";
+    static const char MESSAGE[] = "Cryptographic Forum Research Group";
+    BYTE key[AEAD_KEY_SIZE], nonce[AEAD_NONCE_SIZE], aad[12];
+    BYTE ciphertext[sizeof(PLAINTEXT) - 1], opened[sizeof(PLAINTEXT) - 1], tag[AEAD_TAG_SIZE];
+    DWORD length = sizeof(PLAINTEXT) - 1;
+
+    /* Section 2.5.2 */
+    DecodeHex(key, "85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b", AEAD_KEY_SIZE);
+    Poly1305Mac(tag, (const BYTE*)MESSAGE, sizeof(MESSAGE) - 1, key);
+    CheckHex("Poly1305 (RFC 8439 2.5.2)", tag, "a8061dc1305136c6c22b8baf0c0127a9", AEAD_TAG_SIZE);
+
+    /* Section 2.8.2 */
+    for (int i = 0; i < AEAD_KEY_SIZE; i++) key[i] = (BYTE)(0x80 + i);
+    DecodeHex(nonce, "070000004041424344454647", AEAD_NONCE_SIZE);
+    DecodeHex(aad, "50515253c0c1c2c3c4c5c6c7", sizeof(aad));
+    AeadSeal(ciphertext, tag, (const BYTE*)PLAINTEXT, length, aad, sizeof(aad), key, nonce);
+    CheckHex("ChaCha20-Poly1305 ciphertext (RFC 8439 2.8.2)", ciphertext,
+             "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+             "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+             "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+             "3ff4def08e4b7a9de576d26586cec64b6116", (int)length);
+    CheckHex("ChaCha20-Poly1305 tag (RFC 8439 2.8.2)", tag, "1ae10b594f09e26a7e902ecbd0600691", AEAD_TAG_SIZE);
+
+    BOOL ok = AeadOpen(opened, ciphertext, length, tag, aad, sizeof(aad), key, nonce) &&
+              SameBytes(opened, PLAINTEXT, length);
+    ciphertext[0] ^= 1;
+    ok = ok && !AeadOpen(opened, ciphertext, length, tag, aad, sizeof(aad), key, nonce);
+    if (!ok) g_failures++;
+    ConsoleWrite(ok ? "[TEST] ChaCha20-Poly1305 open, then reject a flipped bit: OK\r\n"
+                    : "[TEST] ChaCha20-Poly1305 open, then reject a flipped bit: FAILED\r\n");
+}
+
+/**
+ * @brief Passwords received by CollectOpened()
+ */
+typedef struct {
+    int count;                          /**< Passwords received */
+    int length;                         /**< Length of the last one */
+    char password[SEAL_TEST_LENGTH];    /**< Last password */
+} OpenedPasswords;
+
+/**
+ * @brief SealedPasswordProc that keeps the last password
+ * @param context OpenedPasswords to fill
+ * @param password Password
+ * @param length Password length
+ */
+static void CollectOpened(void* context, const char* password, int length) {
+    OpenedPasswords* opened = (OpenedPasswords*)context;
+    opened->count++;
+    opened->length = length;
+    if (length == SEAL_TEST_LENGTH) CopyMemory(opened->password, password, SEAL_TEST_LENGTH);
+}
+
+/**
+ * @brief Opens sealed text with a secret key and checks it yields exactly one password
+ * @param sealed Sealed records
+ * @param size Bytes of sealed
+ * @param secret Secret key
+ * @param expected Expected password, SEAL_TEST_LENGTH characters
+ * @return TRUE if exactly that password opened and no line was malformed
+ */
+static BOOL OpensTo(const char* sealed, DWORD size, const BYTE* secret, const char* expected) {
+    OpenedPasswords opened;
+    BOOL malformed;
+
+    opened.count = 0;
+    opened.length = 0;
+    int count = OpenSealedRecords(sealed, size, secret, CollectOpened, &opened, &malformed);
+    return count == 1 && opened.count == 1 && !malformed && opened.length == SEAL_TEST_LENGTH &&
+           SameBytes(opened.password, expected, SEAL_TEST_LENGTH);
+}
+
+/**
+ * @brief Seals two passwords to the RFC 7748 section 6.1 keys and opens them again
+ * @details Each key must open its own record and skip the other one, and a
+ *          record with a changed ciphertext digit must not open.
+ */
+static void TestSealRoundTrip(void) {
+    static const char RECORDS[] = "k7#Qv9!mZp2$Lx4w\r\nR8&tB3*nW6^cJ1%e\r\n";
+    BYTE keys[2 * X25519_KEY_SIZE], secret[2][X25519_KEY_SIZE];
+    char sealed[2 * SEAL_RECORD_STRIDE(SEAL_TEST_LENGTH)];
+    int sealedStride = SEAL_RECORD_STRIDE(SEAL_TEST_LENGTH);
+    RecipientList recipients;
+
+    DecodeHex(secret[0], "77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a", X25519_KEY_SIZE);
+    DecodeHex(secret[1], "5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb", X25519_KEY_SIZE);
+    X25519(keys, secret[0], X25519_BASE_POINT);
+    X25519(keys + X25519_KEY_SIZE, secret[1], X25519_BASE_POINT);
+    recipients.count = 2;
+    recipients.keys = keys;
+
+    BOOL ok = SealRecords(RECORDS, SEAL_TEST_LENGTH + 2, &recipients, sealed, NULL) &&
+              OpensTo(sealed, sizeof(sealed), secret[0], RECORDS) &&
+              OpensTo(sealed, sizeof(sealed), secret[1], RECORDS + SEAL_TEST_LENGTH + 2);
+
+    /* Change one ciphertext digit of Alice's record: Alice opens nothing, Bob still opens his */
+    int digit = 2 * (SEAL_KEY_ID_SIZE + X25519_KEY_SIZE);
+    sealed[digit] = sealed[digit] == '0' ? '1' : '0';
+    if (ok) {
+        OpenedPasswords opened;
+        BOOL malformed;
+        opened.count = 0;
+        ok = OpenSealedRecords(sealed, (DWORD)sealedStride, secret[0], CollectOpened, &opened, &malformed) == 0 &&
+             opened.count == 0 && OpensTo(sealed, sizeof(sealed), secret[1], RECORDS + SEAL_TEST_LENGTH + 2);
+    }
+
+    if (!ok) g_failures++;
+    ConsoleWrite(ok ? "[TEST] Seal to two recipients, open each, reject a changed record: OK\r\n"
+                    : "[TEST] Seal to two recipients, open each, reject a changed record: FAILED\r\n");
+}
+
+/**
+ * @brief Runs every known-answer test and prints one line per test
+ * @return TRUE if all tests passed, FALSE otherwise
+ */
+BOOL RunSelfTests(void) {
+    char msgBuf[64];
+
+    g_failures = 0;
+    TestHashes();
+    TestCurve25519();
+    TestAead();
+    TestSealRoundTrip();
+    TestStreamStack();
+    TestCoordinator();
+
+    if (g_failures == 0) {
+        ConsoleWrite("[SUCCESS] All self-tests passed.\r\n");
+        return TRUE;
+    }
+    wsprintfA(msgBuf, "[ERROR] %d self-test(s) failed.\r\n", g_failures);
+    ConsoleWrite(msgBuf);
+    return FALSE;
+}
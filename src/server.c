@@ -0,0 +1,1304 @@
+/**
+ * @file server.c
+ * @brief Serving mode implementation with request coalescing and fair scheduling
+ * @details A reader thread stamps request lines as they arrive. The serving
+ *          thread parses them (rejecting over-limit requests at once), waits out
+ *          the coalescing window and releases the waiting requests as groups of
+ *          one policy and tenant. A pool of worker threads generates the groups
+ *          SERVE_CHUNK_PASSWORDS records at a time; every free worker picks its
+ *          next chunk from the interactive share first, then by weighted deficit
+ *          round-robin across tenants, so fairness holds while the pool is busy
+ *          and not only when requests are released. The serving thread writes
+ *          each group's responses as soon as its last chunk is done.
+ */
+
+#include "../include/server.h"
+#include "../include/cli_parser.h"
+#include "../include/batch_gen.h"
+#include "../include/password_stream.h"
+#include "../include/console_io.h"
+#include "../include/profile.h"
+#include "../include/profile_cache.h"
+#include "../include/utils.h"
+
+#define NO_REQUEST (-1)  /**< End marker of request lists */
+#define NO_GROUP   (-1)  /**< End marker of group lists */
+
+/**
+ * @brief One parsed request
+ * @details Slots live in a fixed pool and are linked into the free list, the
+ *          pending list or a group's request list through next.
+ */
+typedef struct {
+    PasswordConfig config;  /**< Parsed request flags */
+    const char* error;      /**< Error reason, NULL if the request is valid */
+    DWORD seq;              /**< 1-based request line number, echoed in the response */
+    BOOL interactive;       /**< Set from the tenant's Interactive key */
+    BOOL control;           /**< Control command (RELOAD) acknowledged with "OK <seq> 0" */
+    int tenant;             /**< Index into the tenant table, -1 if not registered */
+    LONGLONG arrival;       /**< Performance counter value when the line arrived */
+    int group;              /**< Group generating this request, NO_GROUP if none */
+    int first;              /**< First record of this request inside the group buffer */
+    int next;               /**< Next request in the same list */
+} ServeRequest;
+
+/**
+ * @brief FIFO list of request slots or groups
+ */
+typedef struct {
+    int head;  /**< First entry, NO_REQUEST / NO_GROUP if empty */
+    int tail;  /**< Last entry */
+} RequestQueue;
+
+/**
+ * @brief One request line, stamped by the reader thread
+ */
+typedef struct {
+    LONGLONG arrival;           /**< Performance counter value when the line's last byte was read */
+    int length;                 /**< Line length without CR/LF; above SERVE_LINE_MAX if too long */
+    char text[SERVE_LINE_MAX];  /**< First SERVE_LINE_MAX bytes of the line */
+} InputLine;
+
+/**
+ * @brief Lines handed from the reader thread to the serving thread
+ * @details A ring of SERVE_INPUT_LINES lines. When it is full the reader stops
+ *          reading, so under sustained overload further lines wait in the pipe
+ *          and are stamped when they are read.
+ */
+typedef struct {
+    HANDLE hIn;                          /**< Standard input */
+    CRITICAL_SECTION lock;               /**< Guards head, count and ended */
+    HANDLE hLinesReady;                  /**< Auto-reset: lines added or input ended */
+    HANDLE hSpaceReady;                  /**< Auto-reset: the serving thread took lines */
+    InputLine lines[SERVE_INPUT_LINES];  /**< Ring of complete lines */
+    int head;                            /**< Oldest line */
+    int count;                           /**< Lines in the ring */
+    BOOL ended;                          /**< QUIT, end of input or read error */
+    BOOL stop;                           /**< Set by the serving thread to stop reading */
+} InputReader;
+
+/**
+ * @brief Latency histogram for the final summary
+ */
+typedef struct {
+    DWORD requests;                            /**< Requests answered */
+    DWORD latency[SERVE_LATENCY_BUCKETS];      /**< Requests per log2(us) latency bucket */
+} ServeStats;
+
+/**
+ * @brief Configuration and admission state of one tenant
+ */
+typedef struct {
+    char name[SERVE_TENANT_NAME];  /**< Tenant name from --tenant= ("default" if untagged) */
+    int weight;                    /**< Share of bulk capacity relative to other tenants */
+    BOOL interactive;              /**< Requests use the reserved interactive share */
+    DWORD rate;                    /**< Token refill in passwords per second, 0 = unlimited */
+    DWORD burst;                   /**< Bucket capacity in passwords */
+    LONGLONG tokens;               /**< Available tokens in 1/1000 password units */
+    DWORD lastRefill;              /**< GetTickCount() of the last refill */
+    ServeStats stats;              /**< Latency of this tenant's generated requests */
+} ServeTenant;
+
+/**
+ * @brief Requests of one tenant and policy, generated as one unit
+ * @details Built by the serving thread when requests are released. Workers take
+ *          SERVE_CHUNK_PASSWORDS records at a time from nextRecord; the worker
+ *          that finishes the last chunk moves the group to the done list.
+ */
+typedef struct {
+    const PasswordConfig* config;  /**< Policy of the group (points at its first request) */
+    int tenant;                    /**< Tenant of every request in the group */
+    BOOL interactive;              /**< Generated from the interactive share */
+    int total;                     /**< Passwords needed by all requests of the group */
+    int stride;                    /**< Record stride of the policy */
+    char* records;                 /**< Generated records, NULL if allocation failed */
+    RequestQueue requests;         /**< Requests of the group in arrival order */
+    int requestCount;              /**< Requests in the group */
+    DWORD serial;                  /**< Release number, so workers can tell groups apart */
+    int nextRecord;                /**< Next record to hand out (pool lock) */
+    int pendingRecords;            /**< Records not yet generated (pool lock) */
+    BOOL failed;                   /**< Generation failed for some record (pool lock) */
+    int next;                      /**< Next group in a run list, the done list or the free list */
+} ServeGroup;
+
+/**
+ * @brief Work shared by the serving thread and the worker threads
+ * @details Costs are counted in characters (passwords times record stride),
+ *          so a tenant asking for long passwords uses up its share sooner.
+ */
+typedef struct {
+    CRITICAL_SECTION lock;                    /**< Guards everything below except groups */
+    HANDLE hWork;                             /**< Semaphore: one count per chunk, one per worker at shutdown */
+    HANDLE hDone;                             /**< Auto-reset: a group moved to the done list */
+    ServeGroup* groups;                       /**< Group table owned by the serving thread */
+    RequestQueue interactive;                 /**< Interactive groups of all tenants, FIFO */
+    RequestQueue bulk[SERVE_MAX_TENANTS];     /**< Bulk groups per tenant, FIFO */
+    int weight[SERVE_MAX_TENANTS];            /**< Copy of each tenant's Weight */
+    LONGLONG deficit[SERVE_MAX_TENANTS];      /**< Deficit round-robin credit in characters */
+    int tenantCount;                          /**< Tenants that have had bulk groups */
+    int roundRobin;                           /**< Tenant whose turn it is */
+    int bulkGroups;                           /**< Groups in the bulk run lists */
+    int busyWorkers;                          /**< Workers generating a chunk */
+    LONGLONG interactiveCredit;               /**< Characters interactive groups may take ahead of bulk */
+    RequestQueue done;                        /**< Finished groups waiting to be written */
+    BOOL coalesce;                            /**< Reuse a worker's stream across groups of one policy */
+} ServePool;
+
+/**
+ * @brief One worker thread of the pool
+ */
+typedef struct {
+    ServePool* pool;
+    HCRYPTPROV hCryptProv;   /**< CryptoAPI context kept for the thread's lifetime */
+    PasswordStream stream;   /**< Stream of the last policy generated */
+    BOOL open;               /**< stream is open */
+    DWORD serial;            /**< Group the stream was opened for */
+    int maxDraws;            /**< Most random draws any password of this worker needed */
+} ServeWorker;
+
+/**
+ * @brief Whole server state, kept static because of its size
+ */
+typedef struct {
+    ServeRequest slots[SERVE_MAX_QUEUED];  /**< Request pool */
+    int freeList;                          /**< Unused slots */
+    RequestQueue pending;                  /**< Requests waiting out the window, in arrival order */
+    int pendingCount;
+    int pendingPasswords;
+    int answers[SERVE_MAX_QUEUED];         /**< Rejected requests and control commands for the next write */
+    int answerCount;
+    ServeGroup groups[SERVE_MAX_QUEUED];   /**< Group table; a group holds at least one request */
+    int freeGroups;
+    int released[SERVE_MAX_QUEUED];        /**< Groups built by the current release */
+    int inFlight;                          /**< Groups released and not yet written */
+    LONGLONG lastArrival;                  /**< Arrival stamp of the last generation request */
+    LONGLONG arrivalGap;                   /**< Moving average of the time between them, in counter ticks */
+    DWORD nextSerial;
+    ServeTenant tenants[SERVE_MAX_TENANTS];
+    int tenantCount;
+    DWORD nextSeq;
+    BOOL coalesce;
+    ServeStats all;
+    ServeStats interactiveStats;
+    DWORD groupsServed;
+    char profilePath[MAX_PATH];
+    ServePool pool;
+    ServeWorker workers[MAX_BATCH_THREADS];
+    HANDLE hWorkers[MAX_BATCH_THREADS];
+    int workerCount;
+} ServeState;
+
+/**
+ * @brief Appends a request to the end of a queue
+ * @param state Server state
+ * @param queue Queue to append to
+ * @param index Request slot
+ */
+static void QueuePush(ServeState* state, RequestQueue* queue, int index) {
+    state->slots[index].next = NO_REQUEST;
+    if (queue->head == NO_REQUEST) queue->head = index;
+    else state->slots[queue->tail].next = index;
+    queue->tail = index;
+}
+
+/**
+ * @brief Removes the first request of a queue
+ * @param state Server state
+ * @param queue Non-empty queue
+ * @return Removed request slot
+ */
+static int QueuePop(ServeState* state, RequestQueue* queue) {
+    int index = queue->head;
+    queue->head = state->slots[index].next;
+    return index;
+}
+
+/**
+ * @brief Appends a group to the end of a queue
+ * @param groups Group table
+ * @param queue Queue to append to
+ * @param index Group
+ */
+static void GroupPush(ServeGroup* groups, RequestQueue* queue, int index) {
+    groups[index].next = NO_GROUP;
+    if (queue->head == NO_GROUP) queue->head = index;
+    else groups[queue->tail].next = index;
+    queue->tail = index;
+}
+
+/**
+ * @brief Compares the generation policy of two configurations
+ * @param a First configuration
+ * @param b Second configuration
+ * @return TRUE if both produce passwords from the same distribution
+ */
+static BOOL SamePolicy(const PasswordConfig* a, const PasswordConfig* b) {
+    return a->useLetters == b->useLetters && a->useNumbers == b->useNumbers &&
+           a->useSymbols == b->useSymbols && a->letterLength == b->letterLength &&
+           a->numberLength == b->numberLength && a->symbolLength == b->symbolLength &&
+           a->bounded == b->bounded && a->noLeadingDigit == b->noLeadingDigit &&
+           a->noLeadingSymbol == b->noLeadingSymbol && lstrcmpA(a->symbolSet, b->symbolSet) == 0;
+}
+
+/**
+ * @brief Copies a --tenant= value, rejecting names that cannot be a section name
+ * @param value Value after "--tenant="
+ * @param name Output buffer of SERVE_TENANT_NAME characters
+ * @return FALSE if the value is empty, too long or has a character other than
+ *         letters, digits, '-', '_' and '.'
+ */
+static BOOL CopyTenantName(const WCHAR* value, char* name) {
+    int j = 0;
+    for (; value[j] != L'\0'; j++) {
+        WCHAR c = value[j];
+        BOOL allowed = (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (c >= L'0' && c <= L'9') ||
+                       c == L'-' || c == L'_' || c == L'.';
+        if (!allowed || j == SERVE_TENANT_NAME - 1) return FALSE;
+        name[j] = (char)c;
+    }
+    name[j] = '\0';
+    return j > 0;
+}
+
+/**
+ * @brief Finds a tenant by name, registering it on first use
+ * @param state Server state
+ * @param name Valid tenant name
+ * @return Tenant index, or -1 if the tenant table is full
+ * @details Names are compared case-insensitively, like the INI sections they
+ *          map to, so "Web" and "web" share one bucket. Settings are read once
+ *          from the [Tenant.NAME] section of the profile file: Weight (default 1),
+ *          Interactive (default 0), Rate in passwords/sec (default 0 = unlimited)
+ *          and Burst (default max(Rate, SERVE_MAX_COUNT)).
+ */
+static int FindTenant(ServeState* state, const char* name) {
+    char section[sizeof(SERVE_TENANT_PREFIX) + SERVE_TENANT_NAME];
+
+    for (int t = 0; t < state->tenantCount; t++) {
+        if (lstrcmpiA(state->tenants[t].name, name) == 0) return t;
+    }
+    if (state->tenantCount == SERVE_MAX_TENANTS) return -1;
+
+    ServeTenant* tenant = &state->tenants[state->tenantCount];
+    lstrcpyA(tenant->name, name);
+    wsprintfA(section, "%s%s", SERVE_TENANT_PREFIX, name);
+
+    tenant->weight = (int)GetPrivateProfileIntA(section, "Weight", 1, state->profilePath);
+    if (tenant->weight < 1) tenant->weight = 1;
+    tenant->interactive = GetPrivateProfileIntA(section, "Interactive", 0, state->profilePath) != 0;
+    tenant->rate = GetPrivateProfileIntA(section, "Rate", 0, state->profilePath);
+    tenant->burst = GetPrivateProfileIntA(section, "Burst", 0, state->profilePath);
+    if (tenant->burst == 0) tenant->burst = tenant->rate > SERVE_MAX_COUNT ? tenant->rate : SERVE_MAX_COUNT;
+
+    /* Start with a full bucket */
+    tenant->tokens = (LONGLONG)tenant->burst * 1000;
+    tenant->lastRefill = GetTickCount();
+    return state->tenantCount++;
+}
+
+/**
+ * @brief Takes count tokens from a tenant's bucket
+ * @param tenant Tenant to charge
+ * @param count Passwords requested
+ * @return TRUE if admitted, FALSE if the tenant is over its rate
+ */
+static BOOL AdmitTenant(ServeTenant* tenant, int count) {
+    if (tenant->rate == 0) return TRUE;
+
+    /* rate passwords/s == rate milli-passwords per millisecond */
+    DWORD now = GetTickCount();
+    tenant->tokens += (LONGLONG)(now - tenant->lastRefill) * tenant->rate;
+    if (tenant->tokens > (LONGLONG)tenant->burst * 1000) tenant->tokens = (LONGLONG)tenant->burst * 1000;
+    tenant->lastRefill = now;
+
+    if (tenant->tokens < (LONGLONG)count * 1000) return FALSE;
+    tenant->tokens -= (LONGLONG)count * 1000;
+    return TRUE;
+}
+
+/** Flags a request line may carry; everything else is rejected before parsing */
+static const char* const g_requestFlags[] = {
+    "--no-letters", "--no-numbers", "--no-symbols", "--bounded"
+};
+static const char* const g_requestValueFlags[] = {
+    "--letters=", "-l=", "--numbers=", "-n=", "--symbols=", "-s=", "--count=", "-c=", "--profile=", "-p="
+};
+
+/**
+ * @brief Checks a request token against the flags a client may send
+ * @param token Wide token from the request line
+ * @return NULL if allowed, otherwise the error to answer with
+ * @details Runs before ParseArguments(), which maps deny-lists, compiles plans
+ *          and opens files as it goes. A --profile whose rule keys would need a
+ *          composition plan is looked up in the snapshot and rejected here too.
+ */
+static const char* CheckRequestFlag(const WCHAR* token) {
+    char name[MAX_PROFILE_NAME];
+    ProfileEntry entry;
+    BOOL allowed = FALSE;
+
+    for (int k = 0; k < (int)(sizeof(g_requestFlags) / sizeof(g_requestFlags[0])) && !allowed; k++) {
+        allowed = WStrEquals(token, g_requestFlags[k]);
+    }
+    for (int k = 0; k < (int)(sizeof(g_requestValueFlags) / sizeof(g_requestValueFlags[0])) && !allowed; k++) {
+        allowed = WStrStartsWith(token, g_requestValueFlags[k]);
+    }
+    if (!allowed) return "flag not allowed in serve mode";
+    if (!WStrStartsWith(token, "--profile=") && !WStrStartsWith(token, "-p=")) return NULL;
+
+    /* Names ParseArguments() would reject are left to it to report */
+    const WCHAR* value = ExtractStringFromArg(token);
+    int j = 0;
+    while (value[j] != L'\0' && j < MAX_PROFILE_NAME - 1) {
+        name[j] = (char)value[j];
+        j++;
+    }
+    name[j] = '\0';
+    if (j == 0 || value[j] != L'\0') return NULL;
+
+    if (!FindProfile(name, &entry)) return "invalid flags";
+    /* Plans are per process; request slots do not own one */
+    return ProfileHasRules(&entry) ? "flag not allowed in serve mode" : NULL;
+}
+
+/**
+ * @brief Parses one request line into a configuration
+ * @param state Server state (for tenant lookup)
+ * @param line Request text (not null-terminated)
+ * @param length Length of the line without CR/LF
+ * @param request Output request; request->error is set on failure
+ * @details --tenant=NAME is consumed here; every other token must pass
+ *          CheckRequestFlag() before any is passed to ParseArguments(). The
+ *          tenant is registered only once the request has passed validation,
+ *          so malformed lines cannot fill the table.
+ */
+static void ParseRequest(ServeState* state, const char* line, int length, ServeRequest* request) {
+    static WCHAR programName[] = L"serve";
+    WCHAR wideBuf[SERVE_LINE_MAX * 2];
+    LPWSTR args[SERVE_MAX_ARGS + 1];
+    char tenantName[SERVE_TENANT_NAME];
+    int argc = 0;
+    int w = 0;
+    int i = 0;
+
+    request->error = NULL;
+    request->group = NO_GROUP;
+    request->interactive = FALSE;
+    request->control = FALSE;
+    request->tenant = -1;
+    lstrcpyA(tenantName, "default");
+
+    /* ParseArguments() expects argv-style wide strings with a program name first */
+    args[argc++] = programName;
+    while (i < length) {
+        while (i < length && (line[i] == ' ' || line[i] == '\t')) i++;
+        if (i >= length) break;
+        if (argc > SERVE_MAX_ARGS) {
+            request->error = "too many flags";
+            return;
+        }
+        LPWSTR token = &wideBuf[w];
+        while (i < length && line[i] != ' ' && line[i] != '\t') wideBuf[w++] = (WCHAR)(BYTE)line[i++];
+        wideBuf[w++] = L'\0';
+
+        /* Scheduling settings are not generation flags */
+        if (WStrEquals(token, "--interactive")) {
+            /* A client cannot promote itself; Interactive=1 in the tenant section does */
+            request->error = "interactive is set per tenant";
+            return;
+        } else if (WStrStartsWith(token, "--tenant=")) {
+            if (!CopyTenantName(ExtractStringFromArg(token), tenantName)) {
+                request->error = "invalid tenant";
+                return;
+            }
+        } else {
+            args[argc++] = token;
+        }
+    }
+
+    /* Nothing is parsed until every flag is known to be allowed */
+    for (int k = 1; k < argc; k++) {
+        request->error = CheckRequestFlag(args[k]);
+        if (request->error) return;
+    }
+    if (!ParseArguments(args, argc, &request->config)) {
+        request->error = "invalid flags";
+        return;
+    }
+
+    const PasswordConfig* config = &request->config;
+    int total = BatchRecordStride(config) - 2;
+    if (!config->useLetters && !config->useNumbers && !config->useSymbols) {
+        request->error = "no character type enabled";
+        return;
+    }
+    if (total < MIN_PASSWORD_LENGTH || total > MAX_PASSWORD_LENGTH) {
+        request->error = "length out of range";
+        return;
+    }
+    if (config->count > SERVE_MAX_COUNT) {
+        request->error = "count too large";
+        return;
+    }
+
+    request->tenant = FindTenant(state, tenantName);
+    if (request->tenant < 0) {
+        request->error = "too many tenants";
+        return;
+    }
+
+    ServeTenant* tenant = &state->tenants[request->tenant];
+    if (tenant->rate > 0 && (DWORD)config->count > tenant->burst) {
+        /* Could never be admitted, however long the client waits */
+        request->error = "count exceeds tenant burst";
+    } else if (!AdmitTenant(tenant, config->count)) {
+        request->error = "rate limited";
+    } else {
+        request->interactive = tenant->interactive;
+    }
+}
+
+/**
+ * @brief Records the latency of an answered request
+ * @param stats Histogram to update
+ * @param micros Time from arrival to write completion
+ */
+static void RecordLatency(ServeStats* stats, LONGLONG micros) {
+    int bucket = 0;
+    while (micros > 0 && bucket < SERVE_LATENCY_BUCKETS - 1) {
+        micros >>= 1;
+        bucket++;
+    }
+    stats->latency[bucket]++;
+    stats->requests++;
+}
+
+/**
+ * @brief Characters the next chunk of a group will generate
+ * @param group Group with records left to hand out
+ * @return Chunk cost
+ */
+static LONGLONG ChunkCost(const ServeGroup* group) {
+    int n = group->total - group->nextRecord;
+    if (n > SERVE_CHUNK_PASSWORDS) n = SERVE_CHUNK_PASSWORDS;
+    return (LONGLONG)n * group->stride;
+}
+
+/**
+ * @brief Picks the group the next chunk comes from
+ * @param pool Worker pool (lock held)
+ * @return Group index, NO_GROUP if no work is queued
+ * @details Interactive groups go first while they have credit, or whenever no
+ *          bulk work is waiting. Bulk chunks earn interactive groups credit of
+ *          1/(SERVE_INTERACTIVE_SHARE - 1) of their cost, so under contention
+ *          interactive work gets at least 1/SERVE_INTERACTIVE_SHARE of the pool
+ *          and bulk work is never starved. Bulk groups are served by deficit
+ *          round-robin: a tenant whose credit does not cover its next chunk gets
+ *          SERVE_QUANTUM * Weight characters and passes the turn on.
+ */
+static int PickGroup(ServePool* pool) {
+    if (pool->interactive.head != NO_GROUP && (pool->interactiveCredit > 0 || pool->bulkGroups == 0)) {
+        pool->interactiveCredit -= ChunkCost(&pool->groups[pool->interactive.head]);
+        return pool->interactive.head;
+    }
+    if (pool->bulkGroups == 0) return NO_GROUP;
+
+    for (;;) {
+        int t = pool->roundRobin;
+        int head = pool->bulk[t].head;
+        if (head == NO_GROUP) {
+            /* An idle tenant does not bank credit */
+            pool->deficit[t] = 0;
+        } else {
+            LONGLONG cost = ChunkCost(&pool->groups[head]);
+            if (pool->deficit[t] >= cost) {
+                pool->deficit[t] -= cost;
+                pool->interactiveCredit += cost / (SERVE_INTERACTIVE_SHARE - 1);
+                if (pool->interactiveCredit > SERVE_QUANTUM) pool->interactiveCredit = SERVE_QUANTUM;
+                return head;
+            }
+            pool->deficit[t] += (LONGLONG)SERVE_QUANTUM * pool->weight[t];
+        }
+        pool->roundRobin = (t + 1) % pool->tenantCount;
+    }
+}
+
+/**
+ * @brief Hands out the next chunk of records
+ * @param pool Worker pool (lock held)
+ * @param first Output: first record of the chunk
+ * @param end Output: one past the last record
+ * @return Group of the chunk, NO_GROUP if no work is queued
+ */
+static int TakeChunk(ServePool* pool, int* first, int* end) {
+    int g = PickGroup(pool);
+    if (g == NO_GROUP) return NO_GROUP;
+
+    ServeGroup* group = &pool->groups[g];
+    *first = group->nextRecord;
+    *end = group->total - *first > SERVE_CHUNK_PASSWORDS ? *first + SERVE_CHUNK_PASSWORDS : group->total;
+    group->nextRecord = *end;
+
+    /* Fully handed out: leave the run list */
+    if (group->nextRecord == group->total) {
+        RequestQueue* queue = group->interactive ? &pool->interactive : &pool->bulk[group->tenant];
+        queue->head = group->next;
+        if (!group->interactive) pool->bulkGroups--;
+    }
+    return g;
+}
+
+/**
+ * @brief RandomFillProc backed by the worker's CryptoAPI context
+ * @param context The ServeWorker
+ * @param buffer Buffer to fill
+ * @param length Number of bytes
+ * @return Result of CryptGenRandom
+ */
+static BOOL WorkerRandomFill(void* context, BYTE* buffer, DWORD length) {
+    return CryptGenRandom(((ServeWorker*)context)->hCryptProv, length, buffer);
+}
+
+/**
+ * @brief Closes the worker's stream, keeping its draw statistics
+ * @param worker Worker with an open stream
+ */
+static void WorkerCloseStream(ServeWorker* worker) {
+    if (worker->stream.maxDraws > worker->maxDraws) worker->maxDraws = worker->stream.maxDraws;
+    StreamClose(&worker->stream);
+    worker->open = FALSE;
+}
+
+/**
+ * @brief Generates records [first, end) of a group
+ * @param worker Calling worker
+ * @param group Group the chunk belongs to
+ * @param first First record
+ * @param end One past the last record
+ * @return FALSE if the random source failed
+ * @details With coalescing, the worker keeps its stream, and its random pool,
+ *          across chunks and groups of the same policy. Without it every group
+ *          (one request) opens its own stream and crypto context, as generating
+ *          the request on its own would.
+ */
+static BOOL WorkerGenerate(ServeWorker* worker, const ServeGroup* group, int first, int end) {
+    BOOL reuse = worker->open && (worker->pool->coalesce ? SamePolicy(&worker->stream.config, group->config)
+                                                         : worker->serial == group->serial);
+    if (!reuse) {
+        if (worker->open) WorkerCloseStream(worker);
+        if (worker->pool->coalesce) {
+            worker->open = worker->hCryptProv &&
+                           StreamOpenWithSource(&worker->stream, group->config, WorkerRandomFill, worker);
+        } else {
+            worker->open = StreamOpen(&worker->stream, group->config);
+        }
+        if (!worker->open) return FALSE;
+        worker->serial = group->serial;
+    }
+
+    for (int n = first; n < end; n++) {
+        int length;
+        const char* password = StreamNext(&worker->stream, &length);
+        if (!password) {
+            WorkerCloseStream(worker);
+            return FALSE;
+        }
+
+        char* record = group->records + n * group->stride;
+        for (int i = 0; i < length; i++) record[i] = password[i];
+        record[length] = '\r';
+        record[length + 1] = '\n';
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Worker thread: generates chunks until the pool is stopped
+ * @param param Pointer to ServeWorker
+ * @return 0
+ * @details Every semaphore count stands for one chunk, so a wake-up that finds
+ *          nothing to take is the shutdown signal.
+ */
+static DWORD WINAPI ServeWorkerProc(LPVOID param) {
+    ServeWorker* worker = (ServeWorker*)param;
+    ServePool* pool = worker->pool;
+
+    if (!CryptAcquireContext(&worker->hCryptProv, NULL, NULL, PROV_RSA_FULL, CRYPT_VERIFYCONTEXT)) {
+        worker->hCryptProv = 0;
+    }
+
+    for (;;) {
+        int first = 0;
+        int end = 0;
+
+        WaitForSingleObject(pool->hWork, INFINITE);
+        EnterCriticalSection(&pool->lock);
+        int g = TakeChunk(pool, &first, &end);
+        if (g != NO_GROUP) pool->busyWorkers++;
+        LeaveCriticalSection(&pool->lock);
+        if (g == NO_GROUP) break;
+
+        ServeGroup* group = &pool->groups[g];
+        BOOL generated = WorkerGenerate(worker, group, first, end);
+
+        EnterCriticalSection(&pool->lock);
+        if (!generated) group->failed = TRUE;
+        pool->busyWorkers--;
+        group->pendingRecords -= end - first;
+        BOOL finished = group->pendingRecords == 0;
+        if (finished) GroupPush(pool->groups, &pool->done, g);
+        LeaveCriticalSection(&pool->lock);
+        if (finished) SetEvent(pool->hDone);
+    }
+
+    if (worker->open) WorkerCloseStream(worker);
+    if (worker->hCryptProv) CryptReleaseContext(worker->hCryptProv, 0);
+    return 0;
+}
+
+/**
+ * @brief Hands every pending request to the worker pool
+ * @param state Server state
+ * @details With coalescing, pending requests of the same tenant and policy share
+ *          a group of up to SERVE_MAX_BATCH requests and SERVE_BATCH_PASSWORDS
+ *          passwords; without it every request is its own group.
+ */
+static void ReleasePending(ServeState* state) {
+    ServePool* pool = &state->pool;
+    HANDLE hHeap = GetProcessHeap();
+    int releasedCount = 0;
+    LONG chunks = 0;
+    BOOL failed = FALSE;
+
+    while (state->pending.head != NO_REQUEST) {
+        int index = QueuePop(state, &state->pending);
+        ServeRequest* request = &state->slots[index];
+        ServeGroup* group = NULL;
+
+        if (state->coalesce) {
+            for (int k = 0; k < releasedCount && !group; k++) {
+                ServeGroup* candidate = &state->groups[state->released[k]];
+                if (candidate->tenant == request->tenant && candidate->requestCount < SERVE_MAX_BATCH &&
+                    candidate->total + request->config.count <= SERVE_BATCH_PASSWORDS &&
+                    SamePolicy(candidate->config, &request->config)) {
+                    group = candidate;
+                    request->group = state->released[k];
+                }
+            }
+        }
+        if (!group) {
+            /* Every group holds a request, so a free one always exists */
+            int g = state->freeGroups;
+            group = &state->groups[g];
+            state->freeGroups = group->next;
+
+            group->config = &request->config;
+            group->tenant = request->tenant;
+            group->interactive = request->interactive;
+            group->total = 0;
+            group->stride = BatchRecordStride(&request->config);
+            group->requests.head = NO_REQUEST;
+            group->requestCount = 0;
+            group->serial = state->nextSerial++;
+            group->nextRecord = 0;
+            group->failed = FALSE;
+            state->released[releasedCount++] = g;
+            request->group = g;
+        }
+
+        request->first = group->total;
+        group->total += request->config.count;
+        group->requestCount++;
+        QueuePush(state, &group->requests, index);
+    }
+    state->pendingCount = 0;
+    state->pendingPasswords = 0;
+
+    /* Allocate outside the pool lock */
+    for (int k = 0; k < releasedCount; k++) {
+        ServeGroup* group = &state->groups[state->released[k]];
+        group->records = (char*)HeapAlloc(hHeap, 0, (SIZE_T)group->total * group->stride);
+        group->pendingRecords = group->records ? group->total : 0;
+        group->failed = group->records == NULL;
+    }
+
+    EnterCriticalSection(&pool->lock);
+    for (int k = 0; k < releasedCount; k++) {
+        int g = state->released[k];
+        ServeGroup* group = &state->groups[g];
+        if (group->failed) {
+            /* Answered with an error by the next write */
+            GroupPush(state->groups, &pool->done, g);
+            failed = TRUE;
+            continue;
+        }
+
+        chunks += (group->total + SERVE_CHUNK_PASSWORDS - 1) / SERVE_CHUNK_PASSWORDS;
+        if (group->interactive) {
+            GroupPush(state->groups, &pool->interactive, g);
+        } else {
+            int t = group->tenant;
+            GroupPush(state->groups, &pool->bulk[t], g);
+            pool->weight[t] = state->tenants[t].weight;
+            if (t >= pool->tenantCount) pool->tenantCount = t + 1;
+            pool->bulkGroups++;
+        }
+    }
+    LeaveCriticalSection(&pool->lock);
+
+    state->inFlight += releasedCount;
+    if (chunks > 0) ReleaseSemaphore(pool->hWork, chunks, NULL);
+    if (failed) SetEvent(pool->hDone);
+}
+
+/**
+ * @brief Writes the responses of finished groups and immediate answers
+ * @param state Server state
+ * @param hOut Response handle (original standard output)
+ * @param freq Performance counter frequency, for latency statistics
+ * @param answered Output: requests answered
+ * @return TRUE on success, FALSE on memory or write failure
+ * @details Everything ready is written with one WriteFile. Groups appear in the
+ *          order they finished, each group's requests in arrival order.
+ */
+static BOOL WriteAnswers(ServeState* state, HANDLE hOut, LONGLONG freq, int* answered) {
+    HANDLE hHeap = GetProcessHeap();
+    DWORD outSize = (DWORD)state->answerCount * 64;
+    BOOL success = TRUE;
+
+    EnterCriticalSection(&state->pool.lock);
+    int done = state->pool.done.head;
+    state->pool.done.head = NO_GROUP;
+    LeaveCriticalSection(&state->pool.lock);
+
+    *answered = 0;
+    if (done == NO_GROUP && state->answerCount == 0) return TRUE;
+
+    for (int g = done; g != NO_GROUP; g = state->groups[g].next) {
+        const ServeGroup* group = &state->groups[g];
+        outSize += (DWORD)group->requestCount * 32 + (DWORD)(group->total * group->stride);
+    }
+
+    char* out = (char*)HeapAlloc(hHeap, 0, outSize);
+    if (!out) {
+        PrintError("Memory Error");
+        success = FALSE;
+    } else {
+        DWORD pos = 0;
+        for (int a = 0; a < state->answerCount; a++) {
+            const ServeRequest* request = &state->slots[state->answers[a]];
+            if (request->control && !request->error) {
+                pos += wsprintfA(out + pos, "OK %lu 0\r\n", request->seq);
+            } else {
+                pos += wsprintfA(out + pos, "ERR %lu %s\r\n", request->seq, request->error);
+            }
+        }
+
+        /* Scatter records back to the responses */
+        for (int g = done; g != NO_GROUP; g = state->groups[g].next) {
+            const ServeGroup* group = &state->groups[g];
+            for (int r = group->requests.head; r != NO_REQUEST; r = state->slots[r].next) {
+                const ServeRequest* request = &state->slots[r];
+                if (group->failed) {
+                    pos += wsprintfA(out + pos, "ERR %lu generation failed\r\n", request->seq);
+                    continue;
+                }
+
+                pos += wsprintfA(out + pos, "OK %lu %d\r\n", request->seq, request->config.count);
+                const char* src = group->records + request->first * group->stride;
+                int bytes = request->config.count * group->stride;
+                for (int i = 0; i < bytes; i++) out[pos + i] = src[i];
+                pos += bytes;
+            }
+        }
+
+        DWORD bytesWritten = 0;
+        if (!WriteFile(hOut, out, pos, &bytesWritten, NULL) || bytesWritten != pos) {
+            PrintError("Write Failed");
+            success = FALSE;
+        }
+        SecureZeroMemory(out, outSize);
+        HeapFree(hHeap, 0, out);
+    }
+
+    /* Latency from arrival to write, then recycle slots and groups */
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    for (int a = 0; a < state->answerCount; a++) {
+        int index = state->answers[a];
+        RecordLatency(&state->all, (now.QuadPart - state->slots[index].arrival) * 1000000 / freq);
+        state->slots[index].next = state->freeList;
+        state->freeList = index;
+        (*answered)++;
+    }
+    state->answerCount = 0;
+
+    while (done != NO_GROUP) {
+        ServeGroup* group = &state->groups[done];
+        int nextGroup = group->next;
+
+        int r = group->requests.head;
+        while (r != NO_REQUEST) {
+            ServeRequest* request = &state->slots[r];
+            int nextRequest = request->next;
+            LONGLONG micros = (now.QuadPart - request->arrival) * 1000000 / freq;
+            RecordLatency(&state->all, micros);
+            RecordLatency(&state->tenants[request->tenant].stats, micros);
+            if (request->interactive) RecordLatency(&state->interactiveStats, micros);
+
+            request->next = state->freeList;
+            state->freeList = r;
+            (*answered)++;
+            r = nextRequest;
+        }
+
+        if (group->records) {
+            SecureZeroMemory(group->records, (SIZE_T)group->total * group->stride);
+            HeapFree(hHeap, 0, group->records);
+            group->records = NULL;
+        }
+        group->next = state->freeGroups;
+        state->freeGroups = done;
+        state->inFlight--;
+        state->groupsServed++;
+        done = nextGroup;
+    }
+    return success;
+}
+
+/**
+ * @brief Checks for the RELOAD control command
+ * @param line Request line of exactly six characters
+ * @return TRUE if the line is "RELOAD"
+ */
+static BOOL IsReloadCommand(const char* line) {
+    static const char RELOAD[] = "RELOAD";
+    for (int i = 0; i < 6; i++) {
+        if (line[i] != RELOAD[i]) return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Adds a complete line to the reader's ring, waiting while it is full
+ * @param reader Input reader
+ * @param line Line to add
+ * @return FALSE if the serving thread asked the reader to stop
+ */
+static BOOL ReaderPush(InputReader* reader, const InputLine* line) {
+    EnterCriticalSection(&reader->lock);
+    while (reader->count == SERVE_INPUT_LINES && !reader->stop) {
+        LeaveCriticalSection(&reader->lock);
+        WaitForSingleObject(reader->hSpaceReady, INFINITE);
+        EnterCriticalSection(&reader->lock);
+    }
+    BOOL running = !reader->stop;
+    if (running) {
+        reader->lines[(reader->head + reader->count) % SERVE_INPUT_LINES] = *line;
+        reader->count++;
+    }
+    LeaveCriticalSection(&reader->lock);
+    SetEvent(reader->hLinesReady);
+    return running;
+}
+
+/**
+ * @brief Reader thread: splits standard input into lines and stamps each one
+ * @param param Pointer to InputReader
+ * @return 0
+ * @details Stays blocked in ReadFile while the serving thread generates, so a
+ *          line is stamped when it reaches the process rather than when the
+ *          server gets around to it. A line is complete, and stamped, when its
+ *          newline is read. An unterminated last line is dropped.
+ */
+static DWORD WINAPI InputReaderProc(LPVOID param) {
+    static char readBuf[SERVE_INPUT_SIZE];
+    static InputLine line;
+    InputReader* reader = (InputReader*)param;
+    LARGE_INTEGER now;
+    BOOL running = TRUE;
+
+    line.length = 0;
+    while (running) {
+        DWORD bytesRead = 0;
+        if (!ReadFile(reader->hIn, readBuf, sizeof(readBuf), &bytesRead, NULL) || bytesRead == 0) break;
+        QueryPerformanceCounter(&now);
+
+        for (DWORD i = 0; i < bytesRead && running; i++) {
+            char c = readBuf[i];
+            if (c != '\n') {
+                if (line.length < SERVE_LINE_MAX) line.text[line.length] = c;
+                /* Count past SERVE_LINE_MAX so an over-long line is rejected, not split */
+                if (line.length <= SERVE_LINE_MAX) line.length++;
+                continue;
+            }
+
+            if (line.length > 0 && line.length <= SERVE_LINE_MAX && line.text[line.length - 1] == '\r') line.length--;
+            if (line.length == 4 && line.text[0] == 'Q' && line.text[1] == 'U' && line.text[2] == 'I' && line.text[3] == 'T') {
+                running = FALSE;
+            } else if (line.length > 0) {
+                line.arrival = now.QuadPart;
+                running = ReaderPush(reader, &line);
+            }
+            line.length = 0;
+        }
+    }
+
+    EnterCriticalSection(&reader->lock);
+    reader->ended = TRUE;
+    LeaveCriticalSection(&reader->lock);
+    SetEvent(reader->hLinesReady);
+    return 0;
+}
+
+/**
+ * @brief Takes the oldest line from the reader's ring without blocking
+ * @param reader Input reader
+ * @param line Output line
+ * @param ended Output: TRUE if the ring is empty and no more lines will come
+ * @return TRUE if a line was taken
+ */
+static BOOL TakeLine(InputReader* reader, InputLine* line, BOOL* ended) {
+    BOOL taken = FALSE;
+
+    EnterCriticalSection(&reader->lock);
+    if (reader->count > 0) {
+        *line = reader->lines[reader->head];
+        reader->head = (reader->head + 1) % SERVE_INPUT_LINES;
+        reader->count--;
+        taken = TRUE;
+    }
+    *ended = reader->count == 0 && reader->ended;
+    LeaveCriticalSection(&reader->lock);
+
+    if (taken) SetEvent(reader->hSpaceReady);
+    return taken;
+}
+
+/**
+ * @brief Turns a line into a request and queues it, or queues its answer
+ * @param state Server state
+ * @param line Line from the reader (state->freeList must not be empty)
+ */
+static void AcceptLine(ServeState* state, const InputLine* line) {
+    int index = state->freeList;
+    ServeRequest* request = &state->slots[index];
+    state->freeList = request->next;
+
+    request->seq = state->nextSeq++;
+    request->arrival = line->arrival;
+    if (line->length > SERVE_LINE_MAX) {
+        request->error = "line too long";
+        request->group = NO_GROUP;
+        request->interactive = FALSE;
+        request->control = FALSE;
+        request->tenant = -1;
+    } else if (line->length == 6 && IsReloadCommand(line->text)) {
+        /* Publish a new profile snapshot; requests parsed after this line see it */
+        request->error = ProfileRegistryLoad() ? NULL : "reload failed";
+        request->group = NO_GROUP;
+        request->interactive = FALSE;
+        request->control = TRUE;
+        request->tenant = -1;
+    } else {
+        ParseRequest(state, line->text, line->length, request);
+    }
+
+    /* Rejected requests and control commands are answered without generation */
+    if (request->error || request->control) {
+        state->answers[state->answerCount++] = index;
+    } else {
+        QueuePush(state, &state->pending, index);
+        state->pendingCount++;
+        state->pendingPasswords += request->config.count;
+
+        /* Average over about the last eight requests */
+        if (state->lastArrival != 0) {
+            state->arrivalGap += (line->arrival - state->lastArrival - state->arrivalGap) / 8;
+        }
+        state->lastArrival = line->arrival;
+    }
+}
+
+/**
+ * @brief Returns how long the oldest pending request may wait for others to join it
+ * @param state Server state
+ * @param windowTicks Longest wait (--window) in performance counter ticks
+ * @return Wait in performance counter ticks, 0 to release at once
+ * @details Waiting only pays off when another request is likely to arrive within
+ *          the window and the workers could not start on the batch anyway. With
+ *          a worker idle and nothing queued, or with requests arriving further
+ *          apart than the window on average, the batch is released at once.
+ */
+static LONGLONG CoalescingWindow(ServeState* state, LONGLONG windowTicks) {
+    ServePool* pool = &state->pool;
+
+    if (windowTicks == 0 || state->arrivalGap >= windowTicks) return 0;
+
+    EnterCriticalSection(&pool->lock);
+    BOOL idle = pool->busyWorkers < state->workerCount && pool->interactive.head == NO_GROUP &&
+                pool->bulkGroups == 0;
+    LeaveCriticalSection(&pool->lock);
+    return idle ? 0 : windowTicks;
+}
+
+static volatile LONG g_ctrlStopping = 0;  /**< Set once the registry is being shut down */
+static volatile LONG g_ctrlActive = 0;    /**< Control handlers currently running */
+
+/**
+ * @brief Console control handler: Ctrl+Break reloads the profile registry
+ * @param ctrlType Control event
+ * @return TRUE if handled, FALSE to let the default handler run
+ * @details Runs on a separate thread created by the system; publishing a new
+ *          snapshot does not interrupt or lock the serving thread. Once
+ *          StopCtrlHandler() has started, Ctrl+Break is swallowed without a reload.
+ */
+static BOOL WINAPI ServeCtrlHandler(DWORD ctrlType) {
+    if (ctrlType != CTRL_BREAK_EVENT) return FALSE;
+    InterlockedIncrement(&g_ctrlActive);
+    if (InterlockedCompareExchange(&g_ctrlStopping, 0, 0) == 0) ProfileRegistryLoad();
+    InterlockedDecrement(&g_ctrlActive);
+    return TRUE;
+}
+
+/**
+ * @brief Unregisters the control handler and waits for a running one to finish
+ * @details Unregistering does not stop a handler thread that is already inside
+ *          ProfileRegistryLoad(), which would publish a snapshot after
+ *          ProfileRegistryShutdown(). Both sides use full-barrier interlocked
+ *          operations, so either the handler sees the flag or this sees the handler.
+ */
+static void StopCtrlHandler(void) {
+    InterlockedExchange(&g_ctrlStopping, 1);
+    SetConsoleCtrlHandler(ServeCtrlHandler, FALSE);
+    while (InterlockedCompareExchange(&g_ctrlActive, 0, 0) != 0) Sleep(1);
+}
+
+/**
+ * @brief Prints requests/sec and p99 latency to the diagnostic stream
+ * @param label Which requests the histogram covers
+ * @param stats Collected statistics
+ * @param elapsedMicros Total serving time
+ */
+static void PrintServeStats(const char* label, const ServeStats* stats, LONGLONG elapsedMicros) {
+    char msgBuf[256];
+    DWORD p99Bound = 0;
+    DWORD seen = 0;
+
+    /* p99 upper bound: first bucket where the cumulative count reaches 99% */
+    DWORD target = stats->requests - stats->requests / 100;
+    for (int b = 0; b < SERVE_LATENCY_BUCKETS; b++) {
+        seen += stats->latency[b];
+        if (seen >= target && stats->requests > 0) {
+            p99Bound = (DWORD)1 << b;
+            break;
+        }
+    }
+
+    DWORD perSecond = elapsedMicros > 0 ? (DWORD)((LONGLONG)stats->requests * 1000000 / elapsedMicros) : 0;
+    wsprintfA(msgBuf, "[INFO] %s: %lu requests, %lu req/s, p99 < %lu us\r\n",
+              label, stats->requests, perSecond, p99Bound);
+    ConsoleWrite(msgBuf);
+}
+
+/**
+ * @brief Starts the worker pool
+ * @param state Server state
+ * @return TRUE if at least one worker is running
+ */
+static BOOL StartWorkers(ServeState* state) {
+    ServePool* pool = &state->pool;
+    SYSTEM_INFO sysInfo;
+
+    GetSystemInfo(&sysInfo);
+    int wanted = (int)sysInfo.dwNumberOfProcessors;
+    if (wanted < 1) wanted = 1;
+    if (wanted > MAX_BATCH_THREADS) wanted = MAX_BATCH_THREADS;
+
+    InitializeCriticalSection(&pool->lock);
+    pool->hWork = CreateSemaphoreA(NULL, 0, MAXLONG, NULL);
+    pool->hDone = CreateEventA(NULL, FALSE, FALSE, NULL);
+    if (!pool->hWork || !pool->hDone) return FALSE;
+
+    pool->groups = state->groups;
+    pool->coalesce = state->coalesce;
+    pool->interactive.head = NO_GROUP;
+    pool->done.head = NO_GROUP;
+    pool->interactiveCredit = SERVE_QUANTUM;
+    for (int t = 0; t < SERVE_MAX_TENANTS; t++) pool->bulk[t].head = NO_GROUP;
+
+    for (int w = 0; w < wanted; w++) {
+        ServeWorker* worker = &state->workers[state->workerCount];
+        worker->pool = pool;
+        HANDLE hThread = CreateThread(NULL, 0, ServeWorkerProc, worker, 0, NULL);
+        if (!hThread) break;
+        state->hWorkers[state->workerCount++] = hThread;
+    }
+    return state->workerCount > 0;
+}
+
+/**
+ * @brief Stops the worker pool once its queued chunks are done
+ * @param state Server state
+ * @return Most random draws any password needed
+ */
+static int StopWorkers(ServeState* state) {
+    int maxDraws = 0;
+
+    /* One extra count per worker; a worker that finds no chunk leaves */
+    if (state->workerCount > 0) {
+        ReleaseSemaphore(state->pool.hWork, state->workerCount, NULL);
+        WaitForMultipleObjects((DWORD)state->workerCount, state->hWorkers, TRUE, INFINITE);
+    }
+    for (int w = 0; w < state->workerCount; w++) {
+        CloseHandle(state->hWorkers[w]);
+        if (state->workers[w].maxDraws > maxDraws) maxDraws = state->workers[w].maxDraws;
+    }
+    return maxDraws;
+}
+
+/**
+ * @brief Runs the serving loop until QUIT or end of input
+ * @param coalesce TRUE to merge requests with the same policy
+ * @param windowMs Coalescing window in milliseconds
+ * @return 0 on normal exit, 1 on failure
+ */
+int RunServeMode(BOOL coalesce, int windowMs) {
+    static ServeState state;
+    static InputReader reader;
+    static InputLine line;
+    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+    LARGE_INTEGER freq, startTime, now, doneTime;
+    char msgBuf[160];
+    BOOL ended = FALSE;
+    int result = 0;
+
+    /* Responses own standard output; route ConsoleWrite diagnostics to standard error */
+    SetStdHandle(STD_OUTPUT_HANDLE, GetStdHandle(STD_ERROR_HANDLE));
+
+    state.coalesce = coalesce;
+    state.nextSeq = 1;
+    state.pending.head = NO_REQUEST;
+    state.freeList = NO_REQUEST;
+    state.freeGroups = NO_GROUP;
+    for (int i = SERVE_MAX_QUEUED - 1; i >= 0; i--) {
+        state.slots[i].next = state.freeList;
+        state.freeList = i;
+        state.groups[i].next = state.freeGroups;
+        state.freeGroups = i;
+    }
+    if (!GetProfilePath(state.profilePath, sizeof(state.profilePath))) state.profilePath[0] = '\0';
+    if (!coalesce) windowMs = 0;
+
+    /* Profiles are served from a snapshot; Ctrl+Break or RELOAD publishes a new one.
+       The compiled cache is not revalidated on reload, so it stays off here. */
+    ProfileCacheEnable(FALSE);
+    if (!ProfileRegistryLoad()) ConsoleWrite("[WARNING] Profiles will be read from the file per request.\r\n");
+    InterlockedExchange(&g_ctrlStopping, 0);
+    SetConsoleCtrlHandler(ServeCtrlHandler, TRUE);
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&startTime);
+    LONGLONG windowTicks = (LONGLONG)windowMs * freq.QuadPart / 1000;
+    state.arrivalGap = freq.QuadPart;
+
+    HANDLE hReader = NULL;
+    if (!StartWorkers(&state)) {
+        PrintError("Failed to start the worker threads");
+        result = 1;
+        ended = TRUE;
+    } else {
+        reader.hIn = GetStdHandle(STD_INPUT_HANDLE);
+        InitializeCriticalSection(&reader.lock);
+        reader.hLinesReady = CreateEventA(NULL, FALSE, FALSE, NULL);
+        reader.hSpaceReady = CreateEventA(NULL, FALSE, FALSE, NULL);
+        if (reader.hLinesReady && reader.hSpaceReady) {
+            hReader = CreateThread(NULL, 0, InputReaderProc, &reader, 0, NULL);
+        }
+        if (!hReader) {
+            PrintError("Failed to start the input reader");
+            result = 1;
+            ended = TRUE;
+        } else {
+            /* Reading, parsing and writing preempt generation, so new requests
+               reach the scheduler while every worker is busy */
+            SetThreadPriority(hReader, THREAD_PRIORITY_ABOVE_NORMAL);
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
+        }
+    }
+
+    while (result == 0) {
+        int answered = 0;
+        BOOL released = FALSE;
+        DWORD timeout = INFINITE;
+
+        /* Take the lines that have arrived, up to one release, so a burst is
+           handed to the workers as it is parsed rather than after all of it */
+        while (state.freeList != NO_REQUEST && state.pendingCount < SERVE_MAX_BATCH &&
+               state.pendingPasswords < SERVE_BATCH_PASSWORDS && TakeLine(&reader, &line, &ended)) {
+            AcceptLine(&state, &line);
+        }
+
+        /* Release when the window of the oldest request has passed or a group is full */
+        if (state.pendingCount > 0) {
+            BOOL release = ended || state.freeList == NO_REQUEST || state.pendingCount >= SERVE_MAX_BATCH ||
+                           state.pendingPasswords >= SERVE_BATCH_PASSWORDS;
+            if (!release) {
+                QueryPerformanceCounter(&now);
+                LONGLONG remaining = state.slots[state.pending.head].arrival + CoalescingWindow(&state, windowTicks) -
+                                     now.QuadPart;
+                release = remaining <= 0;
+                if (!release) timeout = (DWORD)(remaining * 1000 / freq.QuadPart) + 1;
+            }
+            if (release) {
+                ReleasePending(&state);
+                released = TRUE;
+            }
+        }
+
+        if (!WriteAnswers(&state, hOut, freq.QuadPart, &answered)) {
+            result = 1;
+            break;
+        }
+
+        /* No profile entry is referenced between iterations */
+        ProfileRegistryQuiesce();
+
+        if (ended && state.pendingCount == 0 && state.inFlight == 0) break;
+        /* Freed slots or a release may let lines already in the ring in */
+        if (answered > 0 || (released && !ended)) continue;
+
+        HANDLE waits[2] = { state.pool.hDone, reader.hLinesReady };
+        WaitForMultipleObjects(2, waits, FALSE, timeout);
+    }
+
+    /* A reader blocked on the ring is released; one blocked in ReadFile ends with the process */
+    if (hReader) {
+        EnterCriticalSection(&reader.lock);
+        reader.stop = TRUE;
+        LeaveCriticalSection(&reader.lock);
+        SetEvent(reader.hSpaceReady);
+        if (ended) WaitForSingleObject(hReader, INFINITE);
+        CloseHandle(hReader);
+    }
+    int maxDraws = StopWorkers(&state);
+
+    StopCtrlHandler();
+    ProfileRegistryShutdown();
+
+    QueryPerformanceCounter(&doneTime);
+    LONGLONG elapsed = (doneTime.QuadPart - startTime.QuadPart) * 1000000 / freq.QuadPart;
+    wsprintfA(msgBuf, "[INFO] Served in %lu groups on %d workers (coalescing %s, window %d ms)\r\n",
+              state.groupsServed, state.workerCount, coalesce ? "on" : "off", windowMs);
+    ConsoleWrite(msgBuf);
+    PrintServeStats("All", &state.all, elapsed);
+    PrintServeStats("Interactive", &state.interactiveStats, elapsed);
+    for (int t = 0; t < state.tenantCount; t++) {
+        if (state.tenants[t].stats.requests == 0) continue;
+        wsprintfA(msgBuf, "Tenant %s", state.tenants[t].name);
+        PrintServeStats(msgBuf, &state.tenants[t].stats, elapsed);
+    }
+    wsprintfA(msgBuf, "[INFO] Random draws per password: max %d\r\n", maxDraws);
+    ConsoleWrite(msgBuf);
+    return result;
+}
@@ -0,0 +1,426 @@
+/**
+ * @file strength.c
+ * @brief Policy entropy and crack-time estimate implementation
+ * @details Entropy is computed in the log2 domain so policies of any length can
+ *          be handled with doubles. Hash rates are measured with the in-memory
+ *          implementations of hashes.c on all processors and cached in the
+ *          per-user calibration file.
+ */
+
+#include "../include/strength.h"
+#include "../include/console_io.h"
+#include "../include/profile.h"
+#include "../include/password_stream.h"
+#include "../include/hashes.h"
+#include "../include/utils.h"
+
+#define LN2           0.69314718055994530942  /**< Natural logarithm of 2 */
+#define LOG10_2       0.30102999566398119521  /**< Decimal logarithm of 2 */
+#define SECONDS_PER_YEAR 31557600.0           /**< Julian year */
+
+/* Hash families measured by the calibration step */
+#define HASH_KIND_MD5       0  /**< MD5 of one block */
+#define HASH_KIND_SHA1      1  /**< SHA-1 of one block */
+#define HASH_KIND_SHA256    2  /**< SHA-256 of one block */
+#define HASH_KIND_BCRYPT    3  /**< bcrypt; cost is log2 rounds */
+#define HASH_KIND_ARGON2ID  4  /**< Argon2id; cost is passes */
+
+/**
+ * @brief Hash algorithm measured by the calibration step
+ */
+typedef struct {
+    const char* name;  /**< Display name and INI key */
+    int kind;          /**< HASH_KIND_* */
+    DWORD cost;        /**< bcrypt cost or Argon2id passes */
+    DWORD memoryKiB;   /**< Argon2id memory */
+    DWORD lanes;       /**< Argon2id lanes */
+} HashAlgorithm;
+
+/* Argon2id presets: the OWASP minimum and the second recommended option of RFC 9106 */
+static const HashAlgorithm HASH_ALGORITHMS[] = {
+    { "MD5",          HASH_KIND_MD5,      0, 0,     0 },
+    { "SHA1",         HASH_KIND_SHA1,     0, 0,     0 },
+    { "SHA256",       HASH_KIND_SHA256,   0, 0,     0 },
+    { "bcrypt(10)",   HASH_KIND_BCRYPT,   10, 0,    0 },
+    { "bcrypt(12)",   HASH_KIND_BCRYPT,   12, 0,    0 },
+    { "Argon2id-19M", HASH_KIND_ARGON2ID, 2, 19456, 1 },
+    { "Argon2id-64M", HASH_KIND_ARGON2ID, 3, 65536, 4 },
+};
+#define HASH_ALGORITHM_COUNT (int)(sizeof(HASH_ALGORITHMS) / sizeof(HASH_ALGORITHMS[0]))
+
+/**
+ * @brief State shared with one calibration thread
+ */
+typedef struct {
+    const HashAlgorithm* algorithm;  /**< Algorithm to hash with */
+    volatile LONG* stop;             /**< Set to 1 by the main thread when time is up */
+    BYTE* memory;                    /**< Argon2id working memory, NULL otherwise */
+    DWORD hashes;                    /**< Number of completed hashes */
+    LONGLONG ticks;                  /**< Performance counter ticks spent on them */
+    BYTE sink;                       /**< Digest bits kept so the loop is not optimized away */
+} CalibrationWorker;
+
+/**
+ * @brief Computes log2(x) for x > 0 without the C runtime
+ * @param x Positive value
+ * @return Base-2 logarithm of x
+ * @details Normalizes x into [1, 2) and evaluates ln(m) with the atanh series
+ *          2 * (y + y^3/3 + y^5/5 + ...), y = (m - 1) / (m + 1) <= 1/3.
+ */
+double Log2(double x) {
+    int exponent = 0;
+    while (x >= 2.0) { x /= 2.0; exponent++; }
+    while (x < 1.0)  { x *= 2.0; exponent--; }
+
+    double y = (x - 1.0) / (x + 1.0);
+    double y2 = y * y;
+    double term = y;
+    double sum = 0.0;
+    for (int k = 1; k < 40; k += 2) {
+        sum += term / k;
+        term *= y2;
+    }
+    return exponent + (2.0 * sum) / LN2;
+}
+
+/**
+ * @brief Computes 2^x without the C runtime
+ * @param x Exponent (expected well within double range)
+ * @return 2 raised to x
+ */
+double Exp2(double x) {
+    int whole = (int)x;
+    if ((double)whole > x) whole--;  /* floor for negative values */
+    double frac = (x - whole) * LN2;
+
+    /* e^frac by Taylor series, frac in [0, ln 2) */
+    double result = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 25; k++) {
+        term *= frac / k;
+        result += term;
+    }
+
+    while (whole > 0) { result *= 2.0; whole--; }
+    while (whole < 0) { result /= 2.0; whole++; }
+    return result;
+}
+
+/**
+ * @brief Computes log2(n!) by summation
+ * @param n Non-negative integer (at most a few thousand here)
+ * @return Base-2 logarithm of n factorial
+ */
+static double Log2Factorial(int n) {
+    double sum = 0.0;
+    for (int k = 2; k <= n; k++) sum += Log2((double)k);
+    return sum;
+}
+
+/**
+ * @brief Computes the exact entropy of a configuration in bits
+ * @param config Password configuration
+ * @return Entropy in bits
+ */
+double PolicyEntropyBits(const PasswordConfig* config) {
+    int letters = config->useLetters ? config->letterLength : 0;
+    int numbers = config->useNumbers ? config->numberLength : 0;
+    int symbols = config->useSymbols ? config->symbolLength : 0;
+    int total = letters + numbers + symbols;
+
+    if (config->plan) return config->plan->bits;
+    if (total == 0) return 0.0;
+
+    /* Arrangements of the categories: multinomial coefficient */
+    double bits = Log2Factorial(total) - Log2Factorial(letters)
+                - Log2Factorial(numbers) - Log2Factorial(symbols);
+
+    /* Independent uniform choice within each category */
+    bits += letters * Log2((double)lstrlenA(CHARSET_LETTERS));
+    bits += numbers * Log2((double)lstrlenA(CHARSET_NUMBERS));
+    bits += symbols * Log2((double)lstrlenA(config->symbolSet[0] ? config->symbolSet : CHARSET_SYMBOLS));
+
+    /* Leading rule: only arrangements starting with an allowed character */
+    int leading = letters + (config->noLeadingDigit ? 0 : numbers) + (config->noLeadingSymbol ? 0 : symbols);
+    if (leading == 0) return 0.0;
+    if (leading < total) bits += Log2((double)leading) - Log2((double)total);
+    return bits;
+}
+
+/**
+ * @brief Thread procedure hashing 16-byte candidates until told to stop
+ * @param param Pointer to CalibrationWorker
+ * @return 0
+ * @details Always completes at least one hash, and times exactly the hashes it
+ *          completed, so slow algorithms are measured correctly even when one
+ *          hash takes longer than CALIBRATION_MS.
+ */
+static DWORD WINAPI CalibrationWorkerProc(LPVOID param) {
+    CalibrationWorker* worker = (CalibrationWorker*)param;
+    const HashAlgorithm* algorithm = worker->algorithm;
+    static const BYTE SALT[BCRYPT_SALT_SIZE] = "WinPass-Native!";
+    BYTE input[16] = { 0 };
+    BYTE digest[SHA256_DIGEST_SIZE];
+    LARGE_INTEGER start, end;
+    Argon2Params params;
+
+    params.password = input;
+    params.passwordLength = sizeof(input);
+    params.salt = SALT;
+    params.saltLength = sizeof(SALT);
+    params.secret = NULL;
+    params.secretLength = 0;
+    params.ad = NULL;
+    params.adLength = 0;
+    params.passes = algorithm->cost;
+    params.memoryKiB = algorithm->memoryKiB;
+    params.lanes = algorithm->lanes;
+
+    worker->hashes = 0;
+    QueryPerformanceCounter(&start);
+    do {
+        /* Vary the candidate like a brute-force loop would */
+        *(DWORD*)input = worker->hashes;
+        switch (algorithm->kind) {
+            case HASH_KIND_MD5:      Md5Short(input, sizeof(input), digest); break;
+            case HASH_KIND_SHA1:     Sha1Short(input, sizeof(input), digest); break;
+            case HASH_KIND_SHA256:   Sha256Short(input, sizeof(input), digest); break;
+            case HASH_KIND_BCRYPT:   Bcrypt(input, sizeof(input), SALT, (int)algorithm->cost, digest); break;
+            default:                 Argon2id(&params, digest, SHA256_DIGEST_SIZE, worker->memory); break;
+        }
+        worker->sink ^= digest[0];
+        worker->hashes++;
+    } while (!*worker->stop);
+    QueryPerformanceCounter(&end);
+
+    worker->ticks = end.QuadPart - start.QuadPart;
+    return 0;
+}
+
+/**
+ * @brief Measures one algorithm on all processors
+ * @param algorithm Algorithm to measure
+ * @param threadsUsed Output: number of hashing threads
+ * @return Aggregate rate in thousandths of hashes per second, 0 on failure
+ * @details Argon2id threads are limited so their working memory stays within
+ *          CALIBRATION_MEMORY_LIMIT; each thread's memory is touched before
+ *          timing starts.
+ */
+static ULONGLONG MeasureHashRate(const HashAlgorithm* algorithm, int* threadsUsed) {
+    CalibrationWorker workers[MAX_CALIBRATION_THREADS];
+    HANDLE threads[MAX_CALIBRATION_THREADS];
+    HANDLE hHeap = GetProcessHeap();
+    volatile LONG stop = 0;
+    SYSTEM_INFO sysInfo;
+    LARGE_INTEGER freq;
+    SIZE_T memorySize = 0;
+    int started = 0;
+
+    GetSystemInfo(&sysInfo);
+    int threadCount = (int)sysInfo.dwNumberOfProcessors;
+    if (threadCount > MAX_CALIBRATION_THREADS) threadCount = MAX_CALIBRATION_THREADS;
+    if (algorithm->kind == HASH_KIND_ARGON2ID) {
+        memorySize = Argon2MemorySize(algorithm->memoryKiB, algorithm->lanes);
+        if ((SIZE_T)threadCount * memorySize > CALIBRATION_MEMORY_LIMIT) {
+            threadCount = (int)(CALIBRATION_MEMORY_LIMIT / memorySize);
+        }
+    }
+    if (threadCount < 1) threadCount = 1;
+
+    for (int t = 0; t < threadCount; t++) {
+        workers[t].algorithm = algorithm;
+        workers[t].stop = &stop;
+        workers[t].memory = NULL;
+        workers[t].hashes = 0;
+        workers[t].ticks = 0;
+        workers[t].sink = 0;
+        if (memorySize > 0) {
+            workers[t].memory = (BYTE*)HeapAlloc(hHeap, HEAP_ZERO_MEMORY, memorySize);
+            if (!workers[t].memory) {
+                threadCount = t;
+                break;
+            }
+        }
+    }
+
+    for (int t = 0; t < threadCount; t++) {
+        threads[t] = CreateThread(NULL, 0, CalibrationWorkerProc, &workers[t], 0, NULL);
+        if (!threads[t]) break;
+        started++;
+    }
+
+    Sleep(CALIBRATION_MS);
+    InterlockedExchange(&stop, 1);
+    if (started > 0) WaitForMultipleObjects((DWORD)started, threads, TRUE, INFINITE);
+
+    /* Sum of per-thread rates, each over that thread's own hashing time */
+    QueryPerformanceFrequency(&freq);
+    double total = 0.0;
+    for (int t = 0; t < started; t++) {
+        if (workers[t].ticks > 0) total += (double)workers[t].hashes * (double)freq.QuadPart / (double)workers[t].ticks;
+        CloseHandle(threads[t]);
+    }
+    for (int t = 0; t < threadCount; t++) {
+        if (workers[t].memory) HeapFree(hHeap, 0, workers[t].memory);
+    }
+
+    *threadsUsed = started;
+    return (ULONGLONG)(total * 1000.0);
+}
+
+/**
+ * @brief Formats a rate given in thousandths of hashes per second
+ * @param buffer Output buffer (at least 32 bytes)
+ * @param milliRate Rate
+ */
+static void FormatRate(char* buffer, ULONGLONG milliRate) {
+    static const char* const UNITS[] = { "H/s", "kH/s", "MH/s", "GH/s", "TH/s", "PH/s" };
+    ULONGLONG rate = milliRate / 1000;
+    ULONGLONG divisor = 1;
+    int unit = 0;
+
+    if (rate < 1000) {
+        wsprintfA(buffer, "%lu.%02lu H/s", (DWORD)rate, (DWORD)(milliRate % 1000 / 10));
+        return;
+    }
+    while (rate / divisor >= 1000 && unit < 5) {
+        divisor *= 1000;
+        unit++;
+    }
+    wsprintfA(buffer, "%lu.%lu %s", (DWORD)(rate / divisor), (DWORD)(rate % divisor * 10 / divisor), UNITS[unit]);
+}
+
+/**
+ * @brief Reads stored rates from the per-user calibration file
+ * @param rates Output: one rate per algorithm, in thousandths of hashes per second
+ * @return TRUE if every algorithm has a stored rate
+ */
+static BOOL ReadStoredRates(ULONGLONG* rates) {
+    char path[MAX_PATH];
+    char valueBuf[32];
+
+    if (!GetUserDataPath(CALIBRATION_FILE_NAME, path, sizeof(path))) return FALSE;
+    for (int i = 0; i < HASH_ALGORITHM_COUNT; i++) {
+        GetPrivateProfileStringA(CALIBRATION_SECTION, HASH_ALGORITHMS[i].name, "", valueBuf, sizeof(valueBuf), path);
+        if (!ParseULongLong(valueBuf, &rates[i]) || rates[i] == 0) return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Measures multithreaded hash throughput and stores it per user
+ * @param rates Output: one rate per algorithm, in thousandths of hashes per second
+ * @return TRUE if all algorithms were measured, FALSE otherwise
+ */
+BOOL CalibrateHashRates(ULONGLONG* rates) {
+    char path[MAX_PATH];
+    char valueBuf[32];
+    char rateBuf[32];
+    char msgBuf[MAX_PATH + 128];
+    path[0] = '\0';
+    BOOL saved = GetUserDataPath(CALIBRATION_FILE_NAME, path, sizeof(path));
+    DWORD saveError = saved ? 0 : GetLastError();
+
+    ConsoleWrite("Calibrating hash throughput on all processors...\r\n");
+    for (int i = 0; i < HASH_ALGORITHM_COUNT; i++) {
+        int threads;
+        rates[i] = MeasureHashRate(&HASH_ALGORITHMS[i], &threads);
+        if (rates[i] == 0) {
+            wsprintfA(msgBuf, "[ERROR] Could not measure %s.\r\n", HASH_ALGORITHMS[i].name);
+            ConsoleWrite(msgBuf);
+            return FALSE;
+        }
+
+        FormatULongLong(valueBuf, rates[i]);
+        if (saved && !WritePrivateProfileStringA(CALIBRATION_SECTION, HASH_ALGORITHMS[i].name, valueBuf, path)) {
+            saved = FALSE;
+            saveError = GetLastError();
+        }
+        FormatRate(rateBuf, rates[i]);
+        wsprintfA(msgBuf, "  %-14s %14s  (%d threads)\r\n", HASH_ALGORITHMS[i].name, rateBuf, threads);
+        ConsoleWrite(msgBuf);
+    }
+
+    /* The rates are still valid for this run; only the next run has to measure again */
+    if (!saved) {
+        wsprintfA(msgBuf, "[WARNING] Calibration not saved to %s (Code: %lu); it applies to this run only.\r\n",
+                  path[0] ? path : "%LOCALAPPDATA%\\" USER_DATA_DIR_NAME, saveError);
+        ConsoleWrite(msgBuf);
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Formats an expected crack time given its base-2 logarithm in seconds
+ * @param buffer Output buffer (at least 48 bytes)
+ * @param log2Seconds log2 of the expected time in seconds
+ */
+static void FormatDuration(char* buffer, double log2Seconds) {
+    static const struct { const char* unit; double seconds; } UNITS[] = {
+        { "years",   SECONDS_PER_YEAR },
+        { "days",    86400.0 },
+        { "hours",   3600.0 },
+        { "minutes", 60.0 },
+        { "seconds", 1.0 },
+    };
+
+    if (log2Seconds < 0.0) {
+        lstrcpyA(buffer, "less than 1 second");
+        return;
+    }
+
+    /* Beyond ~10^9 years only the order of magnitude is meaningful */
+    double log2Years = log2Seconds - Log2(SECONDS_PER_YEAR);
+    if (log2Years > 30.0) {
+        wsprintfA(buffer, "~10^%d years", (int)(log2Years * LOG10_2));
+        return;
+    }
+
+    for (int i = 0; i < (int)(sizeof(UNITS) / sizeof(UNITS[0])); i++) {
+        double value = Exp2(log2Seconds - Log2(UNITS[i].seconds));
+        if (value >= 1.0) {
+            wsprintfA(buffer, "%lu %s", (DWORD)value, UNITS[i].unit);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Prints entropy and expected crack times for a configuration
+ * @param config Password configuration
+ */
+void ReportCrackTime(const PasswordConfig* config) {
+    ULONGLONG rates[HASH_ALGORITHM_COUNT];
+    char msgBuf[256];
+    char durationBuf[64];
+    char rateBuf[32];
+
+    if (!config->useLetters && !config->useNumbers && !config->useSymbols) {
+        ConsoleWrite("[ERROR] At least one character type must be enabled!\r\n");
+        return;
+    }
+
+    /* Calibrate on request or when no complete set of rates has been stored yet */
+    if (config->calibrate || !ReadStoredRates(rates)) {
+        if (!CalibrateHashRates(rates)) return;
+    }
+
+    double bits = PolicyEntropyBits(config);
+    int tenths = (int)(bits * 10.0 + 0.5);
+    wsprintfA(msgBuf, "\r\nEntropy: %d.%d bits (L=%d N=%d S=%d)\r\n", tenths / 10, tenths % 10,
+              config->useLetters ? config->letterLength : 0,
+              config->useNumbers ? config->numberLength : 0,
+              config->useSymbols ? config->symbolLength : 0);
+    ConsoleWrite(msgBuf);
+    wsprintfA(msgBuf, "Expected time to crack (half the keyspace), rig = %d x this machine:\r\n", config->rigSize);
+    ConsoleWrite(msgBuf);
+
+    for (int i = 0; i < HASH_ALGORITHM_COUNT; i++) {
+        /* log2(2^(bits-1) / (rate * rig)), rate stored in thousandths */
+        double log2Seconds = (bits - 1.0) - Log2((double)rates[i] / 1000.0 * (double)config->rigSize);
+        FormatDuration(durationBuf, log2Seconds);
+        FormatRate(rateBuf, rates[i]);
+        wsprintfA(msgBuf, "  %-14s %14s  %s\r\n", HASH_ALGORITHMS[i].name, rateBuf, durationBuf);
+        ConsoleWrite(msgBuf);
+    }
+}
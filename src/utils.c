@@ -98,4 +98,95 @@ int ExtractValueFromArg(const WCHAR* arg) {
         return SimpleWStrToInt(arg);
     }
     return -1;  /* No '=' found, invalid format */
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Extracts a count from a key=value argument without capping it
+ * @param arg Wide character argument like "--count=2000000"
+ * @param maxValue Largest accepted value
+ * @param value Output for the parsed value
+ * @return TRUE if the value is a number in [1, maxValue], FALSE otherwise
+ */
+BOOL ExtractCountFromArg(const WCHAR* arg, ULONGLONG maxValue, ULONGLONG* value) {
+    const WCHAR* str = ExtractStringFromArg(arg);
+    ULONGLONG res = 0;
+
+    if (!str || !IsWStrNumeric(str)) return FALSE;
+    while (*str != L'\0') {
+        /* Stop as soon as the limit is passed, before the accumulator can overflow */
+        res = (res * 10) + (ULONGLONG)(*str - L'0');
+        if (res > maxValue) return FALSE;
+        str++;
+    }
+    if (res == 0) return FALSE;
+    *value = res;
+    return TRUE;
+}
+
+/**
+ * @brief Formats an unsigned 64-bit value in decimal
+ * @param buffer Output buffer
+ * @param value Value to format
+ * @return Number of characters written
+ */
+int FormatULongLong(char* buffer, ULONGLONG value) {
+    char digits[20];
+    int count = 0;
+
+    do {
+        digits[count++] = (char)('0' + (int)(value % 10));
+        value /= 10;
+    } while (value > 0);
+
+    for (int i = 0; i < count; i++) buffer[i] = digits[count - 1 - i];
+    buffer[count] = '\0';
+    return count;
+}
+
+/**
+ * @brief Parses an unsigned 64-bit decimal value
+ * @param str Digits only
+ * @param value Output for the parsed value
+ * @return TRUE on success, FALSE on empty input, non-digits or overflow
+ */
+BOOL ParseULongLong(const char* str, ULONGLONG* value) {
+    ULONGLONG res = 0;
+
+    if (*str == '\0') return FALSE;
+    for (; *str != '\0'; str++) {
+        if (*str < '0' || *str > '9') return FALSE;
+        ULONGLONG digit = (ULONGLONG)(*str - '0');
+        if (res > (~0ULL - digit) / 10) return FALSE;
+        res = res * 10 + digit;
+    }
+    *value = res;
+    return TRUE;
+}
+
+/**
+ * @brief Returns the string value of a key=value argument
+ * @param arg Wide character argument like "--output=passwords.txt"
+ * @return Pointer after '=', or NULL if no '=' found
+ */
+const WCHAR* ExtractStringFromArg(const WCHAR* arg) {
+    while (*arg != L'\0' && *arg != L'=') {
+        arg++;
+    }
+    return (*arg == L'=') ? arg + 1 : NULL;
+}
+
+/**
+ * @brief Checks if wide string contains only numeric digits
+ * @param wstr Wide character string to validate
+ * @return TRUE if non-empty and all characters are digits, FALSE otherwise
+ */
+BOOL IsWStrNumeric(const WCHAR* wstr) {
+    /* Empty string is not a valid number */
+    if (*wstr == L'\0') return FALSE;
+
+    while (*wstr != L'\0') {
+        if (*wstr < L'0' || *wstr > L'9') return FALSE;
+        wstr++;
+    }
+    return TRUE;
+}